@@ -0,0 +1,90 @@
+/**
+ * JS-level benchmark suite. Times each binding end to end (marshalling,
+ * compute and building the result) over the same datasets as the native
+ * suite, and prints the timings as JSON. Run `benchmark/report.ts` over the
+ * output of both suites to split marshalling time from compute time.
+ *
+ *   ts-node benchmark/bindings.ts [--max-size=N] [--filter=ENGINE] [--seed=N]
+ */
+import { Suite } from 'benchmark';
+import { NATIVE } from '../src/bindings';
+import { DATASETS, generate } from './generators';
+
+const SIZES = [2, 10, 100, 1000, 10000, 100000, 1000000, 10000000];
+const POLYNOMIAL_DEGREE = 3;
+
+const args = process.argv.slice(2).reduce((parsed, arg) => {
+  const [key, value] = arg.replace(/^--/, '').split('=');
+  parsed[key] = value;
+  return parsed;
+}, {});
+const maxSize = Number(args['max-size'] || 1000000);
+const seed = Number(args['seed'] || 0x5eed);
+const filter = args['filter'] || '';
+
+/**
+ * Bindings to benchmark, with the native engine each one wraps and the
+ * largest input it is run on.
+ */
+const ENGINES = [
+  {
+    name: 'center.geometric',
+    engine: 'center.geometricCenter',
+    maxSize: 10000000,
+    run: points => NATIVE.center.geometric(points, false, 1e-3, 10)
+  },
+  {
+    name: 'center.mass',
+    engine: 'center.centerOfMass',
+    maxSize: 10000000,
+    run: points => NATIVE.center.mass(points)
+  },
+  {
+    name: 'cartesian.distance',
+    engine: 'cartesian.haversine',
+    maxSize: 10000000,
+    run: points => NATIVE.cartesian.distance(points, points[0], 109)
+  },
+  {
+    name: 'tsp.tsp',
+    engine: 'tsp.fillRoute',
+    maxSize: 4000,
+    run: points => NATIVE.tsp.tsp(points, 0, 116)
+  },
+  {
+    name: 'polynomial.bestFit',
+    engine: 'polynomial.fillBestFit',
+    maxSize: 10000000,
+    run: points => NATIVE.polynomial.bestFit(points, POLYNOMIAL_DEGREE)
+  }
+];
+
+const results = [];
+
+for (const dataset of DATASETS) {
+  for (const size of SIZES.filter(size => size <= maxSize)) {
+    const points = generate(dataset, seed, size);
+    const suite = new Suite();
+
+    ENGINES.filter(e => size <= e.maxSize && e.name.includes(filter)).forEach(
+      e =>
+        suite.add(e.name, () => e.run(points), {
+          onComplete: event => {
+            const stats = event.target.stats;
+            results.push({
+              binding: e.name,
+              engine: e.engine,
+              dataset,
+              size,
+              iterations: stats.sample.length,
+              meanNs: stats.mean * 1e9,
+              rme: stats.rme
+            });
+          }
+        })
+    );
+    suite.run();
+  }
+}
+
+console.log(JSON.stringify({ suite: 'js', seed, results }, null, 2));
@@ -0,0 +1,101 @@
+/**
+ * Synthetic datasets for the benchmark suites. Mirrors
+ * `benchmark/native/generators.cpp` so the JS and native suites measure the
+ * same data for a given seed.
+ */
+
+const EXTENT = 1000;
+const NUM_CLUSTERS = 16;
+const CITIES = [
+  [40.7128, -74.006],
+  [51.5074, -0.1278],
+  [35.6762, 139.6503],
+  [-33.8688, 151.2093],
+  [-23.5505, -46.6333],
+  [64.1466, -21.9426],
+  [1.3521, 103.8198],
+  [33.0437, -96.8158]
+];
+
+export const DATASETS = ['uniform', 'clustered', 'collinear', 'geoScattered'];
+
+/**
+ * Deterministic 32-bit pseudo-random number generator (mulberry32).
+ *
+ * @param {number} seed Seed of the generator
+ * @return {Object} Generator of uniform and gaussian numbers
+ */
+function random(seed: number) {
+  let state = seed >>> 0;
+  const next = (): number => {
+    state = (state + 0x6d2b79f5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+  const gaussian = (): number => {
+    const u = 1 - next();
+    const v = next();
+    return Math.sqrt(-2 * Math.log(u)) * Math.cos(2 * Math.PI * v);
+  };
+  return { next, gaussian };
+}
+
+/**
+ * Generates a synthetic dataset.
+ *
+ * @param {string} dataset Shape of the dataset, one of DATASETS
+ * @param {number} seed Seed of the generator
+ * @param {number} size Number of points
+ * @return {Array} 2D Array of points
+ */
+export function generate(
+  dataset: string,
+  seed: number,
+  size: number
+): Array<Array<number>> {
+  const rng = random(seed);
+  const points = new Array(size);
+
+  switch (dataset) {
+    case 'uniform':
+      for (let i = 0; i < size; ++i) {
+        points[i] = [rng.next() * EXTENT, rng.next() * EXTENT];
+      }
+      break;
+    case 'clustered': {
+      const centers = [];
+      for (let i = 0; i < NUM_CLUSTERS; ++i) {
+        centers.push([rng.next() * EXTENT, rng.next() * EXTENT]);
+      }
+      for (let i = 0; i < size; ++i) {
+        const center = centers[i % NUM_CLUSTERS];
+        points[i] = [
+          center[0] + rng.gaussian() * EXTENT / 100,
+          center[1] + rng.gaussian() * EXTENT / 100
+        ];
+      }
+      break;
+    }
+    case 'collinear':
+      for (let i = 0; i < size; ++i) {
+        const t = rng.next() * EXTENT;
+        points[i] = [t, 0.5 * t + rng.gaussian() * 1e-6];
+      }
+      break;
+    case 'geoScattered':
+      for (let i = 0; i < size; ++i) {
+        const city = CITIES[i % CITIES.length];
+        points[i] = [
+          city[0] + rng.gaussian() * 0.5,
+          city[1] + rng.gaussian() * 0.5
+        ];
+      }
+      break;
+    default:
+      throw new Error(`unknown dataset ${dataset}`);
+  }
+
+  return points;
+}
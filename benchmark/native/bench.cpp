@@ -0,0 +1,504 @@
+#include "../../src/native/arena.h"
+#include "../../src/native/cartesian.h"
+#include "../../src/native/center.h"
+#include "../../src/native/geo.h"
+#include "../../src/native/polynomial.h"
+#include "../../src/native/spatial.h"
+#include "../../src/native/stream.h"
+#include "../../src/native/tsp.h"
+#include "generators.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/*
+ * Native benchmark suite. Runs every engine over every synthetic dataset at
+ * increasing sizes and prints the timings as JSON, so that results of two
+ * releases can be diffed directly.
+ *
+ *   meethere_bench [--min-size=N] [--max-size=N] [--min-time=MS]
+ *                  [--filter=ENGINE] [--seed=N]
+ */
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+// 16 is the largest route solved exactly
+const size_t SIZES[] = {2,     10,     16,      100,     1000,
+                        10000, 100000, 1000000, 10000000};
+const size_t NUM_SIZES = sizeof(SIZES) / sizeof(SIZES[0]);
+
+const size_t POLYNOMIAL_DEGREE = 3;
+
+// a thousandth of the extent of the planar datasets, and about 100 km for the
+// Latitude/Longitude one
+const double CELL_SIZE = 1;
+
+// pings in the window of the streaming engines, each dataset point being one
+// ping, and the drift of the window's center of mass that calls for a search
+const size_t STREAM_WINDOW    = 1000;
+const double STREAM_TOLERANCE = 1;
+
+/**
+ * @struct
+ * @brief  Command-line options of the suite
+ */
+struct Options {
+  size_t       minSize;
+  size_t       maxSize;
+  double       minMillis;
+  const char * filter;
+  uint32_t     seed;
+};
+
+/**
+ * @struct
+ * @brief  A dataset in every layout the engines consume, including single
+ *         precision; the point store is only built for "geo." engines
+ */
+struct Workload {
+  const double (*points)[2];
+  const float (*singles)[2];
+  const double *          x;
+  const double *          y;
+  const Geo::PointStore * store;
+  size_t                  numPoints;
+};
+
+/**
+ * @struct
+ * @brief  An engine to benchmark
+ *
+ * @prop   name      name the engine is reported under
+ * @prop   maxSize   largest input the engine is run on
+ * @prop   run       runs the engine once, returning a value to keep alive
+ * @prop   reference optionally computes in double precision what a
+ *                   single-precision run returns, to report its relative
+ *                   error against
+ */
+struct Engine {
+  const char * name;
+  size_t       maxSize;
+  double (*run)(const Workload & workload);
+  double (*reference)(const Workload & workload);
+};
+
+volatile double sink;
+
+double runCost(const Workload & w)
+{
+  return Center::cost(w.points[0][0], w.points[0][1], w.points, w.numPoints);
+}
+
+double runCenterOfMass(const Workload & w)
+{
+  double center[2];
+  Center::centerOfMass(w.points, w.numPoints, center);
+  return Center::cost(center[0], center[1], w.points, w.numPoints);
+}
+
+double runGeometricCenter(const Workload & w)
+{
+  const Center::GeometricCenterOptions opts = {1e-3, 10, false, 0, 0};
+
+  double center[2];
+  return Center::geometricCenter(w.points, w.numPoints, opts, center);
+}
+
+double runAggregatedCenter(const Workload & w)
+{
+  const Center::GeometricCenterOptions opts = {1e-3, 10, false, 0, 0};
+
+  Arena::Scope scratch;
+  double(*cells)[2] = scratch.alloc<double[2]>(w.numPoints);
+  double *     weights  = scratch.alloc<double>(w.numPoints);
+  const size_t numCells =
+      Center::aggregate(w.points, w.numPoints, CELL_SIZE, cells, weights);
+
+  double center[2];
+  return Center::geometricCenter(cells, weights, numCells, opts, center);
+}
+
+double runSphericalCenter(const Workload & w)
+{
+  const Center::GeometricCenterOptions opts = {1e-3, 10, false, 0, 0};
+
+  double center[2];
+  return Center::sphericalCenter(w.points, w.numPoints, opts, center);
+}
+
+double runSlidingCenter(const Workload & w)
+{
+  const Center::GeometricCenterOptions opts = {1e-3, 10, false, 0, 0};
+
+  Stream::SlidingCenter window(opts, STREAM_TOLERANCE);
+  double                center[2];
+  for (size_t i = 0; i < w.numPoints; ++i) {
+    window.push(w.points[i], i);
+    window.expire((double)i - STREAM_WINDOW + 1);
+    window.center(center);
+  }
+  return window.score();
+}
+
+// the baseline of stream.slidingCenter: a full search per ping
+double runWindowedCenter(const Workload & w)
+{
+  const Center::GeometricCenterOptions opts = {1e-3, 10, false, 0, 0};
+
+  double center[2];
+  double score = 0;
+  for (size_t i = 0; i < w.numPoints; ++i) {
+    const size_t start = i + 1 > STREAM_WINDOW ? i + 1 - STREAM_WINDOW : 0;
+    score = Center::geometricCenter(w.points + start, i + 1 - start, opts,
+                                    center);
+  }
+  return score;
+}
+
+double runHaversine(const Workload & w)
+{
+  Arena::Scope scratch;
+  double *     distances = scratch.alloc<double>(w.numPoints);
+  Cartesian::fillDistances(w.points, w.numPoints, w.points[0], 'm',
+                           distances);
+  return distances[w.numPoints - 1];
+}
+
+double runApprox(const Workload & w, Cartesian::DistanceMode mode)
+{
+  Arena::Scope scratch;
+  double *     distances = scratch.alloc<double>(w.numPoints);
+  Cartesian::fillDistances(w.points, w.numPoints, w.points[0], 'm', distances,
+                           mode);
+  return distances[w.numPoints - 1];
+}
+
+double runEquirectangular(const Workload & w)
+{
+  return runApprox(w, Cartesian::equirectangular);
+}
+
+double runChord(const Workload & w)
+{
+  return runApprox(w, Cartesian::chord);
+}
+
+double runPolynomial(const Workload & w)
+{
+  return runApprox(w, Cartesian::polynomial);
+}
+
+double runGeoDistances(const Workload & w)
+{
+  Arena::Scope scratch;
+  double *     distances = scratch.alloc<double>(w.numPoints);
+  Geo::fillDistances(*w.store, w.points[0], 'm', distances);
+  return distances[w.numPoints - 1];
+}
+
+double runGeoCenter(const Workload & w)
+{
+  const Center::GeometricCenterOptions opts = {1e-3, 10, false, 0, 0};
+
+  double center[2];
+  return Center::sphericalCenter(*w.store, opts, center);
+}
+
+double runGeoRoute(const Workload & w)
+{
+  Arena::Scope scratch;
+  size_t *     route = scratch.alloc<size_t>(w.numPoints);
+  return TSP::fillRoute(*w.store, 0, route);
+}
+
+double runRoute(const Workload & w)
+{
+  Arena::Scope scratch;
+  size_t *     route = scratch.alloc<size_t>(w.numPoints);
+  return TSP::fillRoute(w.points, w.numPoints, 0, TSP::tsp, route);
+}
+
+double runSpatialBuild(const Workload & w)
+{
+  Spatial::KDTree tree(2);
+  tree.build(w.points[0], w.numPoints);
+  return tree.size();
+}
+
+double runSpatialNearest(const Workload & w)
+{
+  Spatial::KDTree tree(2);
+  tree.build(w.points[0], w.numPoints);
+
+  // the 10 nearest neighbors of every point
+  std::vector<Spatial::Neighbor> nearest;
+  double                         total = 0;
+  for (size_t i = 0; i < w.numPoints; ++i) {
+    tree.nearest(w.points[i], 10, nearest);
+    total += nearest.back().distance;
+  }
+  return total;
+}
+
+double runBestFit(const Workload & w)
+{
+  double coeffs[POLYNOMIAL_DEGREE + 1];
+  Polynomial::fillBestFit(w.x, w.y, w.numPoints, POLYNOMIAL_DEGREE, coeffs);
+  return coeffs[0];
+}
+
+/**
+ * @brief  Sums an array of values
+ */
+double sum(const double values[], size_t numValues)
+{
+  double total = 0;
+  for (size_t i = 0; i < numValues; ++i) {
+    total += values[i];
+  }
+  return total;
+}
+
+/**
+ * @brief  Measures a route through a set of points in double precision
+ */
+double routeLength(const double points[][2], const size_t route[], size_t n)
+{
+  double length = 0;
+  for (size_t i = 1; i < n; ++i) {
+    const double * a = points[route[i - 1]];
+    length += Center::cost(a[0], a[1], &points[route[i]], 1);
+  }
+  return length;
+}
+
+double runCostF32(const Workload & w)
+{
+  return Center::cost(w.points[0][0], w.points[0][1], w.singles, w.numPoints);
+}
+
+// the cost of the center found, measured in double precision
+double runGeometricCenterF32(const Workload & w)
+{
+  const Center::GeometricCenterOptions opts = {1e-3, 10, false, 0, 0};
+
+  double center[2];
+  Center::geometricCenter(w.singles, w.numPoints, opts, center);
+  return Center::cost(center[0], center[1], w.points, w.numPoints);
+}
+
+double runHaversineF32(const Workload & w)
+{
+  Arena::Scope scratch;
+  double *     distances = scratch.alloc<double>(w.numPoints);
+  Cartesian::fillDistances(w.singles, w.numPoints, w.points[0], 'm',
+                           distances);
+  return sum(distances, w.numPoints);
+}
+
+double referenceHaversine(const Workload & w)
+{
+  Arena::Scope scratch;
+  double *     distances = scratch.alloc<double>(w.numPoints);
+  Cartesian::fillDistances(w.points, w.numPoints, w.points[0], 'm',
+                           distances);
+  return sum(distances, w.numPoints);
+}
+
+double runRouteF32(const Workload & w)
+{
+  Arena::Scope scratch;
+  size_t *     route = scratch.alloc<size_t>(w.numPoints);
+  const size_t n = TSP::fillRoute(w.singles, w.numPoints, 0, TSP::tsp, route);
+  return routeLength(w.points, route, n);
+}
+
+double referenceRoute(const Workload & w)
+{
+  Arena::Scope scratch;
+  size_t *     route = scratch.alloc<size_t>(w.numPoints);
+  const size_t n = TSP::fillRoute(w.points, w.numPoints, 0, TSP::tsp, route);
+  return routeLength(w.points, route, n);
+}
+
+double runHilbertOrder(const Workload & w)
+{
+  Arena::Scope scratch;
+  size_t *     order = scratch.alloc<size_t>(w.numPoints);
+  Spatial::fillHilbertOrder(w.points[0], 2, w.numPoints, order);
+  return order[0];
+}
+
+double runHilbertRoute(const Workload & w)
+{
+  Arena::Scope scratch;
+  size_t *     route = scratch.alloc<size_t>(w.numPoints);
+  const size_t n =
+      TSP::fillRoute(w.points, w.numPoints, 0, TSP::hilbert, route);
+  return routeLength(w.points, route, n);
+}
+
+const Engine ENGINES[] = {
+    {"center.cost", 10000000, runCost, NULL},
+    {"center.costF32", 10000000, runCostF32, runCost},
+    {"center.centerOfMass", 10000000, runCenterOfMass, NULL},
+    {"center.geometricCenter", 10000000, runGeometricCenter, NULL},
+    {"center.geometricCenterF32", 10000000, runGeometricCenterF32,
+     runGeometricCenter},
+    {"center.aggregatedCenter", 10000000, runAggregatedCenter, NULL},
+    {"center.sphericalCenter", 10000000, runSphericalCenter, NULL},
+    {"cartesian.haversine", 10000000, runHaversine, NULL},
+    {"cartesian.haversineF32", 10000000, runHaversineF32, referenceHaversine},
+    {"cartesian.equirectangular", 10000000, runEquirectangular, NULL},
+    {"cartesian.chord", 10000000, runChord, NULL},
+    {"cartesian.polynomial", 10000000, runPolynomial, NULL},
+    {"geo.fillDistances", 10000000, runGeoDistances, NULL},
+    {"geo.sphericalCenter", 10000000, runGeoCenter, NULL},
+    {"geo.fillRoute", 100000, runGeoRoute, NULL},
+    {"spatial.build", 10000000, runSpatialBuild, NULL},
+    {"spatial.nearest", 1000000, runSpatialNearest, NULL},
+    {"spatial.hilbertOrder", 10000000, runHilbertOrder, NULL},
+    {"stream.slidingCenter", 1000000, runSlidingCenter, NULL},
+    {"stream.windowedCenter", 100000, runWindowedCenter, NULL},
+    {"tsp.fillRoute", 1000000, runRoute, NULL},
+    {"tsp.fillRouteF32", 1000000, runRouteF32, referenceRoute},
+    {"tsp.hilbertRoute", 10000000, runHilbertRoute, NULL},
+    {"polynomial.fillBestFit", 10000000, runBestFit, NULL}};
+const size_t NUM_ENGINES = sizeof(ENGINES) / sizeof(ENGINES[0]);
+
+/**
+ * @brief  Returns the nanoseconds elapsed between two instants
+ */
+double nanosBetween(Clock::time_point start, Clock::time_point end)
+{
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+/**
+ * @brief  Parses command-line options
+ */
+Options parseOptions(int argc, char ** argv)
+{
+  Options options = {2, 10000000, 200, NULL, 0x5EED};
+
+  for (int i = 1; i < argc; ++i) {
+    const char * arg = argv[i];
+    if (!std::strncmp(arg, "--min-size=", 11)) {
+      options.minSize = std::strtoul(arg + 11, NULL, 10);
+    } else if (!std::strncmp(arg, "--max-size=", 11)) {
+      options.maxSize = std::strtoul(arg + 11, NULL, 10);
+    } else if (!std::strncmp(arg, "--min-time=", 11)) {
+      options.minMillis = std::strtod(arg + 11, NULL);
+    } else if (!std::strncmp(arg, "--filter=", 9)) {
+      options.filter = arg + 9;
+    } else if (!std::strncmp(arg, "--seed=", 7)) {
+      options.seed = std::strtoul(arg + 7, NULL, 10);
+    } else {
+      std::fprintf(stderr, "unknown option %s\n", arg);
+      std::exit(1);
+    }
+  }
+  return options;
+}
+
+/**
+ * @brief  Times an engine on a workload and prints the result as JSON
+ */
+void measure(const Engine &   engine,
+             const char *     dataset,
+             const Workload & workload,
+             const Options &  options,
+             bool             first)
+{
+  // warm caches and the scratch arena before timing
+  sink = engine.run(workload);
+
+  std::vector<double> samples;
+  double              total = 0;
+  while (samples.empty() || total < options.minMillis * 1e6) {
+    const Clock::time_point start = Clock::now();
+    sink                          = engine.run(workload);
+    const double elapsed          = nanosBetween(start, Clock::now());
+    samples.push_back(elapsed);
+    total += elapsed;
+  }
+
+  double min = samples[0], max = samples[0];
+  for (size_t i = 1; i < samples.size(); ++i) {
+    min = samples[i] < min ? samples[i] : min;
+    max = samples[i] > max ? samples[i] : max;
+  }
+  const double mean = total / samples.size();
+
+  std::printf(
+      "%s\n    {\"engine\": \"%s\", \"dataset\": \"%s\", \"size\": %zu, "
+      "\"iterations\": %zu, \"meanNs\": %.1f, \"minNs\": %.1f, "
+      "\"maxNs\": %.1f, \"nsPerPoint\": %.3f",
+      first ? "" : ",", engine.name, dataset, workload.numPoints,
+      samples.size(), mean, min, max, mean / workload.numPoints);
+  if (engine.reference) {
+    const double reference = engine.reference(workload);
+    std::printf(", \"relError\": %.3e",
+                reference ? std::abs(sink - reference) / std::abs(reference)
+                          : std::abs(sink));
+  }
+  std::printf("}");
+  std::fflush(stdout);
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  const Options options = parseOptions(argc, argv);
+
+  std::printf("{\n  \"suite\": \"native\",\n  \"seed\": %u,\n  \"results\": [",
+              options.seed);
+
+  bool first = true;
+  for (size_t d = 0; d < Bench::NUM_DATASETS; ++d) {
+    for (size_t s = 0; s < NUM_SIZES; ++s) {
+      const size_t numPoints = SIZES[s];
+      if (numPoints < options.minSize || numPoints > options.maxSize) {
+        continue;
+      }
+
+      // generate each dataset once per size, in every layout
+      std::vector<double> points(2 * numPoints), x(numPoints), y(numPoints);
+      std::vector<float>  singles(2 * numPoints);
+      double(*aos)[2] = reinterpret_cast<double(*)[2]>(&points[0]);
+      Bench::fillDataset(static_cast<Bench::Dataset>(d), options.seed,
+                         numPoints, aos);
+      for (size_t i = 0; i < numPoints; ++i) {
+        x[i]               = aos[i][0];
+        y[i]               = aos[i][1];
+        singles[2 * i]     = (float)aos[i][0];
+        singles[2 * i + 1] = (float)aos[i][1];
+      }
+      Geo::PointStore store;
+      const Workload  workload = {
+          aos, reinterpret_cast<const float(*)[2]>(&singles[0]), &x[0], &y[0],
+          &store, numPoints};
+
+      for (size_t e = 0; e < NUM_ENGINES; ++e) {
+        const Engine & engine = ENGINES[e];
+        if (numPoints > engine.maxSize ||
+            (options.filter && !std::strstr(engine.name, options.filter))) {
+          continue;
+        }
+        if (!std::strncmp(engine.name, "geo.", 4) && !store.size()) {
+          store.build(aos, numPoints);
+        }
+        measure(engine, Bench::DATASET_NAMES[d], workload, options, first);
+        first = false;
+      }
+    }
+  }
+
+  std::printf("\n  ]\n}\n");
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include "generators.h"
+#include <cmath>
+
+const char * const Bench::DATASET_NAMES[] = {"uniform", "clustered",
+                                             "collinear", "geoScattered"};
+const size_t Bench::NUM_DATASETS = 4;
+
+namespace
+{
+const size_t NUM_CLUSTERS = 16;
+const double EXTENT       = 1000;
+
+/*
+ * Latitude/Longitude of the cities geo-scattered points are spread around.
+ */
+const double CITIES[][2] = {
+    {40.7128, -74.0060}, {51.5074, -0.1278},  {35.6762, 139.6503},
+    {-33.8688, 151.2093}, {-23.5505, -46.6333}, {64.1466, -21.9426},
+    {1.3521, 103.8198},  {33.0437, -96.8158}};
+const size_t NUM_CITIES = sizeof(CITIES) / sizeof(CITIES[0]);
+}  // namespace
+
+Bench::Random::Random(uint32_t seed) : state(seed)
+{
+}
+
+/**
+ * @brief  Returns a uniformly distributed number in [0, 1)
+ */
+double Bench::Random::next()
+{
+  state += 0x6D2B79F5u;
+  uint32_t t = state;
+  t          = (t ^ (t >> 15)) * (t | 1u);
+  t ^= t + (t ^ (t >> 7)) * (t | 61u);
+  return ((t ^ (t >> 14)) & 0xFFFFFFFFu) / 4294967296.0;
+}
+
+/**
+ * @brief  Returns a normally distributed number (Box-Muller)
+ */
+double Bench::Random::gaussian()
+{
+  const double u = 1 - next();
+  const double v = next();
+  return std::sqrt(-2 * std::log(u)) * std::cos(2 * std::acos(-1.0) * v);
+}
+
+/**
+ * @brief   Fills an array with a synthetic dataset
+ *
+ * @param   dataset   shape of the dataset
+ * @param   seed      seed of the generator
+ * @param   numPoints number of points
+ * @param   fill      array of points to fill
+ */
+void Bench::fillDataset(Dataset  dataset,
+                        uint32_t seed,
+                        size_t   numPoints,
+                        double   fill[][2])
+{
+  Random random(seed);
+
+  switch (dataset) {
+    case uniform:
+      for (size_t i = 0; i < numPoints; ++i) {
+        fill[i][0] = random.next() * EXTENT;
+        fill[i][1] = random.next() * EXTENT;
+      }
+      break;
+    case clustered: {
+      double centers[NUM_CLUSTERS][2];
+      for (size_t i = 0; i < NUM_CLUSTERS; ++i) {
+        centers[i][0] = random.next() * EXTENT;
+        centers[i][1] = random.next() * EXTENT;
+      }
+      for (size_t i = 0; i < numPoints; ++i) {
+        const double * center = centers[i % NUM_CLUSTERS];
+        fill[i][0]            = center[0] + random.gaussian() * EXTENT / 100;
+        fill[i][1]            = center[1] + random.gaussian() * EXTENT / 100;
+      }
+      break;
+    }
+    case collinear:
+      for (size_t i = 0; i < numPoints; ++i) {
+        const double t = random.next() * EXTENT;
+        fill[i][0]     = t;
+        fill[i][1]     = 0.5 * t + random.gaussian() * 1e-6;
+      }
+      break;
+    case geoScattered:
+      for (size_t i = 0; i < numPoints; ++i) {
+        const double * city = CITIES[i % NUM_CITIES];
+        fill[i][0]          = city[0] + random.gaussian() * 0.5;
+        fill[i][1]          = city[1] + random.gaussian() * 0.5;
+      }
+      break;
+  }
+}
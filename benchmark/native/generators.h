@@ -0,0 +1,63 @@
+#ifndef GENERATORS_H
+#define GENERATORS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Bench
+{
+/**
+ * @enum
+ * @brief The shape of a synthetic dataset
+ *
+ * @prop  uniform       points spread evenly over a square
+ * @prop  clustered     points gathered in tight gaussian clusters
+ * @prop  collinear     points jittered along a single line
+ * @prop  geoScattered  Latitude/Longitude points scattered around cities
+ */
+enum Dataset { uniform, clustered, collinear, geoScattered };
+
+extern const char * const DATASET_NAMES[];
+extern const size_t       NUM_DATASETS;
+
+/**
+ * @class
+ * @brief   Deterministic 32-bit pseudo-random number generator (mulberry32)
+ * @details Chosen because it is trivially portable to JavaScript with
+ *          Math.imul, so the native and JS suites measure the same data.
+ */
+class Random
+{
+ public:
+  explicit Random(uint32_t seed);
+
+  /**
+   * @brief  Returns a uniformly distributed number in [0, 1)
+   */
+  double next();
+
+  /**
+   * @brief  Returns a normally distributed number (Box-Muller)
+   */
+  double gaussian();
+
+ private:
+  uint32_t state;
+};
+
+/**
+ * @brief   Fills an array with a synthetic dataset
+ *
+ * @param   dataset   shape of the dataset
+ * @param   seed      seed of the generator
+ * @param   numPoints number of points
+ * @param   fill      array of points to fill
+ */
+void fillDataset(Dataset  dataset,
+                 uint32_t seed,
+                 size_t   numPoints,
+                 double   fill[][2]);
+
+}  // namespace Bench
+
+#endif
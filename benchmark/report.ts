@@ -0,0 +1,31 @@
+/**
+ * Joins the output of the native and JS suites, splitting the end-to-end time
+ * of each binding into compute time (measured natively) and marshalling time
+ * (everything else: converting arguments and building the result).
+ *
+ *   ts-node benchmark/report.ts native.json js.json
+ */
+import { readFileSync } from 'fs';
+
+const [nativePath, jsPath] = process.argv.slice(2);
+const native = JSON.parse(readFileSync(nativePath, 'utf8'));
+const js = JSON.parse(readFileSync(jsPath, 'utf8'));
+
+const key = (r): string => `${r.engine}/${r.dataset}/${r.size}`;
+const compute = new Map();
+native.results.forEach(r => compute.set(key(r), r.meanNs));
+
+const results = js.results.filter(r => compute.has(key(r))).map(r => {
+  const computeNs = compute.get(key(r));
+  return {
+    binding: r.binding,
+    dataset: r.dataset,
+    size: r.size,
+    totalNs: r.meanNs,
+    computeNs,
+    marshalNs: Math.max(r.meanNs - computeNs, 0),
+    marshalShare: Math.max(r.meanNs - computeNs, 0) / r.meanNs
+  };
+});
+
+console.log(JSON.stringify({ suite: 'report', results }, null, 2));
@@ -1,48 +1,53 @@
 {
+  "variables": {
+    "build_bench%": "<!(node -p \"process.env.MEETHERE_BENCH || 'false'\")"
+  },
+  "target_defaults": {
+    "cflags": [ "-std=c++11" ],
+    "xcode_settings": {
+      "OTHER_CFLAGS": [ "-std=c++11",  "-stdlib=libc++" ],
+      "OTHER_LDFLAGS": [ "-stdlib=libc++" ],
+      "MACOSX_DEPLOYMENT_TARGET": "10.10"
+    }
+  },
   "targets": [
     {
-      "target_name": "cartesian",
-      "sources": [ "./src/native/cartesian.cpp",
-      "./src/native/wrapper/cartesian.cpp" ],
-      "cflags": [ "-std=c++11" ],
-      "xcode_settings": {
-        "OTHER_CFLAGS": [ "-std=c++11",  "-stdlib=libc++" ],
-        "OTHER_LDFLAGS": [ "-stdlib=libc++" ],
-        "MACOSX_DEPLOYMENT_TARGET": "10.10"
-      }
-    },
-    {
-      "target_name": "center",
-      "sources": [ "./src/native/center.cpp",
-      "./src/native/wrapper/center.cpp" ],
-      "cflags": [ "-std=c++11" ],
-      "xcode_settings": {
-        "OTHER_CFLAGS": [ "-std=c++11",  "-stdlib=libc++" ],
-        "OTHER_LDFLAGS": [ "-stdlib=libc++" ],
-        "MACOSX_DEPLOYMENT_TARGET": "10.10"
+      "target_name": "meethere_core",
+      "type": "static_library",
+      "sources": [ "./src/native/arena.cpp", "./src/native/cartesian.cpp",
+      "./src/native/center.cpp", "./src/native/geo.cpp",
+      "./src/native/metrics.cpp", "./src/native/pointfile.cpp",
+      "./src/native/polynomial.cpp", "./src/native/spatial.cpp",
+      "./src/native/stream.cpp", "./src/native/tsp.cpp",
+      "./src/native/meethere.cpp" ],
+      "cflags": [ "-fPIC", "-fno-math-errno" ],
+      "direct_dependent_settings": {
+        "include_dirs": [ "./src/native" ]
       }
     },
     {
-      "target_name": "tsp",
-      "sources": [ "./src/native/center.cpp", "./src/native/tsp.cpp",
-       "./src/native/wrapper/tsp.cpp" ],
-      "cflags": [ "-std=c++11" ],
-      "xcode_settings": {
-        "OTHER_CFLAGS": [ "-std=c++11",  "-stdlib=libc++" ],
-        "OTHER_LDFLAGS": [ "-stdlib=libc++" ],
-        "MACOSX_DEPLOYMENT_TARGET": "10.10"
-      }
-    },
-    {
-      "target_name": "polynomial",
-      "sources": [ "./src/native/polynomial.cpp",
-      "./src/native/wrapper/polynomial.cpp" ],
-      "cflags": [ "-std=c++11" ],
-      "xcode_settings": {
-        "OTHER_CFLAGS": [ "-std=c++11",  "-stdlib=libc++" ],
-        "OTHER_LDFLAGS": [ "-stdlib=libc++" ],
-        "MACOSX_DEPLOYMENT_TARGET": "10.10"
-      }
+      "target_name": "meethere",
+      "dependencies": [ "meethere_core" ],
+      "sources": [ "./src/native/wrapper/addon.cpp",
+      "./src/native/wrapper/cartesian.cpp", "./src/native/wrapper/center.cpp",
+      "./src/native/wrapper/geo.cpp", "./src/native/wrapper/metrics.cpp",
+      "./src/native/wrapper/pointfile.cpp",
+      "./src/native/wrapper/polynomial.cpp", "./src/native/wrapper/spatial.cpp",
+      "./src/native/wrapper/stream.cpp", "./src/native/wrapper/tsp.cpp" ]
     }
+  ],
+  "conditions": [
+    [ "build_bench=='true'", {
+      "targets": [
+        {
+          "target_name": "meethere_bench",
+          "type": "executable",
+          "dependencies": [ "meethere_core" ],
+          "sources": [ "./benchmark/native/bench.cpp",
+          "./benchmark/native/generators.cpp" ],
+          "cflags": [ "-O3" ]
+        }
+      ]
+    } ]
   ]
 }
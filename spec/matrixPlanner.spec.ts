@@ -0,0 +1,111 @@
+import { MatrixPlanner } from '../src/index';
+import { expect, should, use } from 'chai';
+import * as promise from 'chai-as-promised';
+import 'mocha';
+
+should();
+use(promise);
+
+describe('MatrixPlanner', () => {
+  const range = (n: number) => Array.from(Array(n).keys());
+  const reply = (origins: Array<number>, destinations: Array<number>) => ({
+    json: {
+      status: 'OK',
+      origin_addresses: origins.map(o => `o${o}`),
+      destination_addresses: destinations.map(d => `d${d}`),
+      rows: origins.map(o => ({
+        elements: destinations.map(d => ({
+          distance: { value: o * 1000 + d }
+        }))
+      }))
+    }
+  });
+  const failure = (status: string) => ({ json: { status } });
+
+  describe('tiles', () => {
+    it('stays within the limits', () => {
+      const planner = new MatrixPlanner();
+      const tiles = planner.tiles(30, 30);
+      expect(tiles).to.have.length(16);
+      tiles.forEach(({ origins, destinations }) => {
+        const height = origins[1] - origins[0];
+        const width = destinations[1] - destinations[0];
+        expect(height).to.be.at.most(25);
+        expect(width).to.be.at.most(25);
+        expect(height * width).to.be.at.most(100);
+      });
+    });
+    it('takes as many origins as fit for a single destination', () => {
+      const planner = new MatrixPlanner();
+      expect(planner.tiles(60, 1)).to.deep.equal([
+        { origins: [0, 25], destinations: [0, 1] },
+        { origins: [25, 50], destinations: [0, 1] },
+        { origins: [50, 60], destinations: [0, 1] }
+      ]);
+    });
+  });
+  it('merges the tiles into one matrix', async () => {
+    const planner = new MatrixPlanner();
+    const matrix: any = await planner.request(range(30), range(30), (o, d) =>
+      Promise.resolve(reply(o, d))
+    );
+    expect(matrix.status).to.equal('OK');
+    expect(matrix.tiles).to.have.length(16);
+    expect(matrix.origin_addresses).to.deep.equal(range(30).map(o => `o${o}`));
+    expect(matrix.destination_addresses).to.deep.equal(
+      range(30).map(d => `d${d}`)
+    );
+    matrix.rows.forEach((row, o) =>
+      row.elements.forEach((element, d) =>
+        expect(element.distance.value).to.equal(o * 1000 + d)
+      )
+    );
+  });
+  it('keeps a bounded number of tiles in flight', async () => {
+    const planner = new MatrixPlanner({ concurrency: 3 });
+    let inFlight = 0;
+    let most = 0;
+    await planner.request(range(200), range(1), async (o, d) => {
+      most = Math.max(most, ++inFlight);
+      await new Promise(resolve => setTimeout(resolve, 1));
+      --inFlight;
+      return reply(o, d);
+    });
+    expect(most).to.equal(3);
+  });
+  it('retries tiles that run over quota, backing off', async () => {
+    const delays = [];
+    let time = 0;
+    const planner = new MatrixPlanner({
+      now: () => time,
+      sleep: async (ms: number) => {
+        delays.push(ms);
+        time += ms;
+      }
+    });
+    let calls = 0;
+    const matrix: any = await planner.request(range(3), range(2), (o, d) =>
+      ++calls < 3
+        ? Promise.reject(failure('OVER_QUERY_LIMIT'))
+        : Promise.resolve(reply(o, d))
+    );
+    expect(delays).to.deep.equal([200, 400]);
+    expect(matrix.tiles).to.deep.equal([
+      { origins: [0, 3], destinations: [0, 2], attempts: 3, latency: 600 }
+    ]);
+  });
+  it('fails as the first tile that fails for good', async () => {
+    const planner = new MatrixPlanner({ concurrency: 1, retries: 1 });
+    let calls = 0;
+    await planner
+      .request(range(100), range(1), () => {
+        ++calls;
+        return Promise.reject(failure('MAX_ELEMENTS_EXCEEDED'));
+      })
+      .should.be.rejected.and.eventually.have.nested.property(
+        'json.status',
+        'MAX_ELEMENTS_EXCEEDED'
+      );
+    expect(calls).to.equal(1);
+  });
+});
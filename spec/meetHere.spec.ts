@@ -1,4 +1,4 @@
-import { MeetHere } from '../src/index';
+import { MeetHere, ResponseCache } from '../src/index';
 import { expect, should, use } from 'chai';
 import * as promise from 'chai-as-promised';
 import 'mocha';
@@ -44,7 +44,81 @@ describe('MeetHere', () => {
         ],
         process.env.GOOGLE_MAPS_TOKEN
       );
-      test.meetHere.should.deep.equal([33.04373236065685, -96.81583367822624]);
+      test.meetHere[0].should.be.closeTo(33.0437115, 1e-9);
+      test.meetHere[1].should.be.closeTo(-96.8157956, 1e-9);
+    });
+    it('minimizes distance on the earth rather than in degrees', () => {
+      const north = [[69.6, 18.9], [78.2, 15.6], [64.1, -21.9]];
+      const spherical = new MeetHere(north, process.env.GOOGLE_MAPS_TOKEN);
+      const planar = new MeetHere(north, process.env.GOOGLE_MAPS_TOKEN, {
+        spherical: false
+      });
+      spherical.meetHere[0].should.be.closeTo(72.42305, 1e-3);
+      spherical.meetHere[1].should.be.closeTo(10.19747, 1e-3);
+      spherical.centerStats.converged.should.equal(true);
+      spherical.geometricSignificance.should.be.above(0);
+      planar.meetHere[0].should.not.be.closeTo(72.42305, 1e-1);
+    });
+    it('finds the center on the earth of fixes merged by grid cell', () => {
+      const fixes = [
+        [69.6, 18.9],
+        [69.6004, 18.9003],
+        [69.6002, 18.9006],
+        [78.2, 15.6],
+        [78.2003, 15.6001],
+        [60.2, 24.9]
+      ];
+      const token = process.env.GOOGLE_MAPS_TOKEN;
+      const exact = new MeetHere(fixes, token);
+      const merged = new MeetHere(fixes, token, { cellSize: 0.01 });
+      merged.centerCost.should.be.at.most(
+        exact.centerCost + 2 * Math.SQRT2 * 0.01 * 111.19 * fixes.length
+      );
+      // one cell holds every fix, whose center is then their mean direction
+      const coarse = new MeetHere(fixes, token, { cellSize: 90 });
+      coarse.centerCost.should.be.above(exact.centerCost + 1);
+      coarse.centerStats.iterations.should.equal(1);
+    });
+    it('keeps cached trigonometry in step with edits', () => {
+      const test = new MeetHere(
+        [[69.6, 18.9], [78.2, 15.6], [64.1, -21.9]],
+        process.env.GOOGLE_MAPS_TOKEN
+      );
+      test.meetHere.should.be.an('Array');
+      test.add([60.2, 24.9]);
+      test.add([59.3, 18.1]);
+      test.move([78.2, 15.6], [55.7, 12.6]);
+      test.remove([69.6, 18.9]);
+
+      const fresh = new MeetHere(
+        test.locations.slice(),
+        process.env.GOOGLE_MAPS_TOKEN
+      );
+      test.meetHere.should.deep.equal(fresh.meetHere);
+      test.medianCost.should.equal(fresh.medianCost);
+      test.bestPath.should.deep.equal(fresh.bestPath);
+      test
+        .distanceMatrix()
+        .distances.should.deep.equal(fresh.distanceMatrix().distances);
+    });
+    it('finds locations within kilometers of a point', () => {
+      const test = new MeetHere(
+        [
+          [33.0952311, -96.8640427],
+          [33.0437115, -96.8157956],
+          [33.0284505, -96.7546927]
+        ],
+        process.env.GOOGLE_MAPS_TOKEN
+      );
+      test
+        .within(6.5, [33.0437115, -96.8157956])
+        .should.deep.equal([
+          [33.0437115, -96.8157956],
+          [33.0284505, -96.7546927]
+        ]);
+      test
+        .nearest(1, [33.1, -96.87])
+        .should.deep.equal([[33.0952311, -96.8640427]]);
     });
     describe('gives distances to center', () => {
       const test = new MeetHere(
@@ -69,6 +143,37 @@ describe('MeetHere', () => {
           .with.property('distances')
           .that.is.an('Array');
       });
+      it('approximates within error bounds', () => {
+        const exact = test.distanceMatrix().distances;
+        const bounds = { polynomial: 1e-8, equirectangular: 1e-5, chord: 1e-5 };
+        Object.keys(bounds).forEach(mode => {
+          test
+            .distanceMatrix('km', true, mode)
+            .distances.forEach((distance, i) =>
+              distance.should.be.closeTo(exact[i], exact[i] * bounds[mode])
+            );
+        });
+      });
+    });
+    describe('gives approximate distances near the pole', () => {
+      const test = new MeetHere(
+        [[78.22, 15.65], [79.95, 10.5], [77.0, 24.0], [79.5, 28.0]],
+        process.env.GOOGLE_MAPS_TOKEN
+      );
+      it('keeps equirectangular within its latitude-dependent bound', () => {
+        const { destination, distances } = test.distanceMatrix();
+        const approximate = test.distanceMatrix('km', true, 'equirectangular')
+          .distances;
+        test.locations.forEach((location, i) => {
+          const theta = distances[i] / 6371;
+          const phi =
+            Math.max(Math.abs(location[0]), Math.abs(destination[0])) *
+            Math.PI /
+            180;
+          const bound = theta * theta / (20 * Math.pow(Math.cos(phi), 2));
+          approximate[i].should.be.closeTo(distances[i], distances[i] * bound);
+        });
+      });
     });
     describe('gives nearby places', () => {
       const test = new MeetHere(
@@ -171,6 +276,139 @@ describe('MeetHere', () => {
       });
     });
   });
+  describe('services', () => {
+    const locations = [
+      [33.0952311, -96.8640427],
+      [33.0437115, -96.8157956],
+      [33.0284505, -96.7546927]
+    ];
+    const fakeClient = (calls: Array<string>, status: string = 'OK') => {
+      const respond = (method: string) => (query: any) => ({
+        asPromise: () => {
+          calls.push(method);
+          const response = { json: { status, query } };
+          if (query.origins) {
+            response.json['origin_addresses'] = query.origins.map(String);
+            response.json['destination_addresses'] = query.destinations;
+            response.json['rows'] = query.origins.map(origin => ({
+              elements: query.destinations.map(() => ({ origin }))
+            }));
+          }
+          return status === 'OK'
+            ? Promise.resolve(response)
+            : Promise.reject(response);
+        }
+      });
+      return {
+        placesNearby: respond('placesNearby'),
+        nearestRoads: respond('nearestRoads'),
+        timezone: respond('timezone'),
+        distanceMatrix: respond('distanceMatrix')
+      } as any;
+    };
+
+    it('reuses responses for a center that barely moved', async () => {
+      const calls = [];
+      const services = {
+        client: fakeClient(calls),
+        cache: new ResponseCache()
+      };
+      const test = new MeetHere(locations, '', {}, services);
+      await test.nearby({ radius: 500 });
+      test.add([33.06, -96.81]);
+      test.remove([33.06, -96.81]);
+      const moved = locations.map(([lat, lng]) => [lat + 1e-7, lng]);
+      await new MeetHere(moved, '', {}, services).nearby({ radius: 500 });
+      await test.nearby({ radius: 1000 });
+      expect(calls).to.deep.equal(['placesNearby', 'placesNearby']);
+    });
+    it('keeps the responses of each client to itself by default', async () => {
+      const [calls, others] = [[], []];
+      const client = fakeClient(calls);
+      await new MeetHere(locations, '', {}, { client }).roads();
+      await new MeetHere(locations, '', {}, { client }).roads();
+      await new MeetHere(locations, '', {}, {
+        client: fakeClient(others)
+      }).roads();
+      expect(calls).to.deep.equal(['nearestRoads']);
+      expect(others).to.deep.equal(['nearestRoads']);
+    });
+    it('shares responses across clients only when asked', async () => {
+      const [calls, others] = [[], []];
+      const cache = MeetHere.sharedCache;
+      cache.clear();
+      await new MeetHere(locations, '', {}, {
+        client: fakeClient(calls),
+        cache
+      }).roads();
+      await new MeetHere(locations, '', {}, {
+        client: fakeClient(others),
+        cache
+      }).roads();
+      expect(calls).to.deep.equal(['nearestRoads']);
+      expect(others).to.deep.equal([]);
+    });
+    it('sends one request for identical requests in flight', async () => {
+      const calls = [];
+      const test = new MeetHere(locations, '', {}, {
+        client: fakeClient(calls),
+        cache: new ResponseCache()
+      });
+      const responses = await Promise.all([
+        test.timezone(),
+        test.timezone(),
+        test.roads(),
+        test.travel(),
+        test.travel()
+      ]);
+      expect(calls).to.deep.equal([
+        'timezone',
+        'nearestRoads',
+        'distanceMatrix'
+      ]);
+      expect(responses[0]).to.equal(responses[1]);
+    });
+    it('reuses errors', async () => {
+      const calls = [];
+      const test = new MeetHere(locations, '', {}, {
+        client: fakeClient(calls, 'INVALID_REQUEST'),
+        cache: new ResponseCache()
+      });
+      for (let i = 0; i < 2; ++i) {
+        await test
+          .roads()
+          .should.eventually.have.property('status', 'INVALID_REQUEST');
+      }
+      expect(calls).to.deep.equal(['nearestRoads']);
+    });
+    it('goes to the network every time without a cache', async () => {
+      const calls = [];
+      const test = new MeetHere(locations, '', {}, {
+        client: fakeClient(calls),
+        cache: null
+      });
+      await test.roads();
+      await test.roads();
+      expect(calls).to.deep.equal(['nearestRoads', 'nearestRoads']);
+    });
+    it('requests travel for large groups in tiles', async () => {
+      const calls = [];
+      const crowd = Array.from(Array(60).keys()).map(i => [
+        33 + i / 1000,
+        -96.8
+      ]);
+      const test = new MeetHere(crowd, '', {}, {
+        client: fakeClient(calls),
+        cache: null
+      });
+      const matrix: any = await test.travel();
+      expect(calls).to.have.length(3);
+      expect(matrix.tiles).to.have.length(3);
+      expect(matrix.rows.map(row => row.elements[0].origin)).to.deep.equal(
+        crowd
+      );
+    });
+  });
   describe('errors', () => {
     it('returns error for invalid options on distance matrix search', () => {
       const test = new MeetHere(
@@ -204,6 +442,14 @@ describe('MeetHere', () => {
         .with.property('status')
         .that.equals('INVALID_REQUEST');
     });
+    it('refuses single precision on the earth', () => {
+      expect(
+        () =>
+          new MeetHere([[69.6, 18.9]], process.env.GOOGLE_MAPS_TOKEN, {
+            precision: 'f32'
+          })
+      ).to.throw("precision 'f32' needs spherical: false");
+    });
     it('returns error for no nearby roads', () => {
       const test = new MeetHere([], process.env.GOOGLE_MAPS_TOKEN);
       return test
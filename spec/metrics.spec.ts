@@ -0,0 +1,59 @@
+import { MeetHere, Metrics, Position } from '../src/index';
+import { expect } from 'chai';
+import 'mocha';
+
+describe('Metrics', () => {
+  afterEach(() => {
+    Metrics.disable();
+    Metrics.reset();
+  });
+
+  it('records nothing while disabled', () => {
+    new Position([[1, 2], [5, 6.6], [-7, 8.1]]).median;
+    const snapshot = Metrics.snapshot();
+    Object.keys(snapshot).forEach(entryPoint =>
+      expect(snapshot[entryPoint].calls).to.equal(0)
+    );
+  });
+  it('records calls per entry point while enabled', () => {
+    Metrics.enable();
+    const test = new Position([[1, 2], [5, 6.6], [-7, 8.1]]);
+    test.center;
+    test.move([1, 2], [1, 3]);
+    test.center;
+    const geometric = Metrics.snapshot()['center.geometric'];
+    expect(geometric.calls).to.equal(2);
+    expect(geometric.size.max).to.equal(3);
+    expect(geometric.compute.count).to.equal(2);
+    expect(geometric.compute.max).to.be.above(0);
+    expect(geometric.marshal.count).to.equal(2);
+    expect(geometric.unmarshal.count).to.equal(2);
+  });
+  it('records distance sums on the earth', () => {
+    Metrics.enable();
+    const test = new MeetHere(
+      [[33.09, -96.86], [33.04, -96.81], [33.02, -96.75]],
+      ''
+    );
+    test.medianCost;
+    const score = Metrics.snapshot()['geo.score'];
+    expect(score.calls).to.equal(1);
+    expect(score.size.max).to.equal(3);
+    expect(score.compute.count).to.equal(1);
+  });
+  it('resets recorded metrics', () => {
+    Metrics.enable();
+    new Position([[1, 2], [5, 6.6], [-7, 8.1]]).median;
+    Metrics.reset();
+    expect(Metrics.snapshot()['center.mass'].calls).to.equal(0);
+  });
+  it('exports sampled calls as trace events', () => {
+    Metrics.enable(1);
+    new Position([[1, 2], [5, 6.6], [-7, 8.1]]).median;
+    const trace = JSON.parse(Metrics.trace());
+    expect(trace.traceEvents.map(e => e.name)).to.include.members([
+      'center.mass',
+      'compute'
+    ]);
+  });
+});
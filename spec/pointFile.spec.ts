@@ -0,0 +1,109 @@
+import { MeetHere, PointFile, Position } from '../src/index';
+import { expect } from 'chai';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import 'mocha';
+
+describe('PointFile', () => {
+  const points = [[1, 2], [5, 6.6], [-7, 8.1], [3.1, -1.7]];
+  const file = path.join(os.tmpdir(), `meethere-${process.pid}.mhpt`);
+
+  afterEach(() => {
+    if (fs.existsSync(file)) {
+      fs.unlinkSync(file);
+    }
+  });
+
+  it('describes its layout', () => {
+    PointFile.write(file, points, { precision: 'f32', layout: 'columnar' });
+    expect(new PointFile(file).info).to.deep.equal({
+      count: 4,
+      single: true,
+      columnar: true,
+      weighted: false
+    });
+  });
+  it('matches a Position in every layout', () => {
+    const position = new Position(points, { degree: 3 });
+    [
+      {},
+      { layout: 'columnar' },
+      { precision: 'f32' },
+      { precision: 'f32', layout: 'columnar' }
+    ].forEach(options => {
+      PointFile.write(file, points, options);
+      const test = new PointFile(file);
+      const single = options['precision'] === 'f32';
+      const tolerance = single ? 1e-5 : 1e-12;
+      // rounded coordinates may steer the search elsewhere within epsilon
+      const searchTolerance = single ? 2 * position.options.epsilon : 1e-12;
+      test.center.forEach((v, i) =>
+        expect(v).to.be.closeTo(position.center[i], searchTolerance)
+      );
+      test.median.forEach((v, i) =>
+        expect(v).to.be.closeTo(position.median[i], tolerance)
+      );
+      expect(test.medianCost).to.be.closeTo(position.medianCost, tolerance);
+      test
+        .polynomial(3)
+        .forEach((v, i) =>
+          expect(v).to.be.closeTo(position.polynomial[i], tolerance)
+        );
+    });
+  });
+  it('counts weighted points weight times', () => {
+    PointFile.write(file, points, { weights: [1, 2, 1, 3] });
+    const repeated = new Position([
+      [1, 2],
+      [5, 6.6],
+      [5, 6.6],
+      [-7, 8.1],
+      [3.1, -1.7],
+      [3.1, -1.7],
+      [3.1, -1.7]
+    ]);
+    const test = new PointFile(file);
+    test.median.forEach((v, i) =>
+      expect(v).to.be.closeTo(repeated.median[i], 1e-12)
+    );
+    expect(test.medianCost).to.be.closeTo(repeated.medianCost, 1e-9);
+  });
+  it('sums earthly distances as a MeetHere', () => {
+    const locations = [
+      [33.0952311, -96.8640427],
+      [33.0437115, -96.8157956],
+      [33.0284505, -96.7546927]
+    ];
+    PointFile.write(file, locations);
+    const meetHere = new MeetHere(locations, '');
+    const center = meetHere.median;
+    const distances = meetHere.distanceMatrix('km', false).distances;
+    expect(new PointFile(file).distanceSum(center, 'km')).to.be.closeTo(
+      distances.reduce((a, b) => a + b, 0),
+      1e-6
+    );
+  });
+  it('reports every result of one search', () => {
+    PointFile.write(file, points);
+    const test = new PointFile(file);
+    const result = test.solve();
+    expect(test.center).to.deep.equal(result.center);
+    expect(test.centerStats).to.deep.equal(result.stats);
+    expect(test.centerCost).to.equal(result.score);
+    test.options.maxIterations = 3;
+    expect(test.solve()).to.not.equal(result);
+    expect(test.centerStats.iterations).to.equal(3);
+  });
+  it('throws for a file with no points to center', () => {
+    PointFile.write(file, []);
+    const test = new PointFile(file);
+    expect(test.info.count).to.equal(0);
+    expect(() => test.center).to.throw('holds no points');
+    expect(() => test.median).to.throw('holds no points');
+  });
+  it('throws for a file that is not a point file', () => {
+    fs.writeFileSync(file, 'not a point file, but long enough');
+    expect(() => new PointFile(file).center).to.throw('not a point file');
+  });
+});
@@ -27,6 +27,38 @@ describe('Position', () => {
       expect(test.remove([5, 3])).to.deep.equal([5, 3]);
       expect(test.locations).to.deep.equal([[1, 2]]);
     });
+    it('fills removed slots with the last location', () => {
+      const test = new Position([[1, 2], [5, 3], [7, 4]]);
+      expect(test.remove([1, 2])).to.deep.equal([1, 2]);
+      expect(test.locations).to.deep.equal([[7, 4], [5, 3]]);
+      expect(test.remove([7, 4])).to.deep.equal([7, 4]);
+      expect(test.locations).to.deep.equal([[5, 3]]);
+    });
+    it('removes duplicate points one at a time', () => {
+      const test = new Position([[1, 2], [5, 3], [1, 2]]);
+      expect(test.remove([1, 2])).to.deep.equal([1, 2]);
+      expect(test.remove([1, 2])).to.deep.equal([1, 2]);
+      expect(test.remove([1, 2])).to.equal(-1);
+      expect(test.locations).to.deep.equal([[5, 3]]);
+    });
+    it('finds points after they are added, moved and removed', () => {
+      const test = new Position([[1, 2], [5, 3]]);
+      test.add([0, 0]);
+      test.move([5, 3], [6, 6]);
+      test.remove([1, 2]);
+      expect(test.remove([5, 3])).to.equal(-1);
+      expect(test.remove([6, 6])).to.deep.equal([6, 6]);
+      expect(test.remove([0, 0])).to.deep.equal([0, 0]);
+      expect(test.locations).to.deep.equal([]);
+    });
+    it('refuses to edit locations changed behind its back', () => {
+      const test = new Position([[1, 2], [5, 3], [7, 4]]);
+      test.locations[2] = [9, 9];
+      expect(() => test.remove([1, 2])).to.throw('not indexed at slot 2');
+      expect(test.locations).to.deep.equal([[1, 2], [5, 3], [9, 9]]);
+      expect(() => test.move([7, 4], [0, 0])).to.throw('not indexed at slot 2');
+      expect(test.locations).to.deep.equal([[1, 2], [5, 3], [9, 9]]);
+    });
     it('returns invalid index for removal of non-existent element', () => {
       const test = new Position([[1, 2]]);
       expect(test.remove([5, 3])).to.equal(-1);
@@ -60,6 +92,74 @@ describe('Position', () => {
         2.001119760004479
       ]);
     });
+    it('reports geometric center search telemetry', () => {
+      const test = new Position([[1, 2], [5, 6.6], [-7, 8.1], [3.1, -1.7]]);
+      const stats = test.centerStats;
+      expect(stats.converged).to.equal(true);
+      expect(stats.iterations).to.be.above(0);
+      expect(stats.costEvaluations).to.be.above(stats.iterations);
+      expect(stats.finalStep).to.be.at.most(test.options.epsilon);
+    });
+    it('stops the geometric center search at its iteration budget', () => {
+      const test = new Position([[1, 2], [5, 6.6], [-7, 8.1], [3.1, -1.7]], {
+        maxIterations: 3
+      });
+      const stats = test.centerStats;
+      expect(stats.iterations).to.equal(3);
+      expect(stats.converged).to.equal(false);
+      expect(stats.finalStep).to.be.above(test.options.epsilon);
+    });
+    it('reports on the search that found the center', () => {
+      const test = new Position([[1, 2], [5, 6.6], [-7, 8.1], [3.1, -1.7]], {
+        maxMicros: 50
+      });
+      const result = test.solve();
+      expect(test.center).to.deep.equal(result.center);
+      expect(test.centerStats).to.deep.equal(result.stats);
+      expect(test.centerCost).to.equal(result.score);
+      test.add([2, 2]);
+      expect(test.solve()).to.not.equal(result);
+    });
+    it('searches again once the options change', () => {
+      const test = new Position([[1, 2], [5, 6.6], [-7, 8.1], [3.1, -1.7]]);
+      const result = test.solve();
+      expect(test.solve()).to.equal(result);
+      test.options.maxIterations = 3;
+      expect(test.solve()).to.not.equal(result);
+      expect(test.centerStats.iterations).to.equal(3);
+    });
+    it('keeps the center from changes made to a copy of it', () => {
+      const test = new Position([[1, 2], [5, 6.6], [-7, 8.1], [3.1, -1.7]]);
+      const center = test.center;
+      center[0] = 100;
+      expect(test.center).to.not.deep.equal(center);
+    });
+    it('finds geometric center of points merged by grid cell', () => {
+      const fixes = [
+        [1, 2],
+        [1.001, 2.002],
+        [1.002, 2.001],
+        [5, 6.6],
+        [5.003, 6.601],
+        [-7, 8.1],
+        [3.1, -1.7]
+      ];
+      const cellSize = 0.01;
+      const exact = new Position(fixes);
+      const merged = new Position(fixes, { cellSize });
+      expect(merged.centerCost).to.be.at.most(
+        exact.centerCost + 2 * Math.SQRT2 * cellSize * fixes.length
+      );
+    });
+    it('finds geometric center of points in single precision', () => {
+      const points = [[1, 2], [5, 6.6], [-7, 8.1], [3.1, -1.7]];
+      const double = new Position(points);
+      const single = new Position(points, { precision: 'f32' });
+      single.center.forEach((v, i) =>
+        expect(v).to.be.closeTo(double.center[i], single.options.epsilon)
+      );
+      expect(single.centerCost).to.be.closeTo(double.centerCost, 1e-5);
+    });
     it('finds median of points', () => {
       const test = new Position([[1, 2], [5, 6.6], [-7, 8.1], [3.1, -1.7]]);
       expect(test.median).to.deep.equal([0.525, 3.75]);
@@ -78,7 +178,45 @@ describe('Position', () => {
         [6.3, 8.1],
         [9, 2.8]
       ]);
-      expect(test.bestPath).to.deep.equal([0, 2, 7, 1, 4, 5, 9, 3, 6, 8, 10]);
+      expect(test.bestPath).to.deep.equal([0, 2, 7, 1, 5, 4, 9, 3, 6, 8, 10]);
+    });
+    it('finds the shortest path where the nearest stop misleads', () => {
+      const test = new Position([[0, 0], [1, 0], [-1.5, 0], [3, 0]]);
+      expect(test.bestPath).to.deep.equal([0, 2, 1, 3]);
+    });
+    it('finds the shortest path through 16 stops along an arc', () => {
+      // stop i sits at 20 * ((i * 7) % 16) degrees, so the arc is walked in
+      // the order of the same shuffle
+      const order = Array.from(Array(16).keys()).map(i => (i * 7) % 16);
+      const locations = order.map(k => [
+        10 * Math.cos((k * 20 * Math.PI) / 180),
+        10 * Math.sin((k * 20 * Math.PI) / 180)
+      ]);
+      ['f64', 'f32'].forEach(precision => {
+        const test = new Position(locations, { precision });
+        expect(test.bestPath).to.deep.equal(order);
+      });
+    });
+    it('visits every location less than a unit apart', () => {
+      const locations = Array.from(Array(40).keys()).map(i => [
+        ((i * 7) % 40) / 10,
+        0
+      ]);
+      const sorted = Array.from(Array(40).keys());
+      ['f64', 'f32'].forEach(precision => {
+        const test = new Position(locations, { precision });
+        const path = test.bestPath;
+        expect(path[0]).to.equal(0);
+        expect(path.slice().sort((a, b) => a - b)).to.deep.equal(sorted);
+      });
+    });
+    it('visits every location along a Hilbert curve', () => {
+      const test = new Position(
+        [[5.4, 0.3], [0.8, 7.3], [1.3, 1.2], [7.6, 9], [4.6, 6.7], [3.8, 8.4]],
+        { path: 'hilbert', startIndex: 3 }
+      );
+      expect(test.bestPath[0]).to.equal(3);
+      expect(test.bestPath.slice().sort()).to.deep.equal([0, 1, 2, 3, 4, 5]);
     });
     it('finds naive~shortest drive paths', () => {
       const test = new Position([
@@ -94,7 +232,26 @@ describe('Position', () => {
         [6.3, 8.1],
         [9, 2.8]
       ]);
-      expect(test.quickPath).to.deep.equal([0, 2, 7, 1, 4, 5, 9, 3, 6, 8, 10]);
+      expect(test.quickPath).to.deep.equal([0, 2, 7, 1, 5, 4, 9, 3, 6, 8, 10]);
+    });
+    it('finds the same paths in single precision', () => {
+      const locations = [
+        [5.4, 0.3],
+        [0.8, 7.3],
+        [1.3, 1.2],
+        [7.6, 9],
+        [4.6, 6.7],
+        [3.8, 8.4],
+        [8.9, 9],
+        [0, 2.1],
+        [8.9, 7.6],
+        [6.3, 8.1],
+        [9, 2.8]
+      ];
+      const double = new Position(locations);
+      const single = new Position(locations, { precision: 'f32' });
+      expect(single.bestPath).to.deep.equal(double.bestPath);
+      expect(single.quickPath).to.deep.equal(double.quickPath);
     });
     it('calculates polynomial', () => {
       const test = new Position([[1, 2], [5, 6.6], [-7, 8.1], [3.1, -1.7]]);
@@ -103,6 +260,33 @@ describe('Position', () => {
       );
     });
   });
+  describe('spatial queries', () => {
+    it('finds the nearest points', () => {
+      const test = new Position([[0, 0], [5, 10], [3, 4], [-1, 1]]);
+      expect(test.nearest(2, [4, 4])).to.deep.equal([[3, 4], [0, 0]]);
+      expect(test.nearest(10, [0, 0])).to.have.lengthOf(4);
+    });
+    it('finds points within a radius', () => {
+      const test = new Position([[0, 0], [5, 10], [3, 4], [-1, 1]]);
+      expect(test.within(5, [0, 0])).to.deep.equal([[0, 0], [-1, 1], [3, 4]]);
+    });
+    it('finds points inside a box', () => {
+      const test = new Position([[0, 0], [5, 10], [3, 4], [-1, 1]]);
+      expect(test.inBox([-1, 0], [3, 4])).to.have.deep.members([
+        [0, 0],
+        [3, 4],
+        [-1, 1]
+      ]);
+    });
+    it('follows added, moved and removed points', () => {
+      const test = new Position([[0, 0], [5, 10], [3, 4]]);
+      expect(test.nearest(1, [0, 0])).to.deep.equal([[0, 0]]);
+      test.remove([0, 0]);
+      test.add([1, 1]);
+      test.move([5, 10], [0, 1]);
+      expect(test.nearest(3, [0, 0])).to.deep.equal([[0, 1], [1, 1], [3, 4]]);
+    });
+  });
   describe('calculates cost', () => {
     it('calculates cost for median', () => {
       const test = new Position([[0, 0], [0, 1], [1, 0]]);
@@ -0,0 +1,94 @@
+import { ResponseCache } from '../src/index';
+import { expect, should, use } from 'chai';
+import * as promise from 'chai-as-promised';
+import 'mocha';
+
+should();
+use(promise);
+
+describe('ResponseCache', () => {
+  let time = 0;
+  const now = () => time;
+  const counter = () => {
+    const count = { calls: 0 };
+    const request = (value: any, fail: boolean = false) => () => {
+      ++count.calls;
+      return fail ? Promise.reject(value) : Promise.resolve(value);
+    };
+    return { count, request };
+  };
+
+  beforeEach(() => {
+    time = 0;
+  });
+
+  describe('keys', () => {
+    it('quantizes points', () => {
+      expect(ResponseCache.key('m', [[33.00001, -96.00004]], {})).to.equal(
+        ResponseCache.key('m', [[33.00003, -96.00002]], {})
+      );
+      expect(ResponseCache.key('m', [[33.0001, -96]], {})).to.not.equal(
+        ResponseCache.key('m', [[33.0003, -96]], {})
+      );
+    });
+    it('ignores the order of options', () => {
+      expect(ResponseCache.key('m', [], { a: 1, b: [2] })).to.equal(
+        ResponseCache.key('m', [], { b: [2], a: 1, c: undefined })
+      );
+    });
+    it('tells methods apart', () => {
+      expect(ResponseCache.key('m', [], {})).to.not.equal(
+        ResponseCache.key('n', [], {})
+      );
+    });
+  });
+  it('reuses responses until they expire', async () => {
+    const cache = new ResponseCache({ ttl: 100, now });
+    const { count, request } = counter();
+    expect(await cache.fetch('k', request(1))).to.equal(1);
+    time = 99;
+    expect(await cache.fetch('k', request(2))).to.equal(1);
+    time = 100;
+    expect(await cache.fetch('k', request(3))).to.equal(3);
+    expect(count.calls).to.equal(2);
+  });
+  it('coalesces requests in flight', async () => {
+    const cache = new ResponseCache({ now });
+    const { count, request } = counter();
+    const responses = await Promise.all([
+      cache.fetch('k', request(1)),
+      cache.fetch('k', request(2)),
+      cache.fetch('k', request(3))
+    ]);
+    expect(responses).to.deep.equal([1, 1, 1]);
+    expect(count.calls).to.equal(1);
+  });
+  it('caches failures for their own lifetime', async () => {
+    const cache = new ResponseCache({ ttl: 100, errorTtl: 10, now });
+    const { count, request } = counter();
+    await cache
+      .fetch('k', request('bad', true))
+      .should.be.rejectedWith('bad');
+    time = 9;
+    await cache
+      .fetch('k', request('worse', true))
+      .should.be.rejectedWith('bad');
+    time = 10;
+    expect(await cache.fetch('k', request('good'))).to.equal('good');
+    expect(count.calls).to.equal(2);
+  });
+  it('evicts the least recently used responses', async () => {
+    const cache = new ResponseCache({ maxEntries: 2, now });
+    const { count, request } = counter();
+    await cache.fetch('a', request('a'));
+    await cache.fetch('b', request('b'));
+    await cache.fetch('a', request('a'));
+    await cache.fetch('c', request('c'));
+    expect(cache.size).to.equal(2);
+    expect(count.calls).to.equal(3);
+    await cache.fetch('a', request('a'));
+    expect(count.calls).to.equal(3);
+    await cache.fetch('b', request('b'));
+    expect(count.calls).to.equal(4);
+  });
+});
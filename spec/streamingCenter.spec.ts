@@ -0,0 +1,36 @@
+import { Position, StreamingCenter } from '../src/index';
+import { expect } from 'chai';
+import 'mocha';
+
+describe('StreamingCenter', () => {
+  const points = [[1, 2], [5, 6.6], [-7, 8.1], [3.1, -1.7], [4, 4], [0, -3]];
+
+  it('keeps only the pings within its window', () => {
+    const stream = new StreamingCenter(3);
+    points.forEach((point, i) => stream.push(point, i));
+    expect(stream.size).to.equal(4);
+  });
+  it('matches a Position over its window', () => {
+    const stream = new StreamingCenter(3, { tolerance: 1e-6 });
+    points.forEach((point, i) => {
+      stream.push(point, i);
+      const position = new Position(points.slice(Math.max(0, i - 3), i + 1));
+      expect(stream.centerCost).to.be.closeTo(position.centerCost, 1e-2);
+    });
+  });
+  it('does not search again for pings that barely move it', () => {
+    const stream = new StreamingCenter(100, { tolerance: 0.5 });
+    points.forEach((point, i) => stream.push(point, i));
+    expect(stream.solve().resolved).to.be.true;
+    stream.push([1.01, 2.01], 6);
+    expect(stream.solve().resolved).to.be.false;
+    expect(stream.solve().resolved).to.be.false;
+  });
+  it('searches again once the window has drifted', () => {
+    const stream = new StreamingCenter(100, { tolerance: 0.5 });
+    points.forEach((point, i) => stream.push(point, i));
+    stream.solve();
+    stream.push([50, 50], 6);
+    expect(stream.solve().resolved).to.be.true;
+  });
+});
@@ -0,0 +1,11 @@
+import * as Bindings from 'bindings';
+
+/**
+ * The native addon, loaded once and shared by every module.
+ *
+ * @constant
+ * @private
+ */
+const NATIVE = Bindings('meethere');
+
+export { NATIVE };
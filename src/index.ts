@@ -1,2 +1,7 @@
 export { Position } from './position';
 export { MeetHere } from './meetHere';
+export { Metrics } from './metrics';
+export { PointFile } from './pointFile';
+export { StreamingCenter } from './streamingCenter';
+export { ResponseCache } from './util/responseCache';
+export { MatrixPlanner } from './util/matrixPlanner';
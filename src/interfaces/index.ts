@@ -1,3 +1,5 @@
+import { ResponseCache } from '../util/responseCache';
+
 /**
  * Describes a Google Maps client
  *
@@ -36,6 +38,120 @@ export interface CenterOptions {
   bounds?: number;
   startIndex?: number;
   degree?: number;
+  maxIterations?: number;
+  maxMicros?: number;
+  spherical?: boolean;
+  cellSize?: number;
+  precision?: string;
+  path?: string;
+}
+
+/**
+ * Describes the telemetry of a geometric center search
+ *
+ * @interface
+ */
+export interface CenterStats {
+  iterations: number;
+  costEvaluations: number;
+  stepHalvings: number;
+  finalStep: number;
+  converged: boolean;
+}
+
+/**
+ * Describes the result of a geometric center search
+ *
+ * @interface
+ */
+export interface CenterResult {
+  center: Array<number>;
+  score: number;
+  stats: CenterStats;
+}
+
+/**
+ * Describes a StreamingCenterOptions Object
+ *
+ * @interface
+ */
+export interface StreamingCenterOptions extends CenterOptions {
+  tolerance?: number;
+}
+
+/**
+ * Describes how a point file is laid out
+ *
+ * @interface
+ */
+export interface PointFileInfo {
+  count: number;
+  single: boolean;
+  columnar: boolean;
+  weighted: boolean;
+}
+
+/**
+ * Describes a PointFileOptions Object
+ *
+ * @interface
+ */
+export interface PointFileOptions {
+  precision?: string;
+  layout?: string;
+  weights?: Array<number>;
+}
+
+/**
+ * Describes a CacheOptions Object
+ *
+ * @interface
+ */
+export interface CacheOptions {
+  maxEntries?: number;
+  ttl?: number;
+  errorTtl?: number;
+  precision?: number;
+  now?: () => number;
+}
+
+/**
+ * Describes a PlannerOptions Object
+ *
+ * @interface
+ */
+export interface PlannerOptions {
+  maxOrigins?: number;
+  maxDestinations?: number;
+  maxElements?: number;
+  concurrency?: number;
+  retries?: number;
+  backoff?: number;
+  now?: () => number;
+  sleep?: (ms: number) => Promise<void>;
+}
+
+/**
+ * Describes a TileReport Object
+ *
+ * @interface
+ */
+export interface TileReport {
+  origins: Array<number>;
+  destinations: Array<number>;
+  attempts: number;
+  latency: number;
+}
+
+/**
+ * Describes the services a MeetHere makes requests through
+ *
+ * @interface
+ */
+export interface ServiceOptions {
+  client?: GoogleMapsClient;
+  cache?: ResponseCache | null;
+  planner?: PlannerOptions;
 }
 
 /**
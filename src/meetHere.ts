@@ -1,19 +1,22 @@
-import { Bindings, Position } from './position';
+import { NATIVE } from './bindings';
+import { Position } from './position';
 import { createClient } from '@google/maps';
 import {
   GoogleMapsClient,
   CenterOptions,
+  CenterResult,
   DistanceOptions,
   PlacesOptions,
+  ServiceOptions,
   TimeZoneOptions
 } from './interfaces/index';
-const CARTESIAN = Bindings('cartesian');
+import { asciiDistanceModes, asciiDistanceUnits } from './util/distance';
+import { MatrixPlanner } from './util/matrixPlanner';
+import { ResponseCache } from './util/responseCache';
+const CENTER = NATIVE.center;
+const GEO = NATIVE.geo;
 const KM = 'km';
 const MI = 'mi';
-const asciiDistanceUnits = {
-  km: 107,
-  mi: 109
-};
 
 /**
  * A prototype describing a set of points on a map, with first-class Google Maps
@@ -41,11 +44,47 @@ const asciiDistanceUnits = {
  * }
  * ```
  *
+ * Responses are cached, keyed by the center rounded to about 11 meters and by
+ * the options of the request, and identical requests in flight are made only
+ * once. By default every MeetHere making requests through the same client, or
+ * through clients created from the same API token, shares a cache, so groups
+ * meeting near one another reuse each other's responses; responses never
+ * cross from one client or token to another unless `MeetHere.sharedCache` is
+ * passed as the cache.
+ *
+ * Travel matrices too big for a single Distance Matrix request are split into
+ * tiles within its limits, sent a few at a time with retries, and merged back.
+ *
  * @class
  * @extends Position
  */
 class MeetHere extends Position {
   client: GoogleMapsClient;
+  cache: ResponseCache | null;
+  planner: MatrixPlanner;
+  private store: any = null;
+
+  /**
+   * Cache of responses any MeetHere may opt in to sharing, whatever client or
+   * API token it makes requests with
+   *
+   * @type {ResponseCache}
+   */
+  static sharedCache: ResponseCache = new ResponseCache();
+
+  /**
+   * Default caches of responses, by the client given through `services`
+   *
+   * @private
+   */
+  private static clientCaches = new WeakMap<object, ResponseCache>();
+
+  /**
+   * Default caches of responses, by the API token clients were created from
+   *
+   * @private
+   */
+  private static tokenCaches = new Map<string, ResponseCache>();
 
   /**
    * Default geometric center options
@@ -59,7 +98,11 @@ class MeetHere extends Position {
     epsilon: 1e-4,
     bounds: 10,
     startIndex: 0,
-    degree: null
+    degree: null,
+    maxIterations: 0,
+    maxMicros: 0,
+    spherical: true,
+    cellSize: 0
   };
 
   /**
@@ -104,15 +147,167 @@ class MeetHere extends Position {
    * @param {Array} locations 2D Array of points on a map
    * @param {string} token Google Maps API token
    * @param {CenterOptions} [options=MeetHere.defaultCenterOptions] Whether to
-   * search for centroid obliquely
+   * search for centroid obliquely, or on the earth's surface (`spherical`)
+   * @throws {Error} If asked for a `precision` of `'f32'` on the earth's
+   * surface, which is only computed in double precision
+   * @param {ServiceOptions} [services={}] Client to make Google Maps requests
+   * through instead of one created from the token, cache of their responses
+   * instead of the one of the client or token (`null` for none), and how to
+   * split up distance matrix requests
    */
   constructor(
     locations: Array<Array<number>>,
     token: string,
-    options: CenterOptions = {}
+    options: CenterOptions = {},
+    services: ServiceOptions = {}
   ) {
     super(locations, { ...MeetHere.defaultCenterOptions, ...options });
-    this.client = createClient({ key: token, Promise: Promise });
+    if (this.options.spherical && this.single) {
+      throw new Error(
+        "MeetHere: precision 'f32' needs spherical: false; " +
+          'surface distances are only computed in double precision'
+      );
+    }
+    this.client =
+      services.client || createClient({ key: token, Promise: Promise });
+    this.cache =
+      services.cache === undefined
+        ? MeetHere.defaultCache(services.client, token)
+        : services.cache;
+    this.planner = new MatrixPlanner(services.planner);
+  }
+
+  /**
+   * Locations of a MeetHere are Latitude/Longitude points, so spatial queries
+   * (`nearest`, `within`, `inBox`) measure kilometers along the earth's
+   * surface, and boxes may cross the antimeridian.
+   *
+   * @function
+   * @protected
+   * @return {boolean} Always true
+   */
+  protected get geographic(): boolean {
+    return true;
+  }
+
+  /**
+   * Returns the native store of the locations with their trigonometry worked
+   * out, building it on first use. It is kept in sync by the edit hooks from
+   * then on, so distances, centers and routes only pay for the trigonometry
+   * of locations that changed.
+   *
+   * @function
+   * @private
+   * @return {Object} Point store whose slots are slots of the locations
+   */
+  private geoStore(): any {
+    if (!this.store) {
+      this.store = new GEO.Store();
+      this.store.build(this.locations);
+    }
+    return this.store;
+  }
+
+  /**
+   * Keeps the point store in step with the locations, as Position#onAdd.
+   *
+   * @function
+   * @protected
+   * @param {number} slot Slot of the new location
+   */
+  protected onAdd(slot: number): void {
+    super.onAdd(slot);
+    if (this.store) {
+      this.store.add(this.locations[slot]);
+    }
+  }
+
+  /**
+   * Keeps the point store in step with the locations, as Position#onRemove.
+   *
+   * @function
+   * @protected
+   * @param {number} slot Slot of the removed location
+   * @param {number} last Former last slot, whose location moved to `slot`
+   */
+  protected onRemove(slot: number, last: number): void {
+    super.onRemove(slot, last);
+    if (this.store) {
+      this.store.remove(slot);
+    }
+  }
+
+  /**
+   * Keeps the point store in step with the locations, as Position#onMove.
+   *
+   * @function
+   * @protected
+   * @param {number} slot Slot of the replaced location
+   * @param {Array} previous Location previously at the slot
+   */
+  protected onMove(slot: number, previous: Array<number>): void {
+    super.onMove(slot, previous);
+    if (this.store) {
+      this.store.set(slot, this.locations[slot]);
+    }
+  }
+
+  /**
+   * Searches for the geometric center of the MeetHere. With the `spherical`
+   * option (the default), the center minimizes net great-circle distance
+   * and its cost is in kilometers; otherwise it minimizes planar distance in
+   * degrees, as for a Position. Either way, locations sharing a grid cell of
+   * `cellSize` degrees are merged into one weighted location first if given;
+   * on the sphere, the center found then costs at most
+   * `2 * sqrt(2) * cellSize * 111.19` kilometers per location more than the
+   * exact one.
+   *
+   * @function
+   * @protected
+   * @return {CenterResult} Geometric center, its cost, and search telemetry
+   */
+  protected geometricCenter(): CenterResult {
+    if (!this.options.spherical) {
+      return super.geometricCenter();
+    }
+    return this.geoStore().center(
+      this.options.epsilon,
+      this.options.maxIterations,
+      this.options.maxMicros,
+      this.options.cellSize
+    );
+  }
+
+  /**
+   * Calculates the net cost of travelling from the points to their median, in
+   * the same units as MeetHere#centerCost.
+   *
+   * @name MeetHere#medianCost
+   * @function
+   * @return {number} Cost of travelling
+   */
+  get medianCost(): number {
+    if (!this.options.spherical) {
+      return CENTER.mass(this.locations).score;
+    }
+    return this.geoStore().score(this.median);
+  }
+
+  /**
+   * Searches for a short path between all locations. With the `spherical`
+   * option (the default), travel is measured along the earth's surface;
+   * otherwise it is measured in degrees, as for a Position. Hilbert paths
+   * follow the curve over Latitude/Longitude either way.
+   *
+   * @function
+   * @protected
+   * @return {Array} Order of indeces of the locations
+   */
+  protected shortestPath(): Array<number> {
+    if (!this.options.spherical || this.options.path === 'hilbert') {
+      return super.shortestPath();
+    }
+    return this.geoStore().route(this.options.startIndex);
   }
 
   /**
@@ -137,7 +332,7 @@ class MeetHere extends Position {
    *
    * ```
    * let map = new MeetHere([[-33, 44], [-35, 41], [-31, 43]]);
-   * map.meetHere; // => [-32.80928, 43.39817]
+   * map.meetHere; // => [-32.90847, 43.59216]
    * ```
    */
   get meetHere(): Array<number> {
@@ -152,29 +347,114 @@ class MeetHere extends Position {
    * @function
    * @param {string} [units='km'] Units of distance to use, can be 'km' or 'mi'
    * @param {boolean} [geometric=true] Whether to use geometric or median center
+   * @param {string} [mode='exact'] Formula to measure distance with: 'exact',
+   * or one of the faster approximations 'polynomial' (within 5e-9),
+   * 'equirectangular' (within 0.001% up to 10 km within 80° of the equator,
+   * and `θ² / (20 cos² φ)` up to 1000 km, for an angle θ apart and φ the
+   * latitude further from the equator) or 'chord' (never longer, within
+   * 0.001% up to 100 km)
    * @return {Object.<string, Array>} A Promise that will yield distances or
    * an error
    *
    * ```
    * let map = new MeetHere([[-33, 44], [-35, 41], [-31, 43]]);
    * map.distance; // => { origins: [[-33, 44], [-35, 41], [-31, 43]],
-   *               //      destination: [-32.80928, 43.39817],
-   *               //      distances: [37.31571, 204.49320, 127.17181] }
+   *               //      destination: [-32.90847, 43.59216],
+   *               //      distances: [24.47643, 207.23608, 136.35469] }
    * ```
    */
   distanceMatrix(
     units: string = KM,
-    geometric: boolean = true
+    geometric: boolean = true,
+    mode: string = 'exact'
   ): {
-    origins: Array<number>;
-    destinations: Array<number>;
+    origins: Array<Array<number>>;
+    destination: Array<number>;
     distances: Array<number>;
   } {
-    return CARTESIAN.distance(
-      this.locations,
-      this.middle(geometric),
-      asciiDistanceUnits[units]
-    );
+    const destination = this.middle(geometric);
+    return {
+      origins: this.locations,
+      destination,
+      distances: this.geoStore().distances(
+        destination,
+        asciiDistanceUnits[units],
+        asciiDistanceModes[mode]
+      )
+    };
+  }
+
+  /**
+   * Returns the default cache of responses of a MeetHere: the one of the
+   * client it was given, or else the one of the API token its client was
+   * created from.
+   *
+   * @function
+   * @private
+   * @static
+   * @param {GoogleMapsClient} client Client given through `services`, if any
+   * @param {string} token Google Maps API token
+   * @return {ResponseCache} Cache of responses of the client or token
+   */
+  private static defaultCache(
+    client: GoogleMapsClient,
+    token: string
+  ): ResponseCache {
+    let cache = client
+      ? MeetHere.clientCaches.get(client)
+      : MeetHere.tokenCaches.get(String(token));
+    if (!cache) {
+      cache = new ResponseCache();
+      if (client) {
+        MeetHere.clientCaches.set(client, cache);
+      } else {
+        MeetHere.tokenCaches.set(String(token), cache);
+      }
+    }
+    return cache;
+  }
+
+  /**
+   * Makes a Google Maps request through the cache, yielding the JSON of its
+   * response, or of its error.
+   *
+   * @function
+   * @private
+   * @param {string} method Method of the client to request with
+   * @param {Array} points Points the request is about, to key it by
+   * @param {Object} key Options of the query to key it by, besides the points
+   * @param {Function} send Sends the request, returning a Promise of its JSON
+   * @return {Promise} A Promise that will yield the response or an error
+   */
+  private request(
+    method: string,
+    points: Array<Array<number>>,
+    key: object,
+    send: () => Promise<object>
+  ): Promise<object> {
+    const response = this.cache
+      ? this.cache.fetch(
+          ResponseCache.key(method, points, key, this.cache.options.precision),
+          send
+        )
+      : send();
+    return response.catch(error => error.json);
+  }
+
+  /**
+   * Sends a query with a method of the client, yielding the JSON of its
+   * response.
+   *
+   * @function
+   * @private
+   * @param {string} method Method of the client to send with
+   * @param {Object} query Query to send
+   * @return {Promise} A Promise that will yield the response JSON
+   */
+  private send(method: string, query: object): Promise<object> {
+    return this.client[method](query)
+      .asPromise()
+      .then(response => response.json);
   }
 
   /**
@@ -193,12 +473,11 @@ class MeetHere extends Position {
     options: PlacesOptions = {},
     geometric: boolean = true
   ): Promise<object> {
-    options['location'] = this.middle(geometric);
-    return await this.client
-      .placesNearby({ ...MeetHere.defaultPlacesOptions, ...options })
-      .asPromise()
-      .then(response => response.json)
-      .catch(error => error.json);
+    const location = this.middle(geometric);
+    options = { ...MeetHere.defaultPlacesOptions, ...options };
+    return await this.request('placesNearby', [location], options, () =>
+      this.send('placesNearby', { ...options, location })
+    );
   }
 
   /**
@@ -212,11 +491,9 @@ class MeetHere extends Position {
    */
   async roads(geometric: boolean = true): Promise<object> {
     const center = this.middle(geometric);
-    return await this.client
-      .nearestRoads({ points: [center] })
-      .asPromise()
-      .then(response => response.json)
-      .catch(error => error.json);
+    return await this.request('nearestRoads', [center], {}, () =>
+      this.send('nearestRoads', { points: [center] })
+    );
   }
 
   /**
@@ -235,19 +512,19 @@ class MeetHere extends Position {
     options: TimeZoneOptions = {},
     geometric: boolean = true
   ): Promise<object> {
-    options['location'] = this.middle(geometric);
+    // a request for the present is keyed as such, rather than by the second
+    const location = this.middle(geometric);
     options = { ...MeetHere.defaultTimeZoneOptions, ...options };
-    options['timestamp'] = options['timestamp'] || ~~(Date.now() / 1000);
-    return await this.client
-      .timezone(options)
-      .asPromise()
-      .then(response => response.json)
-      .catch(error => error.json);
+    const timestamp = options['timestamp'] || ~~(Date.now() / 1000);
+    return await this.request('timezone', [location], options, () =>
+      this.send('timezone', { ...options, location, timestamp })
+    );
   }
 
   /**
    * Returns a matrix from each location to the center of the MeetHere with
-   * distance and time fields.
+   * distance and time fields. Groups too big for one request are requested in
+   * tiles, reported in the `tiles` field of the matrix.
    *
    * @name MeetHere#travel
    * @see https://googlemaps.github.io/google-maps-services-js/docs/GoogleMapsClient.html#distanceMatrix
@@ -262,16 +539,20 @@ class MeetHere extends Position {
     options: DistanceOptions = {},
     geometric: boolean = true
   ): Promise<object> {
-    options['origins'] = this.locations;
-    options['destinations'] = [this.middle(geometric)];
-    return await this.client
-      .distanceMatrix({
-        ...MeetHere.defaultDistanceOptions,
-        ...options
-      })
-      .asPromise()
-      .then(response => response.json)
-      .catch(error => error.json);
+    const origins = this.locations;
+    const destinations = [this.middle(geometric)];
+    options = { ...MeetHere.defaultDistanceOptions, ...options };
+    return await this.request(
+      'distanceMatrix',
+      origins.concat(destinations),
+      options,
+      () =>
+        this.planner.request(origins, destinations, (origins, destinations) =>
+          this.client
+            .distanceMatrix({ ...options, origins, destinations })
+            .asPromise()
+        )
+    );
   }
 }
 
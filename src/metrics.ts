@@ -0,0 +1,106 @@
+import { NATIVE } from './bindings';
+const METRICS = NATIVE.metrics;
+
+/**
+ * Describes a summary of a native histogram. Phase histograms are in
+ * nanoseconds; size histograms count points.
+ *
+ * @interface
+ */
+export interface HistogramSnapshot {
+  count: number;
+  sum: number;
+  min: number;
+  max: number;
+  mean: number;
+  p50: number;
+  p90: number;
+  p99: number;
+  p999: number;
+}
+
+/**
+ * Describes the metrics of a single native entry point
+ *
+ * @interface
+ */
+export interface EntryPointSnapshot {
+  calls: number;
+  size: HistogramSnapshot;
+  marshal: HistogramSnapshot;
+  compute: HistogramSnapshot;
+  unmarshal: HistogramSnapshot;
+}
+
+/**
+ * Opt-in instrumentation of the native addon. While enabled, every call into
+ * a native entry point records how long it spent converting its arguments
+ * (`marshal`), running the engine (`compute`) and building its result
+ * (`unmarshal`), along with its input size. A sampled fraction of calls is
+ * additionally kept as Chrome trace events.
+ *
+ * ```
+ * import { Metrics, Position } from 'meethere';
+ *
+ * Metrics.enable(0.01);
+ * new Position(locations).center;
+ * Metrics.snapshot()['center.geometric'].compute.p99; // => nanoseconds
+ * fs.writeFileSync('trace.json', Metrics.trace());
+ * ```
+ *
+ * @namespace
+ */
+const Metrics = {
+  /**
+   * Starts recording metrics.
+   *
+   * @function
+   * @param {number} [sampleRate=0] Fraction of calls, in [0, 1], to keep as
+   * trace events
+   */
+  enable(sampleRate: number = 0): void {
+    METRICS.enable(true, sampleRate);
+  },
+
+  /**
+   * Stops recording metrics. Recorded metrics are kept until reset.
+   *
+   * @function
+   */
+  disable(): void {
+    METRICS.enable(false, 0);
+  },
+
+  /**
+   * Returns the metrics recorded for each native entry point.
+   *
+   * @function
+   * @return {Object.<string, EntryPointSnapshot>} Metrics keyed by entry point
+   * name, e.g. `center.geometric`
+   */
+  snapshot(): { [entryPoint: string]: EntryPointSnapshot } {
+    return METRICS.snapshot();
+  },
+
+  /**
+   * Forgets every recorded metric and trace event.
+   *
+   * @function
+   */
+  reset(): void {
+    METRICS.reset();
+  },
+
+  /**
+   * Returns the sampled calls as Chrome trace-event JSON, which loads in
+   * chrome://tracing or Perfetto.
+   *
+   * @function
+   * @return {string} Trace-event JSON document
+   */
+  trace(): string {
+    return METRICS.trace();
+  }
+};
+
+export { Metrics };
@@ -0,0 +1,189 @@
+#include "arena.h"
+#include <cstdlib>
+#include <stdint.h>
+
+const size_t Arena::ALIGNMENT      = 64;
+const size_t Arena::MIN_BLOCK_SIZE = 64 * 1024;
+
+namespace
+{
+/**
+ * @brief  Rounds a byte count up to the arena alignment
+ *
+ * @param  bytes number of bytes
+ *
+ * @return smallest multiple of the alignment no less than bytes
+ */
+size_t alignUp(size_t bytes)
+{
+  return (bytes + Arena::ALIGNMENT - 1) & ~(Arena::ALIGNMENT - 1);
+}
+}  // namespace
+
+/**
+ * @brief  Returns the scratch arena of the calling thread
+ *
+ * @return thread-local scratch arena
+ */
+Arena::Scratch & Arena::Scratch::local()
+{
+  static thread_local Scratch scratch;
+  return scratch;
+}
+
+Arena::Scratch::Scratch() : current(0), offset(0), used(0), peak(0), depth(0)
+{
+}
+
+Arena::Scratch::~Scratch()
+{
+  freeBlocks();
+}
+
+/**
+ * @brief  Allocates aligned, uninitialized memory from the arena
+ *
+ * @param  bytes number of bytes to allocate
+ *
+ * @return 64-byte aligned pointer valid until the enclosing scope is released
+ */
+void * Arena::Scratch::allocate(size_t bytes)
+{
+  bytes = alignUp(bytes);
+
+  if (blocks.empty()) {
+    pushBlock(bytes);
+  }
+
+  // spill into the next block large enough, or reserve a new one
+  if (offset + bytes > blocks[current].size) {
+    size_t next = current + 1;
+    while (next < blocks.size() && blocks[next].size < bytes) {
+      ++next;
+    }
+    if (next == blocks.size()) {
+      pushBlock(bytes);
+    }
+    current = next;
+    offset  = 0;
+  }
+
+  void * mem = blocks[current].data + offset;
+  offset += bytes;
+  used += bytes;
+  if (used > peak) {
+    peak = used;
+  }
+  return mem;
+}
+
+/**
+ * @brief  Opens a scope, returning the position to rewind to on release
+ *
+ * @return current position in the arena
+ */
+Arena::Scratch::Mark Arena::Scratch::acquire()
+{
+  ++depth;
+  const Mark mark = {current, offset, used};
+  return mark;
+}
+
+/**
+ * @brief  Closes a scope, rewinding the arena to a previous position
+ * @details Coalesces spilled blocks to the high-water mark when the
+ *          outermost scope is released.
+ *
+ * @param  mark position returned by the matching acquire
+ */
+void Arena::Scratch::release(const Mark & mark)
+{
+  current = mark.block;
+  offset  = mark.offset;
+  used    = mark.used;
+
+  if (--depth == 0 && blocks.size() > 1) {
+    // nothing is live, so every block can be traded for one that holds the
+    // whole working set
+    freeBlocks();
+    pushBlock(peak);
+    current = 0;
+    offset  = 0;
+  }
+}
+
+/**
+ * @brief  Returns the largest number of bytes ever in use at once
+ *
+ * @return high-water mark of the arena, in bytes
+ */
+size_t Arena::Scratch::highWater() const
+{
+  return peak;
+}
+
+/**
+ * @brief  Returns the number of bytes reserved from the heap
+ *
+ * @return total capacity of the arena, in bytes
+ */
+size_t Arena::Scratch::capacity() const
+{
+  size_t total = 0;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    total += blocks[i].size;
+  }
+  return total;
+}
+
+/**
+ * @brief   Reserves a new block at the end of the arena
+ * @details Blocks grow geometrically so that a growing working set spills a
+ *          logarithmic number of times before it is coalesced.
+ *
+ * @param   minBytes minimum usable size of the block
+ */
+void Arena::Scratch::pushBlock(size_t minBytes)
+{
+  size_t size = MIN_BLOCK_SIZE;
+  if (!blocks.empty() && blocks.back().size * 2 > size) {
+    size = blocks.back().size * 2;
+  }
+  if (minBytes > size) {
+    size = alignUp(minBytes);
+  }
+
+  // over-allocate to align the block; the raw pointer is kept just before the
+  // aligned data so it can be freed
+  char * raw =
+      static_cast<char *>(std::malloc(size + ALIGNMENT + sizeof(void *)));
+  if (!raw) {
+    std::abort();
+  }
+  const uintptr_t start   = reinterpret_cast<uintptr_t>(raw + sizeof(void *));
+  char *          aligned = reinterpret_cast<char *>(alignUp(start));
+  reinterpret_cast<void **>(aligned)[-1] = raw;
+
+  const Block block = {aligned, size};
+  blocks.push_back(block);
+}
+
+/**
+ * @brief Returns every block to the heap
+ */
+void Arena::Scratch::freeBlocks()
+{
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    std::free(reinterpret_cast<void **>(blocks[i].data)[-1]);
+  }
+  blocks.clear();
+}
+
+Arena::Scope::Scope() : arena(Scratch::local()), mark(arena.acquire())
+{
+}
+
+Arena::Scope::~Scope()
+{
+  arena.release(mark);
+}
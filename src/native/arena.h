@@ -0,0 +1,184 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <vector>
+
+namespace Arena
+{
+extern const size_t ALIGNMENT;
+extern const size_t MIN_BLOCK_SIZE;
+
+/**
+ * @class
+ * @brief   Per-thread, reusable scratch memory for native entry points
+ * @details Memory is handed out by bumping an offset into a 64-byte aligned
+ *          block. Allocations that do not fit spill into additional blocks;
+ *          once the outermost Scope is released, the blocks are coalesced into
+ *          a single block sized to the high-water mark, so steady-state calls
+ *          make no heap allocations at all.
+ * @note    Use through Arena::Scope rather than directly.
+ */
+class Scratch
+{
+ public:
+  /**
+   * @struct
+   * @brief  A position in the scratch memory that can be rewound to
+   */
+  struct Mark {
+    size_t block;
+    size_t offset;
+    size_t used;
+  };
+
+  /**
+   * @brief  Returns the scratch arena of the calling thread
+   *
+   * @return thread-local scratch arena
+   */
+  static Scratch & local();
+
+  ~Scratch();
+
+  /**
+   * @brief  Allocates aligned, uninitialized memory from the arena
+   *
+   * @param  bytes number of bytes to allocate
+   *
+   * @return 64-byte aligned pointer valid until the enclosing scope is released
+   */
+  void * allocate(size_t bytes);
+
+  /**
+   * @brief  Opens a scope, returning the position to rewind to on release
+   *
+   * @return current position in the arena
+   */
+  Mark acquire();
+
+  /**
+   * @brief  Closes a scope, rewinding the arena to a previous position
+   * @details Coalesces spilled blocks to the high-water mark when the
+   *          outermost scope is released.
+   *
+   * @param  mark position returned by the matching acquire
+   */
+  void release(const Mark & mark);
+
+  /**
+   * @brief  Returns the largest number of bytes ever in use at once
+   *
+   * @return high-water mark of the arena, in bytes
+   */
+  size_t highWater() const;
+
+  /**
+   * @brief  Returns the number of bytes reserved from the heap
+   *
+   * @return total capacity of the arena, in bytes
+   */
+  size_t capacity() const;
+
+ private:
+  struct Block {
+    char * data;
+    size_t size;
+  };
+
+  Scratch();
+  Scratch(const Scratch &);
+  Scratch & operator=(const Scratch &);
+
+  void pushBlock(size_t minBytes);
+  void freeBlocks();
+
+  std::vector<Block> blocks;
+  size_t             current;
+  size_t             offset;
+  size_t             used;
+  size_t             peak;
+  size_t             depth;
+};
+
+/**
+ * @class
+ * @brief   RAII handle on the thread's scratch arena
+ * @details Everything allocated through a Scope is released together when the
+ *          Scope goes out of scope. Scopes may be nested freely.
+ *
+ * ```
+ * Arena::Scope scratch;
+ * double (*points)[2] = scratch.alloc<double[2]>(numPoints);
+ * ```
+ */
+class Scope
+{
+ public:
+  Scope();
+  ~Scope();
+
+  /**
+   * @brief  Allocates uninitialized storage for a number of elements
+   *
+   * @tparam T     type of element to allocate
+   * @param  count number of elements
+   *
+   * @return 64-byte aligned pointer to the first element
+   */
+  template <class T>
+  T * alloc(size_t count)
+  {
+    return static_cast<T *>(arena.allocate(count * sizeof(T)));
+  }
+
+  /**
+   * @brief  Allocates zero-initialized storage for a number of elements
+   *
+   * @tparam T     type of element to allocate
+   * @param  count number of elements
+   *
+   * @return 64-byte aligned pointer to the first element
+   */
+  template <class T>
+  T * zeroed(size_t count)
+  {
+    T * mem = alloc<T>(count);
+    for (size_t i = 0; i < count; ++i) {
+      mem[i] = T();
+    }
+    return mem;
+  }
+
+  /**
+   * @brief  Allocates a row-addressable rows x cols matrix backed by a single
+   *         contiguous buffer
+   *
+   * @tparam T    type of element to allocate
+   * @param  rows number of rows
+   * @param  cols number of columns
+   *
+   * @return array of row pointers
+   */
+  template <class T>
+  T ** matrix(size_t rows, size_t cols)
+  {
+    T ** index = alloc<T *>(rows);
+    T *  data  = alloc<T>(rows * cols);
+    for (size_t i = 0; i < rows; ++i) {
+      index[i] = data + i * cols;
+    }
+    return index;
+  }
+
+ private:
+  Scope(const Scope &);
+  Scope & operator=(const Scope &);
+
+  Scratch &           arena;
+  const Scratch::Mark mark;
+};
+
+}  // namespace Arena
+
+#endif
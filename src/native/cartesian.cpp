@@ -1,4 +1,5 @@
 #include "cartesian.h"
+#include <algorithm>
 #include <cmath>
 
 const long double Cartesian::PI                  = std::acos(-1.0L);
@@ -6,6 +7,44 @@ const size_t      Cartesian::EARTH_RADIUS_METERS = 6371e3;
 const double      Cartesian::METER_TO_KM         = 1e-3;
 const long double Cartesian::METER_TO_MI         = 6.2137119223733e-4;
 
+namespace
+{
+const double RADIANS = 3.14159265358979323846 / 180;
+const double TWO_PI  = 2 * 3.14159265358979323846;
+
+// points widened to double precision at a time by the single-precision
+// fillDistances, few enough to stay in L1
+const size_t WIDEN_BLOCK = 256;
+
+/**
+ * @brief  Wraps an angle into [-π, π]
+ */
+double wrapAngle(double angle)
+{
+  return angle - TWO_PI * std::floor(angle / TWO_PI + 0.5);
+}
+
+/**
+ * @brief  Calculates the haversine of the angle between two points, with
+ *         polynomial trigonometry
+ *
+ * @param  cosLat1 cosine of the first latitude
+ * @param  lat2    second latitude, in radians
+ * @param  dlat    second latitude less the first, in radians
+ * @param  dlng    second longitude less the first, in radians, within [-π, π]
+ *
+ * @return sin²(θ/2) for an angle θ between the points
+ */
+double haversineApprox(double cosLat1, double lat2, double dlat, double dlng)
+{
+  const double sinLat = Cartesian::sinApprox(dlat / 2);
+  const double sinLng = Cartesian::sinApprox(dlng / 2);
+  const double a =
+      sinLat * sinLat + cosLat1 * Cartesian::cosApprox(lat2) * sinLng * sinLng;
+  return std::min(1.0, a);
+}
+}  // namespace
+
 /**
  * @brief  Returns the radian measurement of a degree value
  *
@@ -18,6 +57,18 @@ double Cartesian::radiansFromDeg(double degrees)
   return degrees / 180 * PI;
 }
 
+/**
+ * @brief  Returns the factor that converts meters to a unit of distance
+ *
+ * @param  unit type of unit to use, as for haversine
+ *
+ * @return kilometers per meter for 'm', otherwise miles per meter
+ */
+double Cartesian::unitScale(char unit)
+{
+  return unit == 'm' ? METER_TO_KM : METER_TO_MI;
+}
+
 /**
  * @brief   Calculates the earthly distance between two cartesian points
  * @details Uses the Haversine formula to calculate the distance between two
@@ -46,5 +97,104 @@ double Cartesian::haversine(double startLat,
   const double c = 2 * std::atan2(sqrt(a), std::sqrt(1 - a));
   const double d = c * EARTH_RADIUS_METERS;
 
-  return d * (unit == 'm' ? METER_TO_KM : METER_TO_MI);
+  return d * unitScale(unit);
+}
+
+/**
+ * @brief   Calculates the earthly distance from a set of points to a center
+ *
+ * @param   points    Latitude/Longitude points, in degrees
+ * @param   numPoints number of points
+ * @param   center    Latitude/Longitude center, in degrees
+ * @param   unit      type of unit to use: meters or miles
+ * @param   fill      array to fill with the distance of each point
+ * @param   mode      formula to measure distance with
+ */
+void Cartesian::fillDistances(const double points[][2],
+                              size_t       numPoints,
+                              const double center[2],
+                              char         unit,
+                              double       fill[],
+                              DistanceMode mode)
+{
+  const double radius = EARTH_RADIUS_METERS * unitScale(unit);
+  const double phi    = center[0] * RADIANS;
+  const double cosPhi = cosApprox(phi);
+
+  switch (mode) {
+    case equirectangular:
+      for (size_t i = 0; i < numPoints; ++i) {
+        const double dlat = (points[i][0] - center[0]) * RADIANS;
+        const double dlng = wrapAngle((points[i][1] - center[1]) * RADIANS);
+        const double x    = dlng * cosApprox(phi + dlat / 2);
+        fill[i]           = std::sqrt(x * x + dlat * dlat) * radius;
+      }
+      return;
+    case chord:
+      for (size_t i = 0; i < numPoints; ++i) {
+        const double dlat = (points[i][0] - center[0]) * RADIANS;
+        const double dlng = wrapAngle((points[i][1] - center[1]) * RADIANS);
+        const double a    = haversineApprox(cosPhi, phi + dlat, dlat, dlng);
+        fill[i]           = 2 * std::sqrt(a) * radius;
+      }
+      return;
+    case polynomial:
+      for (size_t i = 0; i < numPoints; ++i) {
+        const double dlat = (points[i][0] - center[0]) * RADIANS;
+        const double dlng = wrapAngle((points[i][1] - center[1]) * RADIANS);
+        const double a    = haversineApprox(cosPhi, phi + dlat, dlat, dlng);
+        fill[i]           = 2 * asinApprox(std::sqrt(a)) * radius;
+      }
+      return;
+    default:
+      break;
+  }
+
+  const double lat1 = radiansFromDeg(center[0]);
+
+  for (size_t i = 0; i < numPoints; ++i) {
+    const double lat2 = radiansFromDeg(points[i][0]);
+
+    // dLat, dLng
+    const double dlat = radiansFromDeg(points[i][0] - center[0]);
+    const double dlng = radiansFromDeg(points[i][1] - center[1]);
+
+    fill[i] = haversine(lat1, lat2, dlat, dlng, unit);
+  }
+}
+
+/**
+ * @brief   Calculates the earthly distance from a set of single-precision
+ *          points to a center
+ * @details As fillDistances, widening the points to double precision a block
+ *          at a time: only storage is single precision, since the
+ *          trigonometry of every mode loses more in single precision than the
+ *          narrower vectors gain. Rounding the coordinates moves a point by
+ *          up to 0.85 m, at longitudes of 128° and beyond where floats are
+ *          2^-16° apart, and by up to 0.43 m at longitudes within 128°.
+ *
+ * @param   points    Latitude/Longitude points, in degrees
+ * @param   numPoints number of points
+ * @param   center    Latitude/Longitude center, in degrees
+ * @param   unit      type of unit to use: meters or miles
+ * @param   fill      array to fill with the distance of each point
+ * @param   mode      formula to measure distance with
+ */
+void Cartesian::fillDistances(const float  points[][2],
+                              size_t       numPoints,
+                              const double center[2],
+                              char         unit,
+                              double       fill[],
+                              DistanceMode mode)
+{
+  double block[WIDEN_BLOCK][2];
+
+  for (size_t start = 0; start < numPoints; start += WIDEN_BLOCK) {
+    const size_t count = std::min(WIDEN_BLOCK, numPoints - start);
+    for (size_t i = 0; i < count; ++i) {
+      block[i][0] = points[start + i][0];
+      block[i][1] = points[start + i][1];
+    }
+    fillDistances(block, count, center, unit, fill + start, mode);
+  }
 }
@@ -1,5 +1,11 @@
 #include "center.h"
+#include "arena.h"
+#include "cartesian.h"
+#include "geo.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <stdint.h>
 
 /*
  *           (0,1)
@@ -12,6 +18,578 @@ const double Center::S2        = std::sqrt(2) / 2;
 const double Center::DELTA_X[] = {-1, -S2, 0, S2, 1, S2, 0, -S2};
 const double Center::DELTA_Y[] = {0, S2, 1, S2, 0, -S2, -1, -S2};
 
+// sine of the angle below which a point is taken to coincide with the center
+const double Center::COINCIDENT = 1e-12;
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @struct
+ * @brief  Unit vectors of a set of points, one array per coordinate so that
+ *         kernels over them vectorize
+ */
+struct UnitVectors {
+  const double * x;
+  const double * y;
+  const double * z;
+};
+
+/**
+ * @struct
+ * @brief  Weights of a set of points that all weigh one, which compile down to
+ *         the unweighted kernels
+ */
+struct Unweighted {
+  double operator[](size_t) const { return 1; }
+};
+
+/**
+ * @brief  Weighted Center::cost, over either an array of weights or
+ *         Unweighted
+ */
+template <typename Weights>
+double weightedCost(double       x,
+                    double       y,
+                    const double points[][2],
+                    Weights      weights,
+                    size_t       numPoints)
+{
+  double cost = 0;
+
+  for (size_t i = 0; i < numPoints; ++i) {
+    cost += weights[i] * std::sqrt(std::pow((points[i][0] - x), 2) +
+                                   std::pow((points[i][1] - y), 2));
+  }
+  return cost;
+}
+
+/**
+ * @brief   Weighted Center::cost over single-precision points
+ * @details Measures distances in single precision, LANES at a time so that
+ *          the loop vectorizes at twice the width of doubles, and sums them
+ *          in double precision, one running sum per lane. The center is
+ *          rounded to single precision too, so that differences stay small
+ *          and exact near it.
+ */
+template <typename Weights>
+double weightedCost(double      x,
+                    double      y,
+                    const float points[][2],
+                    Weights     weights,
+                    size_t      numPoints)
+{
+  const size_t LANES = 8;
+  const float  cx    = (float)x;
+  const float  cy    = (float)y;
+
+  double sums[LANES] = {0};
+  size_t i           = 0;
+  for (; i + LANES <= numPoints; i += LANES) {
+    float distances[LANES];
+    for (size_t j = 0; j < LANES; ++j) {
+      const float dx = points[i + j][0] - cx;
+      const float dy = points[i + j][1] - cy;
+      distances[j]   = std::sqrt(dx * dx + dy * dy);
+    }
+    for (size_t j = 0; j < LANES; ++j) {
+      sums[j] += weights[i + j] * distances[j];
+    }
+  }
+
+  double cost = 0;
+  for (; i < numPoints; ++i) {
+    const float dx = points[i][0] - cx;
+    const float dy = points[i][1] - cy;
+    cost += weights[i] * std::sqrt(dx * dx + dy * dy);
+  }
+  for (size_t j = 0; j < LANES; ++j) {
+    cost += sums[j];
+  }
+  return cost;
+}
+
+/**
+ * @struct
+ * @brief  Net cost of travelling from a set of weighted points to a center,
+ *         over points of either precision
+ */
+template <typename Coord, typename Weights>
+struct PointsCost {
+  const Coord (*points)[2];
+  Weights weights;
+  size_t  numPoints;
+
+  double operator()(double x, double y) const
+  {
+    return weightedCost(x, y, points, weights, numPoints);
+  }
+};
+
+/**
+ * @struct
+ * @brief  Net cost of travelling to a center, by a Center::CostFunction
+ */
+struct CallbackCost {
+  Center::CostFunction cost;
+  const void *         context;
+
+  double operator()(double x, double y) const { return cost(x, y, context); }
+};
+
+/**
+ * @brief  Runs the search of Center::geometricCenter over a cost function,
+ *         starting from the center in fill with a given step, or else with
+ *         the mean cost of the points scaled by options.bounds
+ */
+template <typename Cost>
+double descend(Cost                                   cost,
+               double                                 totalWeight,
+               double                                 step,
+               const Center::GeometricCenterOptions & options,
+               double                                 fill[2],
+               Center::GeometricCenterStats *         stats)
+{
+  const Clock::time_point      start  = Clock::now();
+  Center::GeometricCenterStats _stats = {0, 0, 0, 0, false};
+
+  // calculate initial score, and step if not given, from the starting center
+  double score = cost(fill[0], fill[1]);
+  if (!(step > 0)) {
+    step = score / totalWeight * options.bounds;
+  }
+  ++_stats.costEvaluations;
+
+  // descend gradient, searching for the function minimum, until the error
+  // reaches some acceptable epsilon or the budget is spent.
+  while (step > options.epsilon) {
+    if (options.maxIterations && _stats.iterations >= options.maxIterations) {
+      break;
+    }
+    if (options.maxMicros > 0 &&
+        std::chrono::duration<double, std::micro>(Clock::now() - start)
+                .count() >= options.maxMicros) {
+      break;
+    }
+    ++_stats.iterations;
+
+    bool improved = false;
+
+    // check points a step in each direction to find one of lower cost
+    for (size_t i = 0; i < 8; options.subsearch ? ++i : (i += 2)) {
+      const double _x     = fill[0] + step * Center::DELTA_X[i];
+      const double _y     = fill[1] + step * Center::DELTA_Y[i];
+      const double _score = cost(_x, _y);
+      ++_stats.costEvaluations;
+
+      if (_score < score) {
+        fill[0] = _x, fill[1] = _y;
+        score    = _score;
+        improved = true;
+        break;
+      }
+    }
+
+    if (!improved) {  // no improvement means error can be improved
+      step /= 2;
+      ++_stats.stepHalvings;
+    }
+  }
+
+  _stats.finalStep = step;
+  _stats.converged = !(step > options.epsilon);
+  if (stats) {
+    *stats = _stats;
+  }
+
+  return score;
+}
+
+/**
+ * @brief  Center::centerOfMass, over points of either precision
+ */
+template <typename Coord>
+void unweightedMass(const Coord points[][2], size_t numPoints, double fill[2])
+{
+  double center[2] = {0, 0};
+
+  for (size_t i = 0; i < numPoints; ++i) {
+    center[0] += points[i][0];
+    center[1] += points[i][1];
+  }
+
+  fill[0] = center[0] / numPoints;
+  fill[1] = center[1] / numPoints;
+}
+
+/**
+ * @struct
+ * @brief  Integer coordinates of a grid cell
+ */
+struct Cell {
+  long long x;
+  long long y;
+};
+
+/**
+ * @brief  Hashes a grid cell, mixing both coordinates by multiplication so
+ *         that neighboring cells spread across the table
+ */
+size_t hashCell(const Cell & cell)
+{
+  uint64_t h = (uint64_t)cell.x * 0x9E3779B97F4A7C15ULL ^
+               (uint64_t)cell.y * 0xC2B2AE3D27D4EB4FULL;
+  return (size_t)(h ^ h >> 32);
+}
+
+/**
+ * @struct
+ * @brief  Grid cells of planar points, of a given side
+ */
+struct PlanarCells {
+  const double (*points)[2];
+  double cellSize;
+
+  Cell operator()(size_t i) const
+  {
+    const Cell cell = {(long long)std::floor(points[i][0] / cellSize),
+                       (long long)std::floor(points[i][1] / cellSize)};
+    return cell;
+  }
+};
+
+/**
+ * @struct
+ * @brief  Grid cells of Latitude/Longitude points, of a given side in radians
+ */
+struct SphericalCells {
+  const double * lat;
+  const double * lng;
+  double         cellSize;
+
+  Cell operator()(size_t i) const
+  {
+    const Cell cell = {(long long)std::floor(lat[i] / cellSize),
+                       (long long)std::floor(lng[i] / cellSize)};
+    return cell;
+  }
+};
+
+/**
+ * @brief  Numbers the grid cells of a set of points in the order they are
+ *         first met
+ *
+ * @param  cellOf    grid cell of each point, as PlanarCells or SphericalCells
+ * @param  numPoints number of points
+ * @param  fill      array of numPoints to fill with the number of the cell of
+ *                   each point
+ *
+ * @return number of cells
+ */
+template <typename CellOf>
+size_t numberCells(CellOf cellOf, size_t numPoints, size_t fill[])
+{
+  Arena::Scope scratch;
+
+  // open-addressed table from cell to its number, at most half full
+  size_t capacity = 1;
+  while (capacity < 2 * numPoints) {
+    capacity <<= 1;
+  }
+  const size_t EMPTY = (size_t)-1;
+  Cell *       cells = scratch.alloc<Cell>(capacity);
+  size_t *     slots = scratch.alloc<size_t>(capacity);
+  std::fill(slots, slots + capacity, EMPTY);
+
+  size_t numCells = 0;
+  for (size_t i = 0; i < numPoints; ++i) {
+    const Cell cell = cellOf(i);
+
+    size_t h = hashCell(cell) & (capacity - 1);
+    while (slots[h] != EMPTY &&
+           (cells[h].x != cell.x || cells[h].y != cell.y)) {
+      h = (h + 1) & (capacity - 1);
+    }
+    if (slots[h] == EMPTY) {  // first point of its cell
+      cells[h] = cell;
+      slots[h] = numCells++;
+    }
+    fill[i] = slots[h];
+  }
+  return numCells;
+}
+
+/**
+ * @brief  Scales a vector to unit length
+ *
+ * @param  v vector to normalize
+ *
+ * @return length of the vector before scaling
+ */
+double normalize(double v[3])
+{
+  const double norm = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+  if (norm > 0) {
+    v[0] /= norm, v[1] /= norm, v[2] /= norm;
+  }
+  return norm;
+}
+
+/**
+ * @brief  Sums the angles, in radians, between a unit vector and a set of
+ *         unit vectors, each counted weight times
+ */
+template <typename Weights>
+double sumAngles(const double        c[3],
+                 const UnitVectors & u,
+                 Weights             weights,
+                 size_t              numPoints)
+{
+  double sum = 0;
+
+  for (size_t i = 0; i < numPoints; ++i) {
+    const double cx  = c[1] * u.z[i] - c[2] * u.y[i];
+    const double cy  = c[2] * u.x[i] - c[0] * u.z[i];
+    const double cz  = c[0] * u.y[i] - c[1] * u.x[i];
+    const double dot = c[0] * u.x[i] + c[1] * u.y[i] + c[2] * u.z[i];
+    const double sin = std::sqrt(cx * cx + cy * cy + cz * cz);
+    sum += weights[i] * std::atan2(sin, dot);
+  }
+  return sum;
+}
+
+/**
+ * @brief  Converts Latitude/Longitude points to unit vectors in scratch memory
+ *
+ * @param  points    Latitude/Longitude points, in degrees
+ * @param  numPoints number of points
+ * @param  scratch   scope to allocate the vectors in
+ */
+UnitVectors toUnitVectors(const double   points[][2],
+                          size_t         numPoints,
+                          Arena::Scope & scratch)
+{
+  double * x = scratch.alloc<double>(numPoints);
+  double * y = scratch.alloc<double>(numPoints);
+  double * z = scratch.alloc<double>(numPoints);
+  for (size_t i = 0; i < numPoints; ++i) {
+    double v[3];
+    Geo::unitVector(points[i], v);
+    x[i] = v[0], y[i] = v[1], z[i] = v[2];
+  }
+  const UnitVectors u = {x, y, z};
+  return u;
+}
+
+/**
+ * @brief  Returns the points of a store as unit vectors
+ */
+UnitVectors toUnitVectors(const Geo::PointStore & store)
+{
+  const UnitVectors u = {store.x(), store.y(), store.z()};
+  return u;
+}
+
+/**
+ * @brief   Returns whether a point of a set is their geometric center
+ * @details It is if the net pull of the other points, each a unit tangent
+ *          vector toward the point scaled by its weight, is no greater than
+ *          the weight of the points on it.
+ *
+ * @param   p         unit vector of the point to test
+ * @param   u         unit vectors of the set
+ * @param   weights   weight of each point of the set
+ * @param   numPoints number of points in the set
+ */
+template <typename Weights>
+bool isMedian(const double        p[3],
+              const UnitVectors & u,
+              Weights             weights,
+              size_t              numPoints)
+{
+  double tx = 0, ty = 0, tz = 0, coincident = 0;
+
+  for (size_t i = 0; i < numPoints; ++i) {
+    const double cx  = p[1] * u.z[i] - p[2] * u.y[i];
+    const double cy  = p[2] * u.x[i] - p[0] * u.z[i];
+    const double cz  = p[0] * u.y[i] - p[1] * u.x[i];
+    const double dot = p[0] * u.x[i] + p[1] * u.y[i] + p[2] * u.z[i];
+    const double sin = std::sqrt(cx * cx + cy * cy + cz * cz);
+    const bool   far = sin > Center::COINCIDENT;
+    const double w   = far ? weights[i] / sin : 0;
+    tx += w * (u.x[i] - dot * p[0]);
+    ty += w * (u.y[i] - dot * p[1]);
+    tz += w * (u.z[i] - dot * p[2]);
+    coincident += far ? 0 : weights[i];
+  }
+  return std::sqrt(tx * tx + ty * ty + tz * tz) <= coincident;
+}
+
+/**
+ * @brief  Sums an array of values
+ */
+double sum(const double values[], size_t numValues)
+{
+  double total = 0;
+  for (size_t i = 0; i < numValues; ++i) {
+    total += values[i];
+  }
+  return total;
+}
+
+/**
+ * @brief  Sums the great-circle distances, in kilometers, from a set of unit
+ *         vectors to a Latitude/Longitude point
+ */
+double sumDistances(const double        point[2],
+                    const UnitVectors & u,
+                    size_t              numPoints)
+{
+  double c[3];
+  Geo::unitVector(point, c);
+  return sumAngles(c, u, Unweighted(), numPoints) *
+         Cartesian::EARTH_RADIUS_METERS *
+         Cartesian::METER_TO_KM;
+}
+
+/**
+ * @brief  Runs Center::sphericalCenter over weighted unit vectors, counting
+ *         the time budget from a start time
+ */
+template <typename Weights>
+double searchSphere(const UnitVectors &                    u,
+                    Weights                                weights,
+                    size_t                                 numPoints,
+                    const Center::GeometricCenterOptions & options,
+                    Clock::time_point                      start,
+                    double                                 fill[2],
+                    Center::GeometricCenterStats *         stats)
+{
+  Center::GeometricCenterStats _stats  = {0, 0, 0, 0, false};
+  const double                 DEGREES = 180 / Cartesian::PI;
+
+  if (numPoints == 0) {
+    fill[0] = fill[1] = 0;
+    if (stats) {
+      *stats = _stats;
+    }
+    return 0;
+  }
+
+  double c[3] = {0, 0, 0};
+  for (size_t i = 0; i < numPoints; ++i) {
+    c[0] += weights[i] * u.x[i];
+    c[1] += weights[i] * u.y[i];
+    c[2] += weights[i] * u.z[i];
+  }
+
+  // start from the normalized centroid, or any point if it is degenerate
+  if (normalize(c) < Center::COINCIDENT) {
+    c[0] = u.x[0], c[1] = u.y[0], c[2] = u.z[0];
+  }
+
+  double step = 0;
+  for (;;) {
+    if (options.maxIterations && _stats.iterations >= options.maxIterations) {
+      break;
+    }
+    if (options.maxMicros > 0 &&
+        std::chrono::duration<double, std::micro>(Clock::now() - start)
+                .count() >= options.maxMicros) {
+      break;
+    }
+    ++_stats.iterations;
+    ++_stats.costEvaluations;
+
+    // weigh each point by its weight over the sin of its angle from the
+    // center, which is the length of their cross product; points on the
+    // center weigh nothing and are counted instead
+    double sx = 0, sy = 0, sz = 0, dots = 0, coincident = 0;
+    for (size_t i = 0; i < numPoints; ++i) {
+      const double cx  = c[1] * u.z[i] - c[2] * u.y[i];
+      const double cy  = c[2] * u.x[i] - c[0] * u.z[i];
+      const double cz  = c[0] * u.y[i] - c[1] * u.x[i];
+      const double dot = c[0] * u.x[i] + c[1] * u.y[i] + c[2] * u.z[i];
+      const double sin = std::sqrt(cx * cx + cy * cy + cz * cz);
+      const bool   far = sin > Center::COINCIDENT;
+      const double w   = far ? weights[i] / sin : 0;
+      sx += w * u.x[i];
+      sy += w * u.y[i];
+      sz += w * u.z[i];
+      dots += w * dot;
+      coincident += far ? 0 : weights[i];
+    }
+
+    double next[3] = {sx, sy, sz};
+    if (normalize(next) == 0) {
+      _stats.converged = true;
+      break;
+    }
+
+    if (coincident > 0) {
+      // the center sits on a point, and is the median unless the pull of the
+      // other points (their weighted sum, less its component along the
+      // center) outweighs the points under it
+      const double tangent[3] = {sx - dots * c[0], sy - dots * c[1],
+                                 sz - dots * c[2]};
+      const double pull =
+          std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] +
+                    tangent[2] * tangent[2]);
+      if (pull <= coincident) {
+        step             = 0;
+        _stats.converged = true;
+        break;
+      }
+      const double stay = coincident / pull;
+      for (size_t d = 0; d < 3; ++d) {
+        next[d] = (1 - stay) * next[d] + stay * c[d];
+      }
+      normalize(next);
+    }
+
+    // the chord between centers is within a part in 1e8 of their angle at
+    // the steps that matter
+    const double dx = next[0] - c[0], dy = next[1] - c[1], dz = next[2] - c[2];
+    step = std::sqrt(dx * dx + dy * dy + dz * dz) * DEGREES;
+    c[0] = next[0], c[1] = next[1], c[2] = next[2];
+
+    if (!(step > options.epsilon)) {
+      _stats.converged = true;
+      break;
+    }
+  }
+
+  // the iteration only creeps toward a median that lies on a point, so check
+  // whether the point it is creeping toward is the median
+  size_t closest = 0;
+  for (size_t i = 1; i < numPoints; ++i) {
+    if (c[0] * u.x[i] + c[1] * u.y[i] + c[2] * u.z[i] >
+        c[0] * u.x[closest] + c[1] * u.y[closest] + c[2] * u.z[closest]) {
+      closest = i;
+    }
+  }
+  const double point[3] = {u.x[closest], u.y[closest], u.z[closest]};
+  if (isMedian(point, u, weights, numPoints)) {
+    c[0] = point[0], c[1] = point[1], c[2] = point[2];
+    _stats.converged = true;
+  }
+
+  Geo::fromUnitVector(c, fill);
+
+  const double score = sumAngles(c, u, weights, numPoints) *
+                       Cartesian::EARTH_RADIUS_METERS * Cartesian::METER_TO_KM;
+  ++_stats.costEvaluations;
+
+  _stats.finalStep = step;
+  if (stats) {
+    *stats = _stats;
+  }
+
+  return score;
+}
+}  // namespace
+
 /**
  * @brief   Calculates the net cost of travelling from a set of points to their
  *          center
@@ -29,13 +607,54 @@ double Center::cost(double       x,
                     const double points[][2],
                     size_t       numPoints)
 {
-  double cost = 0;
+  return weightedCost(x, y, points, Unweighted(), numPoints);
+}
 
-  for (size_t i = 0; i < numPoints; ++i) {
-    cost += std::sqrt(std::pow((points[i][0] - x), 2) +
-                      std::pow((points[i][1] - y), 2));
-  }
-  return cost;
+/**
+ * @brief   Calculates the net cost of travelling from a set of weighted points
+ *          to their center
+ * @details Uses Pythagorean distance for cost measurement, with each point's
+ *          distance counted weight times
+ *
+ * @param   x         center x coordinate
+ * @param   y         center y coordinate
+ * @param   points    points to measure distance from
+ * @param   weights   weight of each point
+ * @param   numPoints number of points
+ *
+ * @return  net cost of travelling to the center
+ */
+double Center::cost(double       x,
+                    double       y,
+                    const double points[][2],
+                    const double weights[],
+                    size_t       numPoints)
+{
+  return weightedCost(x, y, points, weights, numPoints);
+}
+
+/**
+ * @brief   Calculates the net cost of travelling from a set of
+ *          single-precision points to their center
+ * @details As cost, measuring each distance in single precision at twice the
+ *          vector width and summing in double precision. Each distance is
+ *          within a part in 1e7 of its double-precision value, relative to
+ *          the coordinates, and rounding in the sum stays as small as in
+ *          double precision.
+ *
+ * @param   x         center x coordinate
+ * @param   y         center y coordinate
+ * @param   points    points to measure distance from
+ * @param   numPoints number of points
+ *
+ * @return  net cost of travelling to the center
+ */
+double Center::cost(double      x,
+                    double      y,
+                    const float points[][2],
+                    size_t      numPoints)
+{
+  return weightedCost(x, y, points, Unweighted(), numPoints);
 }
 
 /**
@@ -64,6 +683,65 @@ double Center::manhattanCost(double       x,
   return cost;
 }
 
+/**
+ * @brief   Calculates the net great-circle distance from a set of
+ *          Latitude/Longitude points to a center
+ *
+ * @param   lat       center latitude, in degrees
+ * @param   lng       center longitude, in degrees
+ * @param   points    Latitude/Longitude points, in degrees
+ * @param   numPoints number of points
+ * @param   mode      formula to measure distance with
+ *
+ * @return  net distance to the center, in kilometers
+ */
+double Center::sphericalCost(double                  lat,
+                             double                  lng,
+                             const double            points[][2],
+                             size_t                  numPoints,
+                             Cartesian::DistanceMode mode)
+{
+  Arena::Scope scratch;
+  const double point[2] = {lat, lng};
+
+  if (mode != Cartesian::exact) {
+    double * distances = scratch.alloc<double>(numPoints);
+    Cartesian::fillDistances(points, numPoints, point, 'm', distances, mode);
+    return sum(distances, numPoints);
+  }
+
+  const UnitVectors u = toUnitVectors(points, numPoints, scratch);
+  return sumDistances(point, u, numPoints);
+}
+
+/**
+ * @brief   Calculates the net great-circle distance from the points of a store
+ *          to a center
+ *
+ * @param   lat   center latitude, in degrees
+ * @param   lng   center longitude, in degrees
+ * @param   store points to measure distance from
+ * @param   mode  formula to measure distance with
+ *
+ * @return  net distance to the center, in kilometers
+ */
+double Center::sphericalCost(double                  lat,
+                             double                  lng,
+                             const Geo::PointStore & store,
+                             Cartesian::DistanceMode mode)
+{
+  const double point[2] = {lat, lng};
+
+  if (mode != Cartesian::exact) {
+    Arena::Scope scratch;
+    double *     distances = scratch.alloc<double>(store.size());
+    Geo::fillDistances(store, point, 'm', distances, mode);
+    return sum(distances, store.size());
+  }
+
+  return sumDistances(point, toUnitVectors(store), store.size());
+}
+
 /**
  * @brief   Finds the center of a set of points
  * @details Assumes all points have equal weight. Puts the center of mass in a
@@ -77,15 +755,48 @@ void Center::centerOfMass(const double points[][2],
                           size_t       numPoints,
                           double       fill[2])
 {
-  double center[2] = {0, 0};
+  unweightedMass(points, numPoints, fill);
+}
+
+/**
+ * @brief   Finds the center of a set of single-precision points
+ * @details As centerOfMass, summing in double precision.
+ *
+ * @param   points    points to measure
+ * @param   numPoints number of points
+ * @param   fill      array to fill with center of mass
+ */
+void Center::centerOfMass(const float points[][2],
+                          size_t      numPoints,
+                          double      fill[2])
+{
+  unweightedMass(points, numPoints, fill);
+}
+
+/**
+ * @brief   Finds the center of a set of weighted points
+ * @details Puts the center of mass in a user-designated array.
+ *
+ * @param   points    points to measure
+ * @param   weights   weight of each point
+ * @param   numPoints number of points
+ * @param   fill      array to fill with center of mass
+ */
+void Center::centerOfMass(const double points[][2],
+                          const double weights[],
+                          size_t       numPoints,
+                          double       fill[2])
+{
+  double center[2] = {0, 0}, totalWeight = 0;
 
   for (size_t i = 0; i < numPoints; ++i) {
-    center[0] += points[i][0];
-    center[1] += points[i][1];
+    center[0] += weights[i] * points[i][0];
+    center[1] += weights[i] * points[i][1];
+    totalWeight += weights[i];
   }
 
-  fill[0] = center[0] / numPoints;
-  fill[1] = center[1] / numPoints;
+  fill[0] = center[0] / totalWeight;
+  fill[1] = center[1] / totalWeight;
 }
 
 /**
@@ -95,52 +806,336 @@ void Center::centerOfMass(const double points[][2],
  *          center.
  *          The algorithm is a simple Newtonian search. We iterate an
  *          indiscriminate amount of times through smaller bounds until we
- *          approve some margin of error. Note that local maxima are a
- *          non-issue, as the geometric median is (unique and covergent for
- *          non-co-linear
+ *          approve some margin of error, or an iteration or time budget runs
+ *          out. Note that local maxima are a non-issue, as the geometric
+ *          median is (unique and covergent for non-co-linear
  *          points)[http://www.stat.rutgers.edu/home/cunhui/papers/39.pdf].
  *
  * @param   points    points to find the center of
  * @param   numPoints number of points
- * @param   options   specified margin of error, bound range, and subsearch
- *                    value
+ * @param   options   specified margin of error, bound range, subsearch value
+ *                    and budgets
  * @param   fill      array to fill with geometric center
+ * @param   stats     optional telemetry to fill about the search
  *
  * @return  geometric center of a set of points
  */
 double Center::geometricCenter(const double                   points[][2],
                                size_t                         numPoints,
                                const GeometricCenterOptions & options,
-                               double                         fill[2])
+                               double                         fill[2],
+                               GeometricCenterStats *         stats)
 {
-  // fill center to CoM, calculate initial score and step
+  const PointsCost<double, Unweighted> cost = {points, Unweighted(), numPoints};
+
   centerOfMass(points, numPoints, fill);
-  double score = cost(fill[0], fill[1], points, numPoints);
-  double step  = score / numPoints * options.bounds;
+  return descend(cost, numPoints, 0, options, fill, stats);
+}
 
-  // descend gradient, searching for the function minimum, until the error
-  // reaches some acceptable epsilon.
-  while (step > options.epsilon) {
-    bool improved = false;
+/**
+ * @brief   Finds the geometric center of a set of single-precision points
+ * @details As geometricCenter, with every cost measured by the
+ *          single-precision cost. Below a step of about 1e-7 of the
+ *          coordinates the costs of neighboring centers are no longer told
+ *          apart, so the center is only found to that precision whatever
+ *          the epsilon.
+ *
+ * @param   points    points to find the center of
+ * @param   numPoints number of points
+ * @param   options   specified margin of error, bound range, subsearch value
+ *                    and budgets
+ * @param   fill      array to fill with geometric center
+ * @param   stats     optional telemetry to fill about the search
+ *
+ * @return  net cost of travelling to the geometric center
+ */
+double Center::geometricCenter(const float                    points[][2],
+                               size_t                         numPoints,
+                               const GeometricCenterOptions & options,
+                               double                         fill[2],
+                               GeometricCenterStats *         stats)
+{
+  const PointsCost<float, Unweighted> cost = {points, Unweighted(), numPoints};
 
-    // check points a step in each direction to find one of lower cost
-    for (size_t i = 0; i < 8; options.subsearch ? ++i : (i += 2)) {
-      const double _x     = fill[0] + step * DELTA_X[i];
-      const double _y     = fill[1] + step * DELTA_Y[i];
-      const double _score = cost(_x, _y, points, numPoints);
+  centerOfMass(points, numPoints, fill);
+  return descend(cost, numPoints, 0, options, fill, stats);
+}
 
-      if (_score < score) {
-        fill[0] = _x, fill[1] = _y;
-        score    = _score;
-        improved = true;
-        break;
-      }
-    }
+/**
+ * @brief   Refines a known estimate of the geometric center of a set of points
+ * @details As geometricCenter, but starts from the center in fill with a
+ *          given step rather than from the center of mass with a step scaled
+ *          by options.bounds, so that a center that has only drifted a little
+ *          converges in a few iterations.
+ *
+ * @param   points    points to find the center of
+ * @param   numPoints number of points
+ * @param   options   specified margin of error, subsearch value and budgets
+ * @param   step      step to start the search with; about the distance the
+ *                    center may have drifted
+ * @param   fill      array holding the center to start from, to fill with
+ *                    the geometric center
+ * @param   stats     optional telemetry to fill about the search
+ *
+ * @return  net cost of travelling to the geometric center
+ */
+double Center::refineCenter(const double                   points[][2],
+                            size_t                         numPoints,
+                            const GeometricCenterOptions & options,
+                            double                         step,
+                            double                         fill[2],
+                            GeometricCenterStats *         stats)
+{
+  const PointsCost<double, Unweighted> cost = {points, Unweighted(), numPoints};
 
-    if (!improved) {  // no improvement means error can be improved
-      step /= 2;
-    }
+  return descend(cost, numPoints, step, options, fill, stats);
+}
+
+/**
+ * @brief   Finds the geometric center of a set of weighted points
+ * @details As geometricCenter, minimizing the net cost with each point's
+ *          distance counted weight times, and starting from the weighted
+ *          center of mass.
+ *
+ * @param   points    points to find the center of
+ * @param   weights   weight of each point
+ * @param   numPoints number of points
+ * @param   options   specified margin of error, bound range, subsearch value
+ *                    and budgets
+ * @param   fill      array to fill with geometric center
+ * @param   stats     optional telemetry to fill about the search
+ *
+ * @return  net weighted cost of travelling to the geometric center
+ */
+double Center::geometricCenter(const double                   points[][2],
+                               const double                   weights[],
+                               size_t                         numPoints,
+                               const GeometricCenterOptions & options,
+                               double                         fill[2],
+                               GeometricCenterStats *         stats)
+{
+  double totalWeight = 0;
+  for (size_t i = 0; i < numPoints; ++i) {
+    totalWeight += weights[i];
   }
 
-  return score;
+  const PointsCost<double, const double *> cost = {points, weights, numPoints};
+
+  centerOfMass(points, weights, numPoints, fill);
+  return descend(cost, totalWeight, 0, options, fill, stats);
+}
+
+/**
+ * @brief   Finds the geometric center of a set of points known only through
+ *          their cost function
+ * @details As geometricCenter, for points that are not held in memory, such as
+ *          points streamed from a file. The search starts from the center in
+ *          fill, which should be the center of mass of the points.
+ *
+ * @param   cost        net cost of travelling from the points to a center
+ * @param   context     context to pass to the cost function
+ * @param   totalWeight total weight (or number) of the points
+ * @param   options     specified margin of error, bound range, subsearch
+ *                      value and budgets
+ * @param   fill        array holding the center to start from, to fill with
+ *                      the geometric center
+ * @param   stats       optional telemetry to fill about the search
+ *
+ * @return  net cost of travelling to the geometric center
+ */
+double Center::geometricCenter(CostFunction                   cost,
+                               const void *                   context,
+                               double                         totalWeight,
+                               const GeometricCenterOptions & options,
+                               double                         fill[2],
+                               GeometricCenterStats *         stats)
+{
+  const CallbackCost _cost = {cost, context};
+  return descend(_cost, totalWeight, 0, options, fill, stats);
+}
+
+/**
+ * @brief   Merges points that share a grid cell into weighted representatives
+ * @details Snaps each point to a square cell of the grid with the given cell
+ *          size, and replaces the points of each cell by their center of
+ *          mass, weighted by their number. Representatives come out in the
+ *          order their cells are first met.
+ *          Every point lies within cellSize·√2 of its representative, so for
+ *          any center the weighted cost of the representatives is within
+ *          numPoints·cellSize·√2 of the cost of the points, and the geometric
+ *          center of the representatives costs at most twice that more than
+ *          the geometric center of the points. The center of mass is
+ *          unchanged.
+ *
+ * @param   points      points to merge
+ * @param   numPoints   number of points
+ * @param   cellSize    side of a grid cell, in the units of the points
+ * @param   fillPoints  array of numPoints to fill with representatives
+ * @param   fillWeights array of numPoints to fill with their weights
+ *
+ * @return  number of representatives
+ */
+size_t Center::aggregate(const double points[][2],
+                         size_t       numPoints,
+                         double       cellSize,
+                         double       fillPoints[][2],
+                         double       fillWeights[])
+{
+  Arena::Scope      scratch;
+  size_t *          cellOf   = scratch.alloc<size_t>(numPoints);
+  const PlanarCells cells    = {points, cellSize};
+  const size_t      numCells = numberCells(cells, numPoints, cellOf);
+
+  std::fill(fillWeights, fillWeights + numCells, 0);
+  for (size_t c = 0; c < numCells; ++c) {
+    fillPoints[c][0] = fillPoints[c][1] = 0;
+  }
+  for (size_t i = 0; i < numPoints; ++i) {
+    fillPoints[cellOf[i]][0] += points[i][0];
+    fillPoints[cellOf[i]][1] += points[i][1];
+    ++fillWeights[cellOf[i]];
+  }
+
+  for (size_t c = 0; c < numCells; ++c) {
+    fillPoints[c][0] /= fillWeights[c];
+    fillPoints[c][1] /= fillWeights[c];
+  }
+  return numCells;
+}
+
+/**
+ * @brief   Finds the geometric center of a set of Latitude/Longitude points on
+ *          the earth's surface
+ * @details Minimizes the net great-circle distance to the points, rather than
+ *          the planar distance in degrees that geometricCenter minimizes,
+ *          which drifts at high latitudes and over large areas.
+ *          The algorithm is Weiszfeld's iteration carried over to the sphere.
+ *          Points are converted to unit vectors once; each iteration then
+ *          moves the center to the normalized sum of the points weighted by
+ *          1 / sin of their angle from it, which takes only products, square
+ *          roots and divisions. A center that lands on a point is handled as
+ *          by Vardi and Zhang, so the iteration cannot stall there. The
+ *          search stops once the center moves less than epsilon degrees, or
+ *          an iteration or time budget runs out; bounds and subsearch are
+ *          ignored.
+ *
+ * @param   points    Latitude/Longitude points, in degrees
+ * @param   numPoints number of points
+ * @param   options   specified margin of error, in degrees, and budgets
+ * @param   fill      array to fill with the geometric center, in degrees
+ * @param   stats     optional telemetry to fill about the search
+ *
+ * @return  net distance to the geometric center, in kilometers
+ */
+double Center::sphericalCenter(const double                   points[][2],
+                               size_t                         numPoints,
+                               const GeometricCenterOptions & options,
+                               double                         fill[2],
+                               GeometricCenterStats *         stats)
+{
+  const Clock::time_point start = Clock::now();
+  Arena::Scope            scratch;
+  const UnitVectors       u = toUnitVectors(points, numPoints, scratch);
+  return searchSphere(u, Unweighted(), numPoints, options, start, fill, stats);
+}
+
+/**
+ * @brief   Finds the geometric center of the points of a store on the earth's
+ *          surface
+ * @details As sphericalCenter over Latitude/Longitude points, but starts from
+ *          the unit vectors cached in the store.
+ *
+ * @param   store   points to find the center of
+ * @param   options specified margin of error, in degrees, and budgets
+ * @param   fill    array to fill with the geometric center, in degrees
+ * @param   stats   optional telemetry to fill about the search
+ *
+ * @return  net distance to the geometric center, in kilometers
+ */
+double Center::sphericalCenter(const Geo::PointStore &        store,
+                               const GeometricCenterOptions & options,
+                               double                         fill[2],
+                               GeometricCenterStats *         stats)
+{
+  return searchSphere(toUnitVectors(store), Unweighted(), store.size(), options,
+                      Clock::now(), fill, stats);
+}
+
+/**
+ * @brief   Finds the geometric center of the weighted points of a store on the
+ *          earth's surface
+ * @details As sphericalCenter over a store, minimizing the net great-circle
+ *          distance with each point's distance counted weight times, and
+ *          starting from the normalized weighted sum of the points.
+ *
+ * @param   store   points to find the center of
+ * @param   weights weight of each point, by slot
+ * @param   options specified margin of error, in degrees, and budgets
+ * @param   fill    array to fill with the geometric center, in degrees
+ * @param   stats   optional telemetry to fill about the search
+ *
+ * @return  net weighted distance to the geometric center, in kilometers
+ */
+double Center::sphericalCenter(const Geo::PointStore &        store,
+                               const double                   weights[],
+                               const GeometricCenterOptions & options,
+                               double                         fill[2],
+                               GeometricCenterStats *         stats)
+{
+  return searchSphere(toUnitVectors(store), weights, store.size(), options,
+                      Clock::now(), fill, stats);
+}
+
+/**
+ * @brief   Merges the points of a store that share a grid cell into weighted
+ *          representatives
+ * @details As aggregate, over cells of cellSize degrees of latitude by
+ *          cellSize degrees of longitude. The representative of a cell is the
+ *          normalized sum of the unit vectors of its points, so only the
+ *          representatives take any trigonometry. Every point lies within
+ *          cellSize·√2 degrees of arc (cellSize·157 km) of its
+ *          representative, and the bounds of aggregate hold for great-circle
+ *          distances with that radius.
+ *
+ * @param   store       points to merge
+ * @param   cellSize    side of a grid cell, in degrees
+ * @param   fillPoints  array of store.size() to fill with Latitude/Longitude
+ *                      representatives, in degrees
+ * @param   fillWeights array of store.size() to fill with their weights
+ *
+ * @return  number of representatives
+ */
+size_t Center::aggregate(const Geo::PointStore & store,
+                         double                  cellSize,
+                         double                  fillPoints[][2],
+                         double                  fillWeights[])
+{
+  const size_t   numPoints = store.size();
+  const double * x         = store.x();
+  const double * y         = store.y();
+  const double * z         = store.z();
+
+  Arena::Scope         scratch;
+  size_t *             cellOf   = scratch.alloc<size_t>(numPoints);
+  const SphericalCells cells    = {store.lat(), store.lng(),
+                                   Cartesian::radiansFromDeg(cellSize)};
+  const size_t         numCells = numberCells(cells, numPoints, cellOf);
+
+  double(*sums)[3] = scratch.alloc<double[3]>(numCells);
+  for (size_t c = 0; c < numCells; ++c) {
+    sums[c][0] = sums[c][1] = sums[c][2] = 0;
+  }
+  std::fill(fillWeights, fillWeights + numCells, 0);
+  for (size_t i = 0; i < numPoints; ++i) {
+    sums[cellOf[i]][0] += x[i];
+    sums[cellOf[i]][1] += y[i];
+    sums[cellOf[i]][2] += z[i];
+    ++fillWeights[cellOf[i]];
+  }
+
+  for (size_t c = 0; c < numCells; ++c) {
+    normalize(sums[c]);
+    Geo::fromUnitVector(sums[c], fillPoints[c]);
+  }
+  return numCells;
 }
@@ -1,6 +1,7 @@
 #ifndef CENTER_H
 #define CENTER_H
 
+#include "geo.h"
 #include <stddef.h>
 
 namespace Center
@@ -8,21 +9,57 @@ namespace Center
 extern const double S2;
 extern const double DELTA_X[];
 extern const double DELTA_Y[];
+extern const double COINCIDENT;
 
 /**
  * @struct
  * @brief  Options for how the geometric center should be calculated
  *
- * @prop   epsilon   acceptable margin of error
- * @prop   bounds    a multiplier of the range of points to search
- * @prop   subsearch whether to search obliquely
+ * @prop   epsilon       acceptable margin of error
+ * @prop   bounds        a multiplier of the range of points to search
+ * @prop   subsearch     whether to search obliquely
+ * @prop   maxIterations most search iterations to perform, or 0 for no limit
+ * @prop   maxMicros     most microseconds to search for, or 0 for no limit
  */
 struct GeometricCenterOptions {
   const double epsilon;
   const double bounds;
   const bool   subsearch;
+  const size_t maxIterations;
+  const double maxMicros;
 };
 
+/**
+ * @struct
+ * @brief  Telemetry of how hard a geometric center search worked
+ *
+ * @prop   iterations      number of search iterations performed
+ * @prop   costEvaluations number of times the cost function was evaluated
+ * @prop   stepHalvings    number of times the step was halved
+ * @prop   finalStep       step size when the search stopped
+ * @prop   converged       whether the step reached epsilon before a budget ran
+ *                         out
+ */
+struct GeometricCenterStats {
+  size_t iterations;
+  size_t costEvaluations;
+  size_t stepHalvings;
+  double finalStep;
+  bool   converged;
+};
+
+/**
+ * @brief  Measures the net cost of travelling from a set of points to a
+ *         center, for points that are not held in memory
+ *
+ * @param  x       center x coordinate
+ * @param  y       center y coordinate
+ * @param  context points to measure distance from, however they are held
+ *
+ * @return net cost of travelling to the center
+ */
+typedef double (*CostFunction)(double x, double y, const void * context);
+
 /**
  * @brief   Calculates the net cost of travelling from a set of points to their
  *          center
@@ -37,6 +74,44 @@ struct GeometricCenterOptions {
  */
 double cost(double x, double y, const double points[][2], size_t numPoints);
 
+/**
+ * @brief   Calculates the net cost of travelling from a set of weighted points
+ *          to their center
+ * @details Uses Pythagorean distance for cost measurement, with each point's
+ *          distance counted weight times
+ *
+ * @param   x         center x coordinate
+ * @param   y         center y coordinate
+ * @param   points    points to measure distance from
+ * @param   weights   weight of each point
+ * @param   numPoints number of points
+ *
+ * @return  net cost of travelling to the center
+ */
+double cost(double       x,
+            double       y,
+            const double points[][2],
+            const double weights[],
+            size_t       numPoints);
+
+/**
+ * @brief   Calculates the net cost of travelling from a set of
+ *          single-precision points to their center
+ * @details As cost, measuring each distance in single precision at twice the
+ *          vector width and summing in double precision. Each distance is
+ *          within a part in 1e7 of its double-precision value, relative to
+ *          the coordinates, and rounding in the sum stays as small as in
+ *          double precision.
+ *
+ * @param   x         center x coordinate
+ * @param   y         center y coordinate
+ * @param   points    points to measure distance from
+ * @param   numPoints number of points
+ *
+ * @return  net cost of travelling to the center
+ */
+double cost(double x, double y, const float points[][2], size_t numPoints);
+
 /**
  * @brief   Calculates the net cost of travelling from a set of points to their
  *          center
@@ -55,6 +130,40 @@ double manhattanCost(double       x,
                      const double points[][2],
                      size_t       numPoints);
 
+/**
+ * @brief   Calculates the net great-circle distance from a set of
+ *          Latitude/Longitude points to a center
+ *
+ * @param   lat       center latitude, in degrees
+ * @param   lng       center longitude, in degrees
+ * @param   points    Latitude/Longitude points, in degrees
+ * @param   numPoints number of points
+ * @param   mode      formula to measure distance with
+ *
+ * @return  net distance to the center, in kilometers
+ */
+double sphericalCost(double                  lat,
+                     double                  lng,
+                     const double            points[][2],
+                     size_t                  numPoints,
+                     Cartesian::DistanceMode mode = Cartesian::exact);
+
+/**
+ * @brief   Calculates the net great-circle distance from the points of a store
+ *          to a center
+ *
+ * @param   lat   center latitude, in degrees
+ * @param   lng   center longitude, in degrees
+ * @param   store points to measure distance from
+ * @param   mode  formula to measure distance with
+ *
+ * @return  net distance to the center, in kilometers
+ */
+double sphericalCost(double                  lat,
+                     double                  lng,
+                     const Geo::PointStore & store,
+                     Cartesian::DistanceMode mode = Cartesian::exact);
+
 /**
  * @brief   Finds the center of a set of points
  * @details Assumes all points have equal weight. Puts the center of mass in a
@@ -66,6 +175,30 @@ double manhattanCost(double       x,
  */
 void centerOfMass(const double points[][2], size_t numPoints, double fill[2]);
 
+/**
+ * @brief   Finds the center of a set of single-precision points
+ * @details As centerOfMass, summing in double precision.
+ *
+ * @param   points    points to measure
+ * @param   numPoints number of points
+ * @param   fill      array to fill with center of mass
+ */
+void centerOfMass(const float points[][2], size_t numPoints, double fill[2]);
+
+/**
+ * @brief   Finds the center of a set of weighted points
+ * @details Puts the center of mass in a user-designated array.
+ *
+ * @param   points    points to measure
+ * @param   weights   weight of each point
+ * @param   numPoints number of points
+ * @param   fill      array to fill with center of mass
+ */
+void centerOfMass(const double points[][2],
+                  const double weights[],
+                  size_t       numPoints,
+                  double       fill[2]);
+
 /**
  * @brief   Finds the geometric center of a set of points.
  * @details Fills an array with the geometric center of an arbitrary amount of
@@ -73,23 +206,241 @@ void centerOfMass(const double points[][2], size_t numPoints, double fill[2]);
  *          center.
  *          The algorithm is a simple Newtonian search. We iterate an
  *          indiscriminate amount of times through smaller bounds until we
- *          approve some margin of error. Note that local maxima are a
- *          non-issue, as the geometric median is (unique and covergent for
- *          non-co-linear
+ *          approve some margin of error, or an iteration or time budget runs
+ *          out. Note that local maxima are a non-issue, as the geometric
+ *          median is (unique and covergent for non-co-linear
  *          points)[http://www.stat.rutgers.edu/home/cunhui/papers/39.pdf].
  *
  * @param   points    points to find the center of
  * @param   numPoints number of points
- * @param   options   specified margin of error, bound range, and subsearch
- *                    value
+ * @param   options   specified margin of error, bound range, subsearch value
+ *                    and budgets
  * @param   fill      array to fill with geometric center
+ * @param   stats     optional telemetry to fill about the search
  *
  * @return  geometric center of a set of points
  */
 double geometricCenter(const double                   points[][2],
                        size_t                         numPoints,
                        const GeometricCenterOptions & options,
-                       double                         fill[2]);
+                       double                         fill[2],
+                       GeometricCenterStats *         stats = NULL);
+
+/**
+ * @brief   Finds the geometric center of a set of single-precision points
+ * @details As geometricCenter, with every cost measured by the
+ *          single-precision cost. Below a step of about 1e-7 of the
+ *          coordinates the costs of neighboring centers are no longer told
+ *          apart, so the center is only found to that precision whatever
+ *          the epsilon.
+ *
+ * @param   points    points to find the center of
+ * @param   numPoints number of points
+ * @param   options   specified margin of error, bound range, subsearch value
+ *                    and budgets
+ * @param   fill      array to fill with geometric center
+ * @param   stats     optional telemetry to fill about the search
+ *
+ * @return  net cost of travelling to the geometric center
+ */
+double geometricCenter(const float                    points[][2],
+                       size_t                         numPoints,
+                       const GeometricCenterOptions & options,
+                       double                         fill[2],
+                       GeometricCenterStats *         stats = NULL);
+
+/**
+ * @brief   Refines a known estimate of the geometric center of a set of points
+ * @details As geometricCenter, but starts from the center in fill with a
+ *          given step rather than from the center of mass with a step scaled
+ *          by options.bounds, so that a center that has only drifted a little
+ *          converges in a few iterations.
+ *
+ * @param   points    points to find the center of
+ * @param   numPoints number of points
+ * @param   options   specified margin of error, subsearch value and budgets
+ * @param   step      step to start the search with; about the distance the
+ *                    center may have drifted
+ * @param   fill      array holding the center to start from, to fill with
+ *                    the geometric center
+ * @param   stats     optional telemetry to fill about the search
+ *
+ * @return  net cost of travelling to the geometric center
+ */
+double refineCenter(const double                   points[][2],
+                    size_t                         numPoints,
+                    const GeometricCenterOptions & options,
+                    double                         step,
+                    double                         fill[2],
+                    GeometricCenterStats *         stats = NULL);
+
+/**
+ * @brief   Finds the geometric center of a set of weighted points
+ * @details As geometricCenter, minimizing the net cost with each point's
+ *          distance counted weight times, and starting from the weighted
+ *          center of mass.
+ *
+ * @param   points    points to find the center of
+ * @param   weights   weight of each point
+ * @param   numPoints number of points
+ * @param   options   specified margin of error, bound range, subsearch value
+ *                    and budgets
+ * @param   fill      array to fill with geometric center
+ * @param   stats     optional telemetry to fill about the search
+ *
+ * @return  net weighted cost of travelling to the geometric center
+ */
+double geometricCenter(const double                   points[][2],
+                       const double                   weights[],
+                       size_t                         numPoints,
+                       const GeometricCenterOptions & options,
+                       double                         fill[2],
+                       GeometricCenterStats *         stats = NULL);
+
+/**
+ * @brief   Finds the geometric center of a set of points known only through
+ *          their cost function
+ * @details As geometricCenter, for points that are not held in memory, such as
+ *          points streamed from a file. The search starts from the center in
+ *          fill, which should be the center of mass of the points.
+ *
+ * @param   cost        net cost of travelling from the points to a center
+ * @param   context     context to pass to the cost function
+ * @param   totalWeight total weight (or number) of the points
+ * @param   options     specified margin of error, bound range, subsearch
+ *                      value and budgets
+ * @param   fill        array holding the center to start from, to fill with
+ *                      the geometric center
+ * @param   stats       optional telemetry to fill about the search
+ *
+ * @return  net cost of travelling to the geometric center
+ */
+double geometricCenter(CostFunction                   cost,
+                       const void *                   context,
+                       double                         totalWeight,
+                       const GeometricCenterOptions & options,
+                       double                         fill[2],
+                       GeometricCenterStats *         stats = NULL);
+
+/**
+ * @brief   Merges points that share a grid cell into weighted representatives
+ * @details Snaps each point to a square cell of the grid with the given cell
+ *          size, and replaces the points of each cell by their center of
+ *          mass, weighted by their number. Representatives come out in the
+ *          order their cells are first met.
+ *          Every point lies within cellSize·√2 of its representative, so for
+ *          any center the weighted cost of the representatives is within
+ *          numPoints·cellSize·√2 of the cost of the points, and the geometric
+ *          center of the representatives costs at most twice that more than
+ *          the geometric center of the points. The center of mass is
+ *          unchanged.
+ *
+ * @param   points      points to merge
+ * @param   numPoints   number of points
+ * @param   cellSize    side of a grid cell, in the units of the points
+ * @param   fillPoints  array of numPoints to fill with representatives
+ * @param   fillWeights array of numPoints to fill with their weights
+ *
+ * @return  number of representatives
+ */
+size_t aggregate(const double points[][2],
+                 size_t       numPoints,
+                 double       cellSize,
+                 double       fillPoints[][2],
+                 double       fillWeights[]);
+
+/**
+ * @brief   Finds the geometric center of a set of Latitude/Longitude points on
+ *          the earth's surface
+ * @details Minimizes the net great-circle distance to the points, rather than
+ *          the planar distance in degrees that geometricCenter minimizes,
+ *          which drifts at high latitudes and over large areas.
+ *          The algorithm is Weiszfeld's iteration carried over to the sphere.
+ *          Points are converted to unit vectors once; each iteration then
+ *          moves the center to the normalized sum of the points weighted by
+ *          1 / sin of their angle from it, which takes only products, square
+ *          roots and divisions. A center that lands on a point is handled as
+ *          by Vardi and Zhang, so the iteration cannot stall there. The
+ *          search stops once the center moves less than epsilon degrees, or
+ *          an iteration or time budget runs out; bounds and subsearch are
+ *          ignored.
+ *
+ * @param   points    Latitude/Longitude points, in degrees
+ * @param   numPoints number of points
+ * @param   options   specified margin of error, in degrees, and budgets
+ * @param   fill      array to fill with the geometric center, in degrees
+ * @param   stats     optional telemetry to fill about the search
+ *
+ * @return  net distance to the geometric center, in kilometers
+ */
+double sphericalCenter(const double                   points[][2],
+                       size_t                         numPoints,
+                       const GeometricCenterOptions & options,
+                       double                         fill[2],
+                       GeometricCenterStats *         stats = NULL);
+
+/**
+ * @brief   Finds the geometric center of the points of a store on the earth's
+ *          surface
+ * @details As sphericalCenter over Latitude/Longitude points, but starts from
+ *          the unit vectors cached in the store.
+ *
+ * @param   store   points to find the center of
+ * @param   options specified margin of error, in degrees, and budgets
+ * @param   fill    array to fill with the geometric center, in degrees
+ * @param   stats   optional telemetry to fill about the search
+ *
+ * @return  net distance to the geometric center, in kilometers
+ */
+double sphericalCenter(const Geo::PointStore &        store,
+                       const GeometricCenterOptions & options,
+                       double                         fill[2],
+                       GeometricCenterStats *         stats = NULL);
+
+/**
+ * @brief   Finds the geometric center of the weighted points of a store on the
+ *          earth's surface
+ * @details As sphericalCenter over a store, minimizing the net great-circle
+ *          distance with each point's distance counted weight times, and
+ *          starting from the normalized weighted sum of the points.
+ *
+ * @param   store   points to find the center of
+ * @param   weights weight of each point, by slot
+ * @param   options specified margin of error, in degrees, and budgets
+ * @param   fill    array to fill with the geometric center, in degrees
+ * @param   stats   optional telemetry to fill about the search
+ *
+ * @return  net weighted distance to the geometric center, in kilometers
+ */
+double sphericalCenter(const Geo::PointStore &        store,
+                       const double                   weights[],
+                       const GeometricCenterOptions & options,
+                       double                         fill[2],
+                       GeometricCenterStats *         stats = NULL);
+
+/**
+ * @brief   Merges the points of a store that share a grid cell into weighted
+ *          representatives
+ * @details As aggregate, over cells of cellSize degrees of latitude by
+ *          cellSize degrees of longitude. The representative of a cell is the
+ *          normalized sum of the unit vectors of its points, so only the
+ *          representatives take any trigonometry. Every point lies within
+ *          cellSize·√2 degrees of arc (cellSize·157 km) of its
+ *          representative, and the bounds of aggregate hold for great-circle
+ *          distances with that radius.
+ *
+ * @param   store       points to merge
+ * @param   cellSize    side of a grid cell, in degrees
+ * @param   fillPoints  array of store.size() to fill with Latitude/Longitude
+ *                      representatives, in degrees
+ * @param   fillWeights array of store.size() to fill with their weights
+ *
+ * @return  number of representatives
+ */
+size_t aggregate(const Geo::PointStore & store,
+                 double                  cellSize,
+                 double                  fillPoints[][2],
+                 double                  fillWeights[]);
 }  // namespace Center
 
 #endif
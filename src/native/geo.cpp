@@ -0,0 +1,248 @@
+#include "geo.h"
+#include "cartesian.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief  Converts a Latitude/Longitude point to a unit vector from the
+ *         earth's center
+ *
+ * @param  point Latitude/Longitude of the point, in degrees
+ * @param  fill  array to fill with the unit vector
+ */
+void Geo::unitVector(const double point[2], double fill[3])
+{
+  const double phi    = Cartesian::radiansFromDeg(point[0]);
+  const double lambda = Cartesian::radiansFromDeg(point[1]);
+
+  fill[0] = std::cos(phi) * std::cos(lambda);
+  fill[1] = std::cos(phi) * std::sin(lambda);
+  fill[2] = std::sin(phi);
+}
+
+/**
+ * @brief  Converts a unit vector from the earth's center to a
+ *         Latitude/Longitude point
+ *
+ * @param  v    unit vector
+ * @param  fill array to fill with Latitude/Longitude, in degrees
+ */
+void Geo::fromUnitVector(const double v[3], double fill[2])
+{
+  const double DEGREES = 180 / Cartesian::PI;
+
+  fill[0] = std::asin(std::max(-1.0, std::min(1.0, v[2]))) * DEGREES;
+  fill[1] = std::atan2(v[1], v[0]) * DEGREES;
+}
+
+/**
+ * @brief  Returns the number of points in the store
+ */
+size_t Geo::PointStore::size() const
+{
+  return _lat.size();
+}
+
+/**
+ * @brief  Replaces the contents of the store with a set of points
+ *
+ * @param  points    Latitude/Longitude points, in degrees
+ * @param  numPoints number of points; point i goes in slot i
+ */
+void Geo::PointStore::build(const double points[][2], size_t numPoints)
+{
+  std::vector<double> * columns[] = {&_lat,    &_lng,    &_sinLat,
+                                     &_cosLat, &_sinLng, &_cosLng,
+                                     &_x,      &_y,      &_z};
+  for (size_t c = 0; c < sizeof(columns) / sizeof(columns[0]); ++c) {
+    columns[c]->resize(numPoints);
+  }
+  for (size_t i = 0; i < numPoints; ++i) {
+    fill(i, points[i]);
+  }
+}
+
+/**
+ * @brief  Appends a point
+ *
+ * @param  point Latitude/Longitude of the point, in degrees
+ *
+ * @return slot of the point
+ */
+size_t Geo::PointStore::add(const double point[2])
+{
+  const size_t slot = size();
+
+  _lat.push_back(0), _lng.push_back(0);
+  _sinLat.push_back(0), _cosLat.push_back(0);
+  _sinLng.push_back(0), _cosLng.push_back(0);
+  _x.push_back(0), _y.push_back(0), _z.push_back(0);
+  fill(slot, point);
+  return slot;
+}
+
+/**
+ * @brief  Replaces the point in a slot
+ *
+ * @param  slot  slot of the point, less than size()
+ * @param  point Latitude/Longitude of the new point, in degrees
+ */
+void Geo::PointStore::set(size_t slot, const double point[2])
+{
+  fill(slot, point);
+}
+
+/**
+ * @brief  Removes the point in a slot, moving the last point into it
+ *
+ * @param  slot slot of the point, less than size()
+ */
+void Geo::PointStore::remove(size_t slot)
+{
+  std::vector<double> * columns[] = {&_lat,    &_lng,    &_sinLat,
+                                     &_cosLat, &_sinLng, &_cosLng,
+                                     &_x,      &_y,      &_z};
+  for (size_t c = 0; c < sizeof(columns) / sizeof(columns[0]); ++c) {
+    std::vector<double> & column = *columns[c];
+    column[slot]                 = column.back();
+    column.pop_back();
+  }
+}
+
+/**
+ * @brief  Returns the cached quantities, one array per quantity indexed by
+ *         slot, valid until the next edit
+ */
+const double * Geo::PointStore::lat() const
+{
+  return _lat.data();
+}
+
+const double * Geo::PointStore::lng() const
+{
+  return _lng.data();
+}
+
+const double * Geo::PointStore::sinLat() const
+{
+  return _sinLat.data();
+}
+
+const double * Geo::PointStore::cosLat() const
+{
+  return _cosLat.data();
+}
+
+const double * Geo::PointStore::sinLng() const
+{
+  return _sinLng.data();
+}
+
+const double * Geo::PointStore::cosLng() const
+{
+  return _cosLng.data();
+}
+
+const double * Geo::PointStore::x() const
+{
+  return _x.data();
+}
+
+const double * Geo::PointStore::y() const
+{
+  return _y.data();
+}
+
+const double * Geo::PointStore::z() const
+{
+  return _z.data();
+}
+
+/**
+ * @brief  Works out the cached quantities of a point
+ *
+ * @param  slot  slot to fill
+ * @param  point Latitude/Longitude of the point, in degrees
+ */
+void Geo::PointStore::fill(size_t slot, const double point[2])
+{
+  _lat[slot]    = Cartesian::radiansFromDeg(point[0]);
+  _lng[slot]    = Cartesian::radiansFromDeg(point[1]);
+  _sinLat[slot] = std::sin(_lat[slot]);
+  _cosLat[slot] = std::cos(_lat[slot]);
+  _sinLng[slot] = std::sin(_lng[slot]);
+  _cosLng[slot] = std::cos(_lng[slot]);
+  _x[slot]      = _cosLat[slot] * _cosLng[slot];
+  _y[slot]      = _cosLat[slot] * _sinLng[slot];
+  _z[slot]      = _sinLat[slot];
+}
+
+/**
+ * @brief   Calculates the earthly distance from the points of a store to a
+ *          center
+ * @details Matches Cartesian::fillDistances, but only the center needs any
+ *          trigonometry; each point takes the angle between unit vectors, or
+ *          just the chord between them in chord mode.
+ *
+ * @param   store  points to measure distance from
+ * @param   center Latitude/Longitude center, in degrees
+ * @param   unit   type of unit to use, as for Cartesian::haversine
+ * @param   fill   array of store.size() to fill with distances
+ * @param   mode   formula to measure distance with
+ */
+void Geo::fillDistances(const PointStore &      store,
+                        const double            center[2],
+                        char                    unit,
+                        double                  fill[],
+                        Cartesian::DistanceMode mode)
+{
+  const double   scale  = Cartesian::unitScale(unit);
+  const double   radius = Cartesian::EARTH_RADIUS_METERS * scale;
+  const double * x      = store.x();
+  const double * y      = store.y();
+  const double * z      = store.z();
+  const size_t   size   = store.size();
+  double         c[3];
+  unitVector(center, c);
+
+  if (mode == Cartesian::equirectangular) {
+    const double   phi    = Cartesian::radiansFromDeg(center[0]);
+    const double   lambda = Cartesian::radiansFromDeg(center[1]);
+    const double   TWO_PI = 2 * 3.14159265358979323846;
+    const double * lat    = store.lat();
+    const double * lng    = store.lng();
+    for (size_t i = 0; i < size; ++i) {
+      double dlng = lng[i] - lambda;
+      dlng -= TWO_PI * std::floor(dlng / TWO_PI + 0.5);
+      const double dx = dlng * Cartesian::cosApprox((phi + lat[i]) / 2);
+      const double dy = lat[i] - phi;
+      fill[i]         = std::sqrt(dx * dx + dy * dy) * radius;
+    }
+    return;
+  }
+
+  // the angle between unit vectors is the arcsine of the half chord between
+  // them, doubled; unlike their dot product, the chord keeps its precision
+  // for points close together
+  for (size_t i = 0; i < size; ++i) {
+    const double dx = x[i] - c[0], dy = y[i] - c[1], dz = z[i] - c[2];
+    fill[i]         = std::sqrt(dx * dx + dy * dy + dz * dz) / 2;
+  }
+  switch (mode) {
+    case Cartesian::chord:
+      for (size_t i = 0; i < size; ++i) {
+        fill[i] *= 2 * radius;
+      }
+      break;
+    case Cartesian::polynomial:
+      for (size_t i = 0; i < size; ++i) {
+        fill[i] = 2 * Cartesian::asinApprox(std::min(1.0, fill[i])) * radius;
+      }
+      break;
+    default:
+      for (size_t i = 0; i < size; ++i) {
+        fill[i] = 2 * std::asin(std::min(1.0, fill[i])) * radius;
+      }
+      break;
+  }
+}
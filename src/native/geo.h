@@ -0,0 +1,137 @@
+#ifndef GEO_H
+#define GEO_H
+
+#include "cartesian.h"
+#include <stddef.h>
+#include <vector>
+
+namespace Geo
+{
+/**
+ * @brief  Converts a Latitude/Longitude point to a unit vector from the
+ *         earth's center
+ *
+ * @param  point Latitude/Longitude of the point, in degrees
+ * @param  fill  array to fill with the unit vector
+ */
+void unitVector(const double point[2], double fill[3]);
+
+/**
+ * @brief  Converts a unit vector from the earth's center to a
+ *         Latitude/Longitude point
+ *
+ * @param  v    unit vector
+ * @param  fill array to fill with Latitude/Longitude, in degrees
+ */
+void fromUnitVector(const double v[3], double fill[2]);
+
+/**
+ * @class
+ * @brief   Latitude/Longitude points with their trigonometry worked out once
+ * @details Keeps, for each point, its latitude and longitude in radians, their
+ *          sines and cosines, and its unit vector from the earth's center
+ *          (ECEF coordinates on a unit sphere), one array per quantity so that
+ *          kernels over them vectorize. Edits only recompute the point they
+ *          touch, so a store that is edited rarely and queried often turns
+ *          each distance into a few multiply-adds and one inverse
+ *          trigonometric call.
+ *          Points are addressed by slot; removal moves the last point into the
+ *          removed slot, as Position#remove does with its locations.
+ *
+ * ```
+ * Geo::PointStore store;
+ * store.build(points, numPoints);
+ * store.set(2, moved);
+ * Geo::fillDistances(store, center, unit, distances);
+ * ```
+ */
+class PointStore
+{
+ public:
+  /**
+   * @brief  Returns the number of points in the store
+   */
+  size_t size() const;
+
+  /**
+   * @brief  Replaces the contents of the store with a set of points
+   *
+   * @param  points    Latitude/Longitude points, in degrees
+   * @param  numPoints number of points; point i goes in slot i
+   */
+  void build(const double points[][2], size_t numPoints);
+
+  /**
+   * @brief  Appends a point
+   *
+   * @param  point Latitude/Longitude of the point, in degrees
+   *
+   * @return slot of the point
+   */
+  size_t add(const double point[2]);
+
+  /**
+   * @brief  Replaces the point in a slot
+   *
+   * @param  slot  slot of the point, less than size()
+   * @param  point Latitude/Longitude of the new point, in degrees
+   */
+  void set(size_t slot, const double point[2]);
+
+  /**
+   * @brief  Removes the point in a slot, moving the last point into it
+   *
+   * @param  slot slot of the point, less than size()
+   */
+  void remove(size_t slot);
+
+  /**
+   * @brief  Returns the cached quantities, one array per quantity indexed by
+   *         slot, valid until the next edit
+   */
+  const double * lat() const;
+  const double * lng() const;
+  const double * sinLat() const;
+  const double * cosLat() const;
+  const double * sinLng() const;
+  const double * cosLng() const;
+  const double * x() const;
+  const double * y() const;
+  const double * z() const;
+
+ private:
+  void fill(size_t slot, const double point[2]);
+
+  std::vector<double> _lat;
+  std::vector<double> _lng;
+  std::vector<double> _sinLat;
+  std::vector<double> _cosLat;
+  std::vector<double> _sinLng;
+  std::vector<double> _cosLng;
+  std::vector<double> _x;
+  std::vector<double> _y;
+  std::vector<double> _z;
+};
+
+/**
+ * @brief   Calculates the earthly distance from the points of a store to a
+ *          center
+ * @details Matches Cartesian::fillDistances, but only the center needs any
+ *          trigonometry; each point takes the angle between unit vectors, or
+ *          just the chord between them in chord mode.
+ *
+ * @param   store  points to measure distance from
+ * @param   center Latitude/Longitude center, in degrees
+ * @param   unit   type of unit to use, as for Cartesian::haversine
+ * @param   fill   array of store.size() to fill with distances
+ * @param   mode   formula to measure distance with
+ */
+void fillDistances(const PointStore &      store,
+                   const double            center[2],
+                   char                    unit,
+                   double                  fill[],
+                   Cartesian::DistanceMode mode = Cartesian::exact);
+
+}  // namespace Geo
+
+#endif
@@ -0,0 +1,168 @@
+#include "meethere.h"
+#include "cartesian.h"
+#include "center.h"
+#include "polynomial.h"
+#include "tsp.h"
+
+namespace
+{
+typedef const double (*PointArr)[2];
+
+/**
+ * @brief  Views interleaved coordinates as an array of points
+ *
+ * @param  points interleaved coordinates
+ *
+ * @return array of points
+ */
+PointArr asPoints(const double * points)
+{
+  return reinterpret_cast<PointArr>(points);
+}
+
+/**
+ * @brief  Converts C search options to their engine counterpart
+ */
+Center::GeometricCenterOptions fromOptions(const mh_center_options * options)
+{
+  const Center::GeometricCenterOptions opts = {
+      options->epsilon, options->bounds, options->subsearch != 0,
+      options->max_iterations, options->max_micros};
+  return opts;
+}
+
+/**
+ * @brief  Copies engine search telemetry to its C counterpart, if requested
+ */
+void toStats(const Center::GeometricCenterStats & _stats,
+             mh_center_stats *                    stats)
+{
+  if (stats) {
+    stats->iterations       = _stats.iterations;
+    stats->cost_evaluations = _stats.costEvaluations;
+    stats->step_halvings    = _stats.stepHalvings;
+    stats->final_step       = _stats.finalStep;
+    stats->converged        = _stats.converged;
+  }
+}
+}  // namespace
+
+int mh_api_version(void)
+{
+  return MEETHERE_API_VERSION;
+}
+
+double mh_center_cost(double         x,
+                      double         y,
+                      const double * points,
+                      size_t         numPoints)
+{
+  return Center::cost(x, y, asPoints(points), numPoints);
+}
+
+double mh_center_mass(const double * points, size_t numPoints, double fill[2])
+{
+  Center::centerOfMass(asPoints(points), numPoints, fill);
+  return Center::cost(fill[0], fill[1], asPoints(points), numPoints);
+}
+
+double mh_center_geometric(const double *            points,
+                           size_t                    numPoints,
+                           const mh_center_options * options,
+                           double                    fill[2],
+                           mh_center_stats *         stats)
+{
+  Center::GeometricCenterStats _stats;
+  const double score = Center::geometricCenter(
+      asPoints(points), numPoints, fromOptions(options), fill, &_stats);
+
+  toStats(_stats, stats);
+  return score;
+}
+
+double mh_center_geometric_weighted(const double *            points,
+                                    const double *            weights,
+                                    size_t                    numPoints,
+                                    const mh_center_options * options,
+                                    double                    fill[2],
+                                    mh_center_stats *         stats)
+{
+  Center::GeometricCenterStats _stats;
+  const double score =
+      Center::geometricCenter(asPoints(points), weights, numPoints,
+                              fromOptions(options), fill, &_stats);
+
+  toStats(_stats, stats);
+  return score;
+}
+
+size_t mh_center_aggregate(const double * points,
+                           size_t         numPoints,
+                           double         cellSize,
+                           double *       fillPoints,
+                           double *       fillWeights)
+{
+  return Center::aggregate(asPoints(points), numPoints, cellSize,
+                           reinterpret_cast<double(*)[2]>(fillPoints),
+                           fillWeights);
+}
+
+double mh_center_spherical(const double *            points,
+                           size_t                    numPoints,
+                           const mh_center_options * options,
+                           double                    fill[2],
+                           mh_center_stats *         stats)
+{
+  Center::GeometricCenterStats _stats;
+  const double score = Center::sphericalCenter(
+      asPoints(points), numPoints, fromOptions(options), fill, &_stats);
+
+  toStats(_stats, stats);
+  return score;
+}
+
+void mh_cartesian_distances(const double * points,
+                            size_t         numPoints,
+                            const double   center[2],
+                            char           unit,
+                            double *       fill)
+{
+  Cartesian::fillDistances(asPoints(points), numPoints, center, unit, fill);
+}
+
+void mh_cartesian_distances_mode(const double * points,
+                                 size_t         numPoints,
+                                 const double   center[2],
+                                 char           unit,
+                                 char           mode,
+                                 double *       fill)
+{
+  Cartesian::fillDistances(asPoints(points), numPoints, center, unit, fill,
+                           static_cast<Cartesian::DistanceMode>(mode));
+}
+
+size_t mh_tsp_route(const double * points,
+                    size_t         numPoints,
+                    size_t         startCity,
+                    char           method,
+                    size_t *       fill)
+{
+  return TSP::fillRoute(asPoints(points), numPoints, startCity,
+                        static_cast<TSP::VisitMethod>(method), fill);
+}
+
+size_t mh_polynomial_degree(const double * x,
+                            const double * y,
+                            size_t         numPoints)
+{
+  return Polynomial::guessPolynomialDegree(x, y, numPoints);
+}
+
+void mh_polynomial_fit(const double * x,
+                       const double * y,
+                       size_t         numPoints,
+                       size_t         degree,
+                       double *       fill)
+{
+  Polynomial::fillBestFit(x, y, numPoints, degree, fill);
+}
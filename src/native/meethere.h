@@ -0,0 +1,256 @@
+#ifndef MEETHERE_H
+#define MEETHERE_H
+
+/**
+ * Stable C interface to the meetHere engines, for embedding them without
+ * Node. Points are passed as interleaved coordinate pairs, i.e. `2 * n`
+ * doubles laid out as `x0, y0, x1, y1, ...` (or `lat0, lng0, ...` for
+ * geographic functions). Nothing here allocates memory that the caller must
+ * free; scratch memory is drawn from a per-thread arena that is reused across
+ * calls.
+ *
+ * C++ callers may also use the engine namespaces (`Center`, `Cartesian`,
+ * `Geo`, `PointFile`, `Spatial`, `TSP`, `Polynomial`) directly through their
+ * own headers; stateful engines such as `Geo::PointStore` and
+ * `PointFile::Reader` are only available there.
+ */
+
+#include <stddef.h>
+
+#define MEETHERE_API_VERSION 6
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct
+ * @brief  Options for how the geometric center should be calculated
+ *
+ * @prop   epsilon        acceptable margin of error
+ * @prop   bounds         a multiplier of the range of points to search
+ * @prop   subsearch      whether to search obliquely (non-zero for true)
+ * @prop   max_iterations most search iterations to perform, or 0 for no limit
+ * @prop   max_micros     most microseconds to search for, or 0 for no limit
+ */
+typedef struct mh_center_options {
+  double epsilon;
+  double bounds;
+  int    subsearch;
+  size_t max_iterations;
+  double max_micros;
+} mh_center_options;
+
+/**
+ * @struct
+ * @brief  Telemetry of how hard a geometric center search worked
+ *
+ * @prop   iterations       number of search iterations performed
+ * @prop   cost_evaluations number of times the cost function was evaluated
+ * @prop   step_halvings    number of times the step was halved
+ * @prop   final_step       step size when the search stopped
+ * @prop   converged        non-zero if the step reached epsilon before a
+ *                          budget ran out
+ */
+typedef struct mh_center_stats {
+  size_t iterations;
+  size_t cost_evaluations;
+  size_t step_halvings;
+  double final_step;
+  int    converged;
+} mh_center_stats;
+
+/**
+ * @brief  Returns the version of the API the library was built with
+ *
+ * @return value of MEETHERE_API_VERSION at build time
+ */
+int mh_api_version(void);
+
+/**
+ * @brief  Calculates the net Pythagorean cost of travelling from a set of
+ *         points to a center
+ *
+ * @param  x         center x coordinate
+ * @param  y         center y coordinate
+ * @param  points    interleaved points to measure distance from
+ * @param  numPoints number of points
+ *
+ * @return net cost of travelling to the center
+ */
+double mh_center_cost(double         x,
+                      double         y,
+                      const double * points,
+                      size_t         numPoints);
+
+/**
+ * @brief  Finds the center of mass of a set of points
+ *
+ * @param  points    interleaved points to measure
+ * @param  numPoints number of points
+ * @param  fill      array to fill with the center of mass
+ *
+ * @return net cost of travelling to the center of mass
+ */
+double mh_center_mass(const double * points, size_t numPoints, double fill[2]);
+
+/**
+ * @brief  Finds the geometric center of a set of points
+ *
+ * @param  points    interleaved points to find the center of
+ * @param  numPoints number of points
+ * @param  options   search options
+ * @param  fill      array to fill with the geometric center
+ * @param  stats     telemetry to fill about the search, or NULL
+ *
+ * @return net cost of travelling to the geometric center
+ */
+double mh_center_geometric(const double *            points,
+                           size_t                    numPoints,
+                           const mh_center_options * options,
+                           double                    fill[2],
+                           mh_center_stats *         stats);
+
+/**
+ * @brief  Finds the geometric center of a set of weighted points
+ *
+ * @param  points    interleaved points to find the center of
+ * @param  weights   weight of each point
+ * @param  numPoints number of points
+ * @param  options   search options
+ * @param  fill      array to fill with the geometric center
+ * @param  stats     telemetry to fill about the search, or NULL
+ *
+ * @return net weighted cost of travelling to the geometric center
+ */
+double mh_center_geometric_weighted(const double *            points,
+                                    const double *            weights,
+                                    size_t                    numPoints,
+                                    const mh_center_options * options,
+                                    double                    fill[2],
+                                    mh_center_stats *         stats);
+
+/**
+ * @brief  Merges points that share a grid cell into weighted representatives,
+ *         as Center::aggregate
+ *
+ * @param  points      interleaved points to merge
+ * @param  numPoints   number of points
+ * @param  cellSize    side of a grid cell, in the units of the points
+ * @param  fillPoints  array of 2 * numPoints to fill with interleaved
+ *                     representatives
+ * @param  fillWeights array of numPoints to fill with their weights
+ *
+ * @return number of representatives
+ */
+size_t mh_center_aggregate(const double * points,
+                           size_t         numPoints,
+                           double         cellSize,
+                           double *       fillPoints,
+                           double *       fillWeights);
+
+/**
+ * @brief  Finds the geometric center of a set of points on the earth's surface
+ * @details Minimizes net great-circle distance; bounds and subsearch are
+ *          ignored, and epsilon is in degrees.
+ *
+ * @param  points    interleaved Latitude/Longitude points, in degrees
+ * @param  numPoints number of points
+ * @param  options   search options
+ * @param  fill      array to fill with the geometric center, in degrees
+ * @param  stats     telemetry to fill about the search, or NULL
+ *
+ * @return net distance to the geometric center, in kilometers
+ */
+double mh_center_spherical(const double *            points,
+                           size_t                    numPoints,
+                           const mh_center_options * options,
+                           double                    fill[2],
+                           mh_center_stats *         stats);
+
+/**
+ * @brief  Calculates the earthly distance from a set of points to a center
+ *
+ * @param  points    interleaved Latitude/Longitude points, in degrees
+ * @param  numPoints number of points
+ * @param  center    Latitude/Longitude center, in degrees
+ * @param  unit      type of unit to use, as for Cartesian::haversine
+ * @param  fill      array of numPoints to fill with distances
+ */
+void mh_cartesian_distances(const double * points,
+                            size_t         numPoints,
+                            const double   center[2],
+                            char           unit,
+                            double *       fill);
+
+/**
+ * @brief  Calculates the earthly distance from a set of points to a center by
+ *         one of the approximate formulas of Cartesian::DistanceMode
+ *
+ * @param  points    interleaved Latitude/Longitude points, in degrees
+ * @param  numPoints number of points
+ * @param  center    Latitude/Longitude center, in degrees
+ * @param  unit      type of unit to use, as for Cartesian::haversine
+ * @param  mode      formula to use: 'e' (exact), 'r' (equirectangular),
+ *                   'c' (chord) or 'p' (polynomial)
+ * @param  fill      array of numPoints to fill with distances
+ */
+void mh_cartesian_distances_mode(const double * points,
+                                 size_t         numPoints,
+                                 const double   center[2],
+                                 char           unit,
+                                 char           mode,
+                                 double *       fill);
+
+/**
+ * @brief  Determines an efficient order to visit a set of points in
+ *
+ * @param  points    interleaved points to visit
+ * @param  numPoints number of points
+ * @param  startCity index of the point to start from
+ * @param  method    't' for Pythagorean travel, 'n' for Manhattan travel,
+ *                   'h' for Pythagorean travel along a Hilbert curve
+ * @param  fill      array of numPoints to fill with the visiting order
+ *
+ * @return number of points in the order
+ */
+size_t mh_tsp_route(const double * points,
+                    size_t         numPoints,
+                    size_t         startCity,
+                    char           method,
+                    size_t *       fill);
+
+/**
+ * @brief  Guesses the optimal degree of a best-fit polynomial
+ *
+ * @param  x         x coordinates of the points
+ * @param  y         y coordinates of the points
+ * @param  numPoints number of points
+ *
+ * @return best degree of polynomial to approximate
+ */
+size_t mh_polynomial_degree(const double * x,
+                            const double * y,
+                            size_t         numPoints);
+
+/**
+ * @brief  Calculates the best-fit polynomial of a set of points
+ *
+ * @param  x         x coordinates of the points
+ * @param  y         y coordinates of the points
+ * @param  numPoints number of points
+ * @param  degree    degree of the polynomial
+ * @param  fill      array of degree + 1 to fill with coefficients, where each
+ *                   index corresponds to its degree
+ */
+void mh_polynomial_fit(const double * x,
+                       const double * y,
+                       size_t         numPoints,
+                       size_t         degree,
+                       double *       fill);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
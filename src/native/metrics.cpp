@@ -0,0 +1,435 @@
+#include "metrics.h"
+#include <cstdarg>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+
+const size_t       Metrics::NUM_PHASES      = 3;
+const char * const Metrics::PHASE_NAMES[]   = {"marshal", "compute",
+                                             "unmarshal"};
+const size_t       Metrics::SUB_BUCKET_BITS = 5;
+const size_t       Metrics::NUM_BUCKETS     = (64 - SUB_BUCKET_BITS + 2)
+                                         << (SUB_BUCKET_BITS - 1);
+const size_t       Metrics::TRACE_CAPACITY  = 1 << 16;
+
+namespace
+{
+/**
+ * @struct
+ * @brief  A sampled call, kept until it is exported as trace events
+ */
+struct TraceRecord {
+  const char * name;
+  size_t       size;
+  uint32_t     tid;
+  uint64_t     start;
+  uint64_t     starts[3];
+  uint64_t     durations[3];
+};
+
+/**
+ * @struct
+ * @brief  Process-wide state of the registry
+ */
+struct Registry {
+  Registry() : on(false), threshold(0), nextTid(0), nextTrace(0)
+  {
+    epoch = Metrics::Clock::now();
+  }
+
+  std::atomic<bool>                  on;
+  std::atomic<uint32_t>              threshold;
+  std::atomic<uint32_t>              nextTid;
+  Metrics::Clock::time_point         epoch;
+  std::mutex                         lock;
+  std::vector<Metrics::EntryPoint *> entries;
+  std::vector<TraceRecord>           traces;
+  size_t                             nextTrace;
+};
+
+Registry & registry()
+{
+  static Registry * instance = new Registry();
+  return *instance;
+}
+
+uint64_t nanosBetween(Metrics::Clock::time_point start,
+                      Metrics::Clock::time_point end)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+      .count();
+}
+
+/**
+ * @brief  Returns a small, stable id for the calling thread
+ */
+uint32_t threadId()
+{
+  static thread_local uint32_t id = registry().nextTid.fetch_add(1) + 1;
+  return id;
+}
+
+/**
+ * @brief  Returns a uniformly distributed 32-bit number (xorshift32)
+ */
+uint32_t nextRandom()
+{
+  static thread_local uint32_t state = 0x9E3779B9u ^ threadId();
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+/**
+ * @brief  Returns the value a quantile of the recorded values falls in
+ *
+ * @param  buckets  counts of each bucket
+ * @param  count    total count of the buckets
+ * @param  quantile quantile to find, in [0, 1]
+ *
+ * @return midpoint of the bucket holding the quantile
+ */
+uint64_t quantileOf(const std::vector<uint64_t> & buckets,
+                    uint64_t                      count,
+                    double                        quantile)
+{
+  const uint64_t rank = static_cast<uint64_t>(quantile * (count - 1)) + 1;
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      const uint64_t low  = Metrics::Histogram::lowestOf(i);
+      const uint64_t high = i + 1 < buckets.size()
+                                ? Metrics::Histogram::lowestOf(i + 1)
+                                : low + 1;
+      return low + (high - low - 1) / 2;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief  Appends formatted text to a string
+ */
+void appendf(std::string & out, const char * format, ...)
+{
+  char    buffer[512];
+  va_list args;
+  va_start(args, format);
+  const int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (length > 0) {
+    out.append(buffer, static_cast<size_t>(length) < sizeof(buffer)
+                           ? length
+                           : sizeof(buffer) - 1);
+  }
+}
+}  // namespace
+
+Metrics::Histogram::Histogram() : buckets(NUM_BUCKETS)
+{
+  reset();
+}
+
+/**
+ * @brief  Returns the bucket a value is counted in
+ */
+size_t Metrics::Histogram::bucketOf(uint64_t value)
+{
+  const uint64_t linear = 1u << SUB_BUCKET_BITS;
+  if (value < linear) {
+    return value;
+  }
+
+  // keep the leading SUB_BUCKET_BITS bits of the value
+  size_t msb = 0;
+  for (uint64_t v = value; v >>= 1;) {
+    ++msb;
+  }
+  const size_t shift = msb - (SUB_BUCKET_BITS - 1);
+  return shift * (linear / 2) + (value >> shift);
+}
+
+/**
+ * @brief  Returns the smallest value counted in a bucket
+ */
+uint64_t Metrics::Histogram::lowestOf(size_t bucket)
+{
+  const size_t linear = 1u << SUB_BUCKET_BITS;
+  if (bucket < linear) {
+    return bucket;
+  }
+
+  const size_t shift    = bucket / (linear / 2) - 1;
+  const size_t mantissa = bucket % (linear / 2) + linear / 2;
+  return static_cast<uint64_t>(mantissa) << shift;
+}
+
+/**
+ * @brief  Records a value
+ *
+ * @param  value value to record
+ */
+void Metrics::Histogram::record(uint64_t value)
+{
+  buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(value, std::memory_order_relaxed);
+
+  uint64_t seen = min.load(std::memory_order_relaxed);
+  while (value < seen && !min.compare_exchange_weak(seen, value)) {
+  }
+  seen = max.load(std::memory_order_relaxed);
+  while (value > seen && !max.compare_exchange_weak(seen, value)) {
+  }
+}
+
+/**
+ * @brief  Summarizes the recorded values
+ *
+ * @return count, sum, extrema, mean, and quantiles of the values
+ */
+Metrics::HistogramSnapshot Metrics::Histogram::snapshot() const
+{
+  std::vector<uint64_t> counts(buckets.size());
+  uint64_t              total = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    counts[i] = buckets[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+
+  HistogramSnapshot result = {total, sum.load(), 0, 0, 0, 0, 0, 0, 0};
+  if (total) {
+    result.min  = min.load();
+    result.max  = max.load();
+    result.mean = static_cast<double>(result.sum) / total;
+    result.p50  = quantileOf(counts, total, 0.5);
+    result.p90  = quantileOf(counts, total, 0.9);
+    result.p99  = quantileOf(counts, total, 0.99);
+    result.p999 = quantileOf(counts, total, 0.999);
+  }
+  return result;
+}
+
+/**
+ * @brief  Forgets every recorded value
+ */
+void Metrics::Histogram::reset()
+{
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    buckets[i].store(0, std::memory_order_relaxed);
+  }
+  sum.store(0);
+  min.store(std::numeric_limits<uint64_t>::max());
+  max.store(0);
+}
+
+Metrics::EntryPoint::EntryPoint(const char * name) : name(name), calls(0)
+{
+}
+
+/**
+ * @brief  Turns instrumentation on or off
+ * @details While off, instrumented calls cost a single relaxed atomic load.
+ *
+ * @param  on         whether to record metrics
+ * @param  sampleRate fraction of calls, in [0, 1], to record trace events for
+ */
+void Metrics::enable(bool on, double sampleRate)
+{
+  Registry & r = registry();
+
+  const double rate = sampleRate < 0 ? 0 : sampleRate > 1 ? 1 : sampleRate;
+  r.threshold.store(static_cast<uint32_t>(
+      rate * std::numeric_limits<uint32_t>::max()));
+  r.on.store(on);
+}
+
+/**
+ * @brief  Returns whether instrumentation is on
+ */
+bool Metrics::enabled()
+{
+  return registry().on.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief  Returns the metrics of an entry point, registering it on first use
+ * @details Entry points live for the lifetime of the process, so the result
+ *          is best cached in a function-local static.
+ *
+ * @param  name name of the entry point; must outlive the process
+ *
+ * @return metrics of the entry point
+ */
+Metrics::EntryPoint & Metrics::entryPoint(const char * name)
+{
+  Registry &                  r = registry();
+  std::lock_guard<std::mutex> guard(r.lock);
+
+  for (size_t i = 0; i < r.entries.size(); ++i) {
+    if (std::string(r.entries[i]->name) == name) {
+      return *r.entries[i];
+    }
+  }
+  r.entries.push_back(new EntryPoint(name));
+  return *r.entries.back();
+}
+
+/**
+ * @brief  Summarizes the metrics of every registered entry point
+ *
+ * @return snapshot of each entry point, in order of registration
+ */
+std::vector<Metrics::EntryPointSnapshot> Metrics::snapshot()
+{
+  Registry &                  r = registry();
+  std::lock_guard<std::mutex> guard(r.lock);
+
+  std::vector<EntryPointSnapshot> result(r.entries.size());
+  for (size_t i = 0; i < r.entries.size(); ++i) {
+    const EntryPoint & entry = *r.entries[i];
+
+    result[i].name  = entry.name;
+    result[i].calls = entry.calls.load();
+    for (size_t p = 0; p < NUM_PHASES; ++p) {
+      result[i].phases[p] = entry.phases[p].snapshot();
+    }
+    result[i].sizes = entry.sizes.snapshot();
+  }
+  return result;
+}
+
+/**
+ * @brief  Forgets every recorded metric and trace event
+ */
+void Metrics::reset()
+{
+  Registry &                  r = registry();
+  std::lock_guard<std::mutex> guard(r.lock);
+
+  for (size_t i = 0; i < r.entries.size(); ++i) {
+    EntryPoint & entry = *r.entries[i];
+
+    entry.calls.store(0);
+    for (size_t p = 0; p < NUM_PHASES; ++p) {
+      entry.phases[p].reset();
+    }
+    entry.sizes.reset();
+  }
+  r.traces.clear();
+  r.nextTrace = 0;
+}
+
+/**
+ * @brief  Exports the sampled calls as Chrome trace-event JSON
+ * @details The output loads directly in chrome://tracing or Perfetto. Each
+ *          sampled call is a complete ("X") event, with its phases nested
+ *          under it.
+ *
+ * @return trace-event JSON document
+ */
+std::string Metrics::traceJSON()
+{
+  Registry &                  r = registry();
+  std::lock_guard<std::mutex> guard(r.lock);
+
+  std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+  // once the buffer wraps, the oldest record sits at nextTrace
+  const size_t numTraces = r.traces.size();
+  const size_t first     = numTraces == TRACE_CAPACITY ? r.nextTrace : 0;
+  for (size_t n = 0; n < numTraces; ++n) {
+    const TraceRecord & t = r.traces[(first + n) % numTraces];
+
+    uint64_t total = 0;
+    for (size_t p = 0; p < NUM_PHASES; ++p) {
+      total += t.durations[p];
+    }
+    appendf(out,
+            "%s{\"name\":\"%s\",\"cat\":\"meethere\",\"ph\":\"X\",\"pid\":1,"
+            "\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"size\":%zu}}",
+            n ? "," : "", t.name, t.tid, t.start / 1e3, total / 1e3, t.size);
+    for (size_t p = 0; p < NUM_PHASES; ++p) {
+      if (!t.durations[p]) {
+        continue;
+      }
+      appendf(out,
+              ",{\"name\":\"%s\",\"cat\":\"meethere\",\"ph\":\"X\","
+              "\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+              PHASE_NAMES[p], t.tid, t.starts[p] / 1e3, t.durations[p] / 1e3);
+    }
+  }
+
+  out += "]}";
+  return out;
+}
+
+Metrics::Call::Call(EntryPoint & entry, size_t size)
+    : entry(entry),
+      size(size),
+      active(registry().on.load(std::memory_order_relaxed)),
+      sampled(false),
+      phase(marshal)
+{
+  if (!active) {
+    return;
+  }
+
+  const uint32_t threshold = registry().threshold.load();
+  sampled = threshold && nextRandom() <= threshold;
+
+  for (size_t p = 0; p < NUM_PHASES; ++p) {
+    durations[p] = 0;
+  }
+  start = starts[marshal] = Clock::now();
+}
+
+Metrics::Call::~Call()
+{
+  if (!active) {
+    return;
+  }
+  mark(phase);
+
+  entry.calls.fetch_add(1, std::memory_order_relaxed);
+  entry.sizes.record(size);
+  for (size_t p = 0; p < NUM_PHASES; ++p) {
+    if (durations[p]) {
+      entry.phases[p].record(durations[p]);
+    }
+  }
+
+  if (sampled) {
+    Registry & r = registry();
+
+    TraceRecord record = {entry.name, size, threadId(),
+                          nanosBetween(r.epoch, start), {0}, {0}};
+    for (size_t p = 0; p < NUM_PHASES; ++p) {
+      record.starts[p]    = durations[p] ? nanosBetween(r.epoch, starts[p]) : 0;
+      record.durations[p] = durations[p];
+    }
+
+    std::lock_guard<std::mutex> guard(r.lock);
+    if (r.traces.size() < TRACE_CAPACITY) {
+      r.traces.push_back(record);
+    } else {
+      r.traces[r.nextTrace] = record;
+    }
+    r.nextTrace = (r.nextTrace + 1) % TRACE_CAPACITY;
+  }
+}
+
+/**
+ * @brief  Ends the current phase and starts another
+ *
+ * @param  next phase to start
+ */
+void Metrics::Call::mark(Phase next)
+{
+  const Clock::time_point now = Clock::now();
+  durations[phase] += nanosBetween(starts[phase], now);
+  phase         = next;
+  starts[phase] = now;
+}
@@ -0,0 +1,225 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Metrics
+{
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @enum
+ * @brief The phases of a call into a native entry point
+ *
+ * @prop  marshal   converting arguments to native data
+ * @prop  compute   running the engine
+ * @prop  unmarshal building the result handed back to the caller
+ */
+enum Phase { marshal, compute, unmarshal };
+
+extern const size_t       NUM_PHASES;
+extern const char * const PHASE_NAMES[];
+extern const size_t       SUB_BUCKET_BITS;
+extern const size_t       NUM_BUCKETS;
+extern const size_t       TRACE_CAPACITY;
+
+/**
+ * @struct
+ * @brief  Summary statistics of a histogram
+ */
+struct HistogramSnapshot {
+  uint64_t count;
+  uint64_t sum;
+  uint64_t min;
+  uint64_t max;
+  double   mean;
+  uint64_t p50;
+  uint64_t p90;
+  uint64_t p99;
+  uint64_t p999;
+};
+
+/**
+ * @class
+ * @brief   Lock-free, log-linear (HDR-style) histogram of unsigned values
+ * @details Each power of two is split into 16 linear sub-buckets, bounding
+ *          the relative error of any reported quantile by 1/16.
+ */
+class Histogram
+{
+ public:
+  Histogram();
+
+  /**
+   * @brief  Records a value
+   *
+   * @param  value value to record
+   */
+  void record(uint64_t value);
+
+  /**
+   * @brief  Summarizes the recorded values
+   *
+   * @return count, sum, extrema, mean, and quantiles of the values
+   */
+  HistogramSnapshot snapshot() const;
+
+  /**
+   * @brief  Forgets every recorded value
+   */
+  void reset();
+
+  /**
+   * @brief  Returns the bucket a value is counted in
+   */
+  static size_t bucketOf(uint64_t value);
+
+  /**
+   * @brief  Returns the smallest value counted in a bucket
+   */
+  static uint64_t lowestOf(size_t bucket);
+
+ private:
+  Histogram(const Histogram &);
+  Histogram & operator=(const Histogram &);
+
+  std::vector<std::atomic<uint64_t> > buckets;
+  std::atomic<uint64_t>               sum;
+  std::atomic<uint64_t>               min;
+  std::atomic<uint64_t>               max;
+};
+
+/**
+ * @struct
+ * @brief  Counters and histograms kept for a single native entry point
+ *
+ * @prop   name   name of the entry point, e.g. `center.geometric`
+ * @prop   calls  number of instrumented calls
+ * @prop   phases nanoseconds spent in each phase, per call
+ * @prop   sizes  input size of each call
+ */
+struct EntryPoint {
+  explicit EntryPoint(const char * name);
+
+  const char * const    name;
+  std::atomic<uint64_t> calls;
+  Histogram             phases[3];
+  Histogram             sizes;
+};
+
+/**
+ * @struct
+ * @brief  Snapshot of the metrics of a single entry point
+ */
+struct EntryPointSnapshot {
+  const char *      name;
+  uint64_t          calls;
+  HistogramSnapshot phases[3];
+  HistogramSnapshot sizes;
+};
+
+/**
+ * @brief  Turns instrumentation on or off
+ * @details While off, instrumented calls cost a single relaxed atomic load.
+ *
+ * @param  on         whether to record metrics
+ * @param  sampleRate fraction of calls, in [0, 1], to record trace events for
+ */
+void enable(bool on, double sampleRate);
+
+/**
+ * @brief  Returns whether instrumentation is on
+ */
+bool enabled();
+
+/**
+ * @brief  Returns the metrics of an entry point, registering it on first use
+ * @details Entry points live for the lifetime of the process, so the result
+ *          is best cached in a function-local static.
+ *
+ * @param  name name of the entry point; must outlive the process
+ *
+ * @return metrics of the entry point
+ */
+EntryPoint & entryPoint(const char * name);
+
+/**
+ * @brief  Summarizes the metrics of every registered entry point
+ *
+ * @return snapshot of each entry point, in order of registration
+ */
+std::vector<EntryPointSnapshot> snapshot();
+
+/**
+ * @brief  Forgets every recorded metric and trace event
+ */
+void reset();
+
+/**
+ * @brief  Exports the sampled calls as Chrome trace-event JSON
+ * @details The output loads directly in chrome://tracing or Perfetto. Each
+ *          sampled call is a complete ("X") event, with its phases nested
+ *          under it.
+ *
+ * @return trace-event JSON document
+ */
+std::string traceJSON();
+
+/**
+ * @class
+ * @brief   Instruments one call into an entry point
+ * @details Starts in the marshal phase; the caller moves it through the
+ *          remaining phases with enter, and the metrics are recorded when the
+ *          Call is destroyed.
+ *
+ * ```
+ * static Metrics::EntryPoint & metrics = Metrics::entryPoint("center.mass");
+ * Metrics::Call call(metrics, numPoints);
+ * // ...marshal
+ * call.enter(Metrics::compute);
+ * // ...compute
+ * call.enter(Metrics::unmarshal);
+ * ```
+ */
+class Call
+{
+ public:
+  Call(EntryPoint & entry, size_t size);
+  ~Call();
+
+  /**
+   * @brief  Ends the current phase and starts another
+   *
+   * @param  phase phase to start
+   */
+  void enter(Phase phase)
+  {
+    if (active) {
+      mark(phase);
+    }
+  }
+
+ private:
+  Call(const Call &);
+  Call & operator=(const Call &);
+
+  void mark(Phase phase);
+
+  EntryPoint &      entry;
+  const size_t      size;
+  const bool        active;
+  bool              sampled;
+  Phase             phase;
+  Clock::time_point start;
+  Clock::time_point starts[3];
+  uint64_t          durations[3];
+};
+
+}  // namespace Metrics
+
+#endif
@@ -0,0 +1,378 @@
+#include "pointfile.h"
+#include "arena.h"
+#include "polynomial.h"
+#include "util.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char     PointFile::MAGIC[4]    = {'M', 'H', 'P', 'T'};
+const uint16_t PointFile::VERSION     = 1;
+const size_t   PointFile::HEADER_SIZE = 24;
+
+// points converted per chunk; a chunk of points and weights stays within L2
+const size_t PointFile::CHUNK_SIZE = 8192;
+
+namespace
+{
+/**
+ * @brief  Converts a run of points, and their weights, of a mapped point file
+ *         whose values are of type T
+ */
+template <typename T>
+void readValues(const unsigned char * data,
+                size_t                size,
+                unsigned              flags,
+                size_t                start,
+                size_t                count,
+                double                fillPoints[][2],
+                double                fillWeights[])
+{
+  const T * values = reinterpret_cast<const T *>(data + PointFile::HEADER_SIZE);
+
+  if (flags & PointFile::columnar) {
+    const T * x = values + start;
+    const T * y = values + size + start;
+    for (size_t i = 0; i < count; ++i) {
+      fillPoints[i][0] = x[i];
+      fillPoints[i][1] = y[i];
+    }
+  } else {
+    const T * xy = values + 2 * start;
+    for (size_t i = 0; i < count; ++i) {
+      fillPoints[i][0] = xy[2 * i];
+      fillPoints[i][1] = xy[2 * i + 1];
+    }
+  }
+
+  if (!fillWeights) {
+    return;
+  }
+  if (flags & PointFile::weighted) {
+    const T * weights = values + 2 * size + start;
+    for (size_t i = 0; i < count; ++i) {
+      fillWeights[i] = weights[i];
+    }
+  } else {
+    std::fill(fillWeights, fillWeights + count, 1.0);
+  }
+}
+
+/**
+ * @brief  Measures the cost of travelling from the points of a file to a
+ *         center, as a Center::CostFunction
+ */
+double fileCost(double x, double y, const void * context)
+{
+  return PointFile::cost(*static_cast<const PointFile::Reader *>(context), x,
+                         y);
+}
+}  // namespace
+
+PointFile::Reader::Reader()
+    : _data(NULL), _bytes(0), _size(0), _flags(0), _error(NULL)
+{
+}
+
+PointFile::Reader::~Reader()
+{
+  close();
+}
+
+/**
+ * @brief  Maps a point file, closing any file mapped before
+ *
+ * @param  path path of the file
+ *
+ * @return whether the file could be mapped and has a valid header
+ */
+bool PointFile::Reader::open(const char * path)
+{
+  close();
+
+  const int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    _error = "cannot open point file";
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) || (size_t)info.st_size < HEADER_SIZE) {
+    ::close(fd);
+    _error = "point file is too short for its header";
+    return false;
+  }
+
+  void * data =
+      mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    _error = "cannot map point file";
+    return false;
+  }
+  _data  = static_cast<const unsigned char *>(data);
+  _bytes = (size_t)info.st_size;
+  madvise(data, _bytes, MADV_SEQUENTIAL);
+
+  // parse header
+  uint16_t version, flags;
+  uint64_t size;
+  std::memcpy(&version, _data + 4, sizeof(version));
+  std::memcpy(&flags, _data + 6, sizeof(flags));
+  std::memcpy(&size, _data + 8, sizeof(size));
+
+  const size_t valueSize = flags & single ? sizeof(float) : sizeof(double);
+  const size_t perPoint  = (flags & weighted ? 3 : 2) * valueSize;
+  if (std::memcmp(_data, MAGIC, sizeof(MAGIC))) {
+    _error = "not a point file";
+  } else if (version != VERSION) {
+    _error = "unsupported point file version";
+  } else if (flags & ~(single | columnar | weighted)) {
+    _error = "unknown point file flags";
+  } else if (size > (_bytes - HEADER_SIZE) / perPoint) {
+    _error = "point file is shorter than its point count";
+  } else {
+    _size  = (size_t)size;
+    _flags = flags;
+    _error = NULL;
+    return true;
+  }
+
+  const char * error = _error;
+  close();
+  _error = error;
+  return false;
+}
+
+/**
+ * @brief  Unmaps the file
+ */
+void PointFile::Reader::close()
+{
+  if (_data) {
+    munmap(const_cast<unsigned char *>(_data), _bytes);
+  }
+  _data  = NULL;
+  _bytes = _size = 0;
+  _flags         = 0;
+  _error         = NULL;
+}
+
+/**
+ * @brief  Returns why the last open failed
+ */
+const char * PointFile::Reader::error() const
+{
+  return _error;
+}
+
+/**
+ * @brief  Returns the number of points in the file
+ */
+size_t PointFile::Reader::size() const
+{
+  return _size;
+}
+
+/**
+ * @brief  Returns the layout flags of the file
+ */
+unsigned PointFile::Reader::flags() const
+{
+  return _flags;
+}
+
+/**
+ * @brief  Reads a run of points as float64
+ *
+ * @param  start       index of the first point to read
+ * @param  count       most points to read
+ * @param  fillPoints  array of count to fill with points
+ * @param  fillWeights array of count to fill with weights, 1 for an
+ *                     unweighted file, or NULL
+ *
+ * @return number of points read
+ */
+size_t PointFile::Reader::read(size_t start,
+                               size_t count,
+                               double fillPoints[][2],
+                               double fillWeights[]) const
+{
+  if (start >= _size) {
+    return 0;
+  }
+  count = std::min(count, _size - start);
+
+  if (_flags & single) {
+    readValues<float>(_data, _size, _flags, start, count, fillPoints,
+                      fillWeights);
+  } else {
+    readValues<double>(_data, _size, _flags, start, count, fillPoints,
+                       fillWeights);
+  }
+  return count;
+}
+
+/**
+ * @brief   Calculates the net cost of travelling from the points of a file to
+ *          a center
+ * @details As Center::cost, counting each point weight times
+ *
+ * @param   file points to measure distance from
+ * @param   x    center x coordinate
+ * @param   y    center y coordinate
+ *
+ * @return  net cost of travelling to the center
+ */
+double PointFile::cost(const Reader & file, double x, double y)
+{
+  Arena::Scope scratch;
+  double(*points)[2] = scratch.alloc<double[2]>(CHUNK_SIZE);
+  double * weights   = scratch.alloc<double>(CHUNK_SIZE);
+
+  double cost = 0;
+  size_t count;
+  for (size_t start = 0;
+       (count = file.read(start, CHUNK_SIZE, points, weights)) > 0;
+       start += count) {
+    cost += Center::cost(x, y, points, weights, count);
+  }
+  return cost;
+}
+
+/**
+ * @brief   Finds the center of mass of the points of a file
+ * @details The file should hold at least one point.
+ *
+ * @param   file points to measure
+ * @param   fill array to fill with center of mass
+ *
+ * @return  total weight of the points
+ */
+double PointFile::centerOfMass(const Reader & file, double fill[2])
+{
+  Arena::Scope scratch;
+  double(*points)[2] = scratch.alloc<double[2]>(CHUNK_SIZE);
+  double * weights   = scratch.alloc<double>(CHUNK_SIZE);
+
+  double center[2] = {0, 0}, totalWeight = 0;
+  size_t count;
+  for (size_t start = 0;
+       (count = file.read(start, CHUNK_SIZE, points, weights)) > 0;
+       start += count) {
+    for (size_t i = 0; i < count; ++i) {
+      center[0] += weights[i] * points[i][0];
+      center[1] += weights[i] * points[i][1];
+      totalWeight += weights[i];
+    }
+  }
+
+  fill[0] = center[0] / totalWeight;
+  fill[1] = center[1] / totalWeight;
+  return totalWeight;
+}
+
+/**
+ * @brief   Finds the geometric center of the points of a file
+ * @details As Center::geometricCenter, streaming the file once for every
+ *          cost evaluation of the search
+ *
+ * @param   file    points to find the center of
+ * @param   options specified margin of error, bound range, subsearch value
+ *                  and budgets
+ * @param   fill    array to fill with geometric center
+ * @param   stats   optional telemetry to fill about the search
+ *
+ * @return  net cost of travelling to the geometric center
+ */
+double PointFile::geometricCenter(
+    const Reader &                         file,
+    const Center::GeometricCenterOptions & options,
+    double                                 fill[2],
+    Center::GeometricCenterStats *         stats)
+{
+  const double totalWeight = centerOfMass(file, fill);
+  return Center::geometricCenter(fileCost, &file, totalWeight, options, fill,
+                                 stats);
+}
+
+/**
+ * @brief   Calculates the net earthly distance from the Latitude/Longitude
+ *          points of a file to a center
+ * @details As Cartesian::fillDistances, counting each point weight times
+ *
+ * @param   file   Latitude/Longitude points, in degrees
+ * @param   center Latitude/Longitude center, in degrees
+ * @param   unit   type of unit to use, as for Cartesian::haversine
+ * @param   mode   formula to measure distance with
+ *
+ * @return  net distance to the center
+ */
+double PointFile::sumDistances(const Reader &          file,
+                               const double            center[2],
+                               char                    unit,
+                               Cartesian::DistanceMode mode)
+{
+  Arena::Scope scratch;
+  double(*points)[2] = scratch.alloc<double[2]>(CHUNK_SIZE);
+  double * weights   = scratch.alloc<double>(CHUNK_SIZE);
+  double * distances = scratch.alloc<double>(CHUNK_SIZE);
+
+  double total = 0;
+  size_t count;
+  for (size_t start = 0;
+       (count = file.read(start, CHUNK_SIZE, points, weights)) > 0;
+       start += count) {
+    Cartesian::fillDistances(points, count, center, unit, distances, mode);
+    for (size_t i = 0; i < count; ++i) {
+      total += weights[i] * distances[i];
+    }
+  }
+  return total;
+}
+
+/**
+ * @brief   Calculates the best-fit polynomial function of the points of a file
+ * @details As Polynomial::fillBestFit, accumulating the sigma values chunk by
+ *          chunk. Weights are not applied; each point counts once.
+ *
+ * @param   file             points to fit
+ * @param   polynomialDegree degree of polynomial function to approximate
+ * @param   fill             array to fill with polynomial coefficients
+ */
+void PointFile::fillBestFit(const Reader & file,
+                            size_t         polynomialDegree,
+                            double         fill[])
+{
+  const size_t lengthSigmaX = 2 * polynomialDegree + 1;
+  const size_t lengthSigmaY = polynomialDegree + 1;
+
+  Arena::Scope scratch;
+  double *     sigmaX = scratch.zeroed<double>(lengthSigmaX);
+  double *     sigmaY = scratch.zeroed<double>(lengthSigmaY);
+  double(*points)[2]  = scratch.alloc<double[2]>(CHUNK_SIZE);
+  double *     xPos   = scratch.alloc<double>(CHUNK_SIZE);
+  double *     yPos   = scratch.alloc<double>(CHUNK_SIZE);
+
+  // the sigma values are plain sums, so accumulate them chunk by chunk
+  size_t count;
+  for (size_t start = 0; (count = file.read(start, CHUNK_SIZE, points, NULL));
+       start += count) {
+    for (size_t i = 0; i < count; ++i) {
+      xPos[i] = points[i][0];
+      yPos[i] = points[i][1];
+    }
+    Polynomial::fillSigmaX(xPos, count, sigmaX, lengthSigmaX);
+    Polynomial::fillSigmaY(xPos, yPos, count, sigmaY, lengthSigmaY);
+  }
+
+  // normal matrix of shape [degree + 1][degree + 2]
+  Util::DoubleArr2D normalMatrix =
+      scratch.matrix<double>(polynomialDegree + 1, polynomialDegree + 2);
+  Polynomial::fillNormalMatrix(sigmaX, sigmaY, normalMatrix, polynomialDegree);
+  Polynomial::fillCoefficientsFromNormalMatrix(normalMatrix, fill,
+                                               polynomialDegree + 1);
+}
@@ -0,0 +1,196 @@
+#ifndef POINTFILE_H
+#define POINTFILE_H
+
+#include "cartesian.h"
+#include "center.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A compact binary format for large point sets, read by memory-mapping the
+ * file and streaming it through the engines in chunks, so that no more than
+ * a chunk of points is ever converted at once.
+ *
+ * A point file is a 24-byte header followed by the data, all little-endian:
+ *
+ * ```
+ * offset  size  field
+ *      0     4  magic, "MHPT"
+ *      4     2  version, 1
+ *      6     2  flags, a combination of PointFile::Flag
+ *      8     8  number of points
+ *     16     8  reserved, 0
+ *     24        coordinates, then one weight per point if weighted
+ * ```
+ *
+ * Coordinates are either interleaved (`x0, y0, x1, y1, ...`) or columnar
+ * (`x0, x1, ..., y0, y1, ...`), and every value is a float64, or a float32 in
+ * single precision.
+ */
+namespace PointFile
+{
+extern const char     MAGIC[4];
+extern const uint16_t VERSION;
+extern const size_t   HEADER_SIZE;
+extern const size_t   CHUNK_SIZE;
+
+/**
+ * @enum
+ * @brief The layout flags of a point file
+ *
+ * @prop  single   values are float32 rather than float64
+ * @prop  columnar coordinates are stored one column after the other rather
+ *                 than interleaved
+ * @prop  weighted a weight for each point follows the coordinates
+ */
+enum Flag { single = 1 << 0, columnar = 1 << 1, weighted = 1 << 2 };
+
+/**
+ * @class
+ * @brief   A point file mapped into memory, read-only
+ * @details Points are read out as float64 in chunks; the operating system
+ *          pages the file in as it is read and may drop the pages again, so
+ *          files much larger than memory can be streamed.
+ *
+ * ```
+ * PointFile::Reader file;
+ * if (!file.open(path)) {
+ *   fprintf(stderr, "%s\n", file.error());
+ * }
+ * PointFile::geometricCenter(file, options, center);
+ * ```
+ */
+class Reader
+{
+ public:
+  Reader();
+  ~Reader();
+
+  /**
+   * @brief  Maps a point file, closing any file mapped before
+   *
+   * @param  path path of the file
+   *
+   * @return whether the file could be mapped and has a valid header
+   */
+  bool open(const char * path);
+
+  /**
+   * @brief  Unmaps the file
+   */
+  void close();
+
+  /**
+   * @brief  Returns why the last open failed
+   */
+  const char * error() const;
+
+  /**
+   * @brief  Returns the number of points in the file
+   */
+  size_t size() const;
+
+  /**
+   * @brief  Returns the layout flags of the file
+   */
+  unsigned flags() const;
+
+  /**
+   * @brief  Reads a run of points as float64
+   *
+   * @param  start       index of the first point to read
+   * @param  count       most points to read
+   * @param  fillPoints  array of count to fill with points
+   * @param  fillWeights array of count to fill with weights, 1 for an
+   *                     unweighted file, or NULL
+   *
+   * @return number of points read
+   */
+  size_t read(size_t start,
+              size_t count,
+              double fillPoints[][2],
+              double fillWeights[]) const;
+
+ private:
+  Reader(const Reader &);
+  Reader & operator=(const Reader &);
+
+  const unsigned char * _data;
+  size_t                _bytes;
+  size_t                _size;
+  unsigned              _flags;
+  const char *          _error;
+};
+
+/**
+ * @brief   Calculates the net cost of travelling from the points of a file to
+ *          a center
+ * @details As Center::cost, counting each point weight times
+ *
+ * @param   file points to measure distance from
+ * @param   x    center x coordinate
+ * @param   y    center y coordinate
+ *
+ * @return  net cost of travelling to the center
+ */
+double cost(const Reader & file, double x, double y);
+
+/**
+ * @brief   Finds the center of mass of the points of a file
+ * @details The file should hold at least one point.
+ *
+ * @param   file points to measure
+ * @param   fill array to fill with center of mass
+ *
+ * @return  total weight of the points
+ */
+double centerOfMass(const Reader & file, double fill[2]);
+
+/**
+ * @brief   Finds the geometric center of the points of a file
+ * @details As Center::geometricCenter, streaming the file once for every
+ *          cost evaluation of the search
+ *
+ * @param   file    points to find the center of
+ * @param   options specified margin of error, bound range, subsearch value
+ *                  and budgets
+ * @param   fill    array to fill with geometric center
+ * @param   stats   optional telemetry to fill about the search
+ *
+ * @return  net cost of travelling to the geometric center
+ */
+double geometricCenter(const Reader &                         file,
+                       const Center::GeometricCenterOptions & options,
+                       double                                 fill[2],
+                       Center::GeometricCenterStats *         stats = NULL);
+
+/**
+ * @brief   Calculates the net earthly distance from the Latitude/Longitude
+ *          points of a file to a center
+ * @details As Cartesian::fillDistances, counting each point weight times
+ *
+ * @param   file   Latitude/Longitude points, in degrees
+ * @param   center Latitude/Longitude center, in degrees
+ * @param   unit   type of unit to use, as for Cartesian::haversine
+ * @param   mode   formula to measure distance with
+ *
+ * @return  net distance to the center
+ */
+double sumDistances(const Reader &          file,
+                    const double            center[2],
+                    char                    unit,
+                    Cartesian::DistanceMode mode = Cartesian::exact);
+
+/**
+ * @brief   Calculates the best-fit polynomial function of the points of a file
+ * @details As Polynomial::fillBestFit, accumulating the sigma values chunk by
+ *          chunk. Weights are not applied; each point counts once.
+ *
+ * @param   file             points to fit
+ * @param   polynomialDegree degree of polynomial function to approximate
+ * @param   fill             array to fill with polynomial coefficients
+ */
+void fillBestFit(const Reader & file, size_t polynomialDegree, double fill[]);
+}  // namespace PointFile
+
+#endif
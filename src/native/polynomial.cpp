@@ -1,4 +1,5 @@
 #include "polynomial.h"
+#include "arena.h"
 #include "util.h"
 #include <algorithm>
 #include <cmath>
@@ -25,7 +26,8 @@ size_t Polynomial::guessPolynomialDegree(const double x[],
     return 0;
   }
 
-  double sortedY[length];
+  Arena::Scope scratch;
+  double *     sortedY = scratch.alloc<double>(length);
   for (size_t i = 0; i < length; ++i) {
     sortedY[i] = y[i];
   }
@@ -194,32 +196,18 @@ void Polynomial::fillBestFit(const double xPos[],
   const size_t lengthSigmaX = 2 * polynomialDegree + 1;
   const size_t lengthSigmaY = polynomialDegree + 1;
 
-  double sigmaX[lengthSigmaX];
-  for (size_t i = 0; i < lengthSigmaX; ++i) {
-    sigmaX[i] = 0;
-  }
-
-  double sigmaY[lengthSigmaY];
-  for (size_t i = 0; i < lengthSigmaY; ++i) {
-    sigmaY[i] = 0;
-  }
+  Arena::Scope scratch;
+  double *     sigmaX = scratch.zeroed<double>(lengthSigmaX);
+  double *     sigmaY = scratch.zeroed<double>(lengthSigmaY);
 
   fillSigmaX(xPos, numPoints, sigmaX, lengthSigmaX);
   fillSigmaY(xPos, yPos, numPoints, sigmaY, lengthSigmaY);
 
   // normal matrix of shape [degree + 1][degree + 2]
-  Util::DoubleArr2D normalMatrix = new Util::DoubleArr[polynomialDegree + 2];
-  for (size_t i = 0; i < polynomialDegree + 1; ++i) {
-    normalMatrix[i] = new double[polynomialDegree + 2];
-  }
+  Util::DoubleArr2D normalMatrix =
+      scratch.matrix<double>(polynomialDegree + 1, polynomialDegree + 2);
   fillNormalMatrix(sigmaX, sigmaY, normalMatrix, polynomialDegree);
 
   const size_t gaussianDegree = polynomialDegree + 1;
   fillCoefficientsFromNormalMatrix(normalMatrix, fill, gaussianDegree);
-
-  // free memory
-  for (size_t i = 0; i < polynomialDegree + 1; ++i) {
-    delete[] normalMatrix[i];
-  }
-  delete[] normalMatrix;
 }
@@ -0,0 +1,948 @@
+#include "spatial.h"
+#include "arena.h"
+#include "cartesian.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+const size_t Spatial::NONE     = std::numeric_limits<size_t>::max();
+const size_t Spatial::MAX_DIMS = 3;
+const double Spatial::BALANCE  = 0.7;
+
+namespace
+{
+/**
+ * @brief  Points at which a bulk build lays its nodes out along a Hilbert
+ *         curve, so that nodes near on the plane are near in memory
+ */
+const size_t HILBERT_BUILD = 4096;
+
+/**
+ * @struct
+ * @brief  A subtree left to search, with a lower bound on the squared
+ *         distance from the query to any of its points
+ *
+ * @prop   slot   slot of the subtree's root
+ * @prop   bound  sum of the squared offsets
+ * @prop   offset distance along each axis from the query to the subtree's
+ *                cell, or 0 where the query lies within it
+ */
+struct Pending {
+  size_t slot;
+  double bound;
+  double offset[3];
+};
+
+/**
+ * @brief  Queues the children of a node, nearer child on top
+ * @details The farther child's cell lies beyond the node's split, so its
+ *          offset along the split axis grows to the query's distance from it.
+ *
+ * @param  parent subtree whose root is being split
+ * @param  axis   axis of the split
+ * @param  diff   query coordinate less the split, along the axis
+ * @param  left   slot of the left child, or NONE
+ * @param  right  slot of the right child, or NONE
+ * @param  stack  subtrees left to search
+ */
+void descend(const Pending &        parent,
+             size_t                 axis,
+             double                 diff,
+             size_t                 left,
+             size_t                 right,
+             std::vector<Pending> & stack)
+{
+  const size_t near = diff < 0 ? left : right;
+  const size_t far  = diff < 0 ? right : left;
+
+  if (far != Spatial::NONE) {
+    Pending next = parent;
+    next.slot    = far;
+    next.bound += diff * diff - parent.offset[axis] * parent.offset[axis];
+    next.offset[axis] = diff;
+    stack.push_back(next);
+  }
+  if (near != Spatial::NONE) {
+    Pending next = parent;
+    next.slot    = near;
+    stack.push_back(next);
+  }
+}
+
+/**
+ * @brief  Orders neighbors nearest first
+ */
+bool nearer(const Spatial::Neighbor & a, const Spatial::Neighbor & b)
+{
+  return a.distance < b.distance;
+}
+
+/**
+ * @brief  Returns the radius of the earth in kilometers
+ */
+double earthRadiusKm()
+{
+  return Cartesian::EARTH_RADIUS_METERS * Cartesian::METER_TO_KM;
+}
+
+/**
+ * @brief  Converts a straight-line distance through the earth to a distance
+ *         along its surface, in kilometers
+ */
+double arcFromChord(double chord)
+{
+  const double r = earthRadiusKm();
+  return 2 * r * std::asin(std::min(1.0, chord / (2 * r)));
+}
+
+/**
+ * @brief  Returns the smallest and largest products of values from two ranges
+ */
+void productRange(const double a[2], const double b[2], double fill[2])
+{
+  const double products[] = {a[0] * b[0], a[0] * b[1], a[1] * b[0],
+                             a[1] * b[1]};
+  fill[0] = *std::min_element(products, products + 4);
+  fill[1] = *std::max_element(products, products + 4);
+}
+
+/**
+ * @brief  Spreads the low 16 bits of a value to the even bits
+ */
+inline uint32_t spreadBits(uint32_t v)
+{
+  v = (v | (v << 8)) & 0x00FF00FF;
+  v = (v | (v << 4)) & 0x0F0F0F0F;
+  v = (v | (v << 2)) & 0x33333333;
+  v = (v | (v << 1)) & 0x55555555;
+  return v;
+}
+
+/**
+ * @brief   Returns the index of a cell of a 65536 x 65536 grid along a
+ *          Hilbert curve
+ * @details Works out the orientation of the curve at every level at once,
+ *          as a prefix scan of the quadrant transforms over the bits of the
+ *          cell, in four doubling rounds, then reads off the index bits.
+ *
+ * @param   x column of the cell
+ * @param   y row of the cell
+ *
+ * @return  index of the cell along the curve
+ */
+inline uint32_t hilbertIndex(uint32_t x, uint32_t y)
+{
+  const uint32_t MASK = 0xFFFF;
+  uint32_t       A, B, C, D;
+
+  // transforms of each single level
+  {
+    const uint32_t a = x ^ y;
+    const uint32_t b = MASK ^ a;
+    const uint32_t c = MASK ^ (x | y);
+    const uint32_t d = x & (y ^ MASK);
+
+    A = a | (b >> 1);
+    B = (a >> 1) ^ a;
+    C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+    D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+  }
+
+  // compose them over 2, 4 and 8 levels
+  for (uint32_t shift = 2; shift <= 4; shift *= 2) {
+    const uint32_t a = A, b = B, c = C, d = D;
+
+    A = (a & (a >> shift)) ^ (b & (b >> shift));
+    B = (a & (b >> shift)) ^ (b & ((a ^ b) >> shift));
+    C ^= (a & (c >> shift)) ^ (b & (d >> shift));
+    D ^= (b & (c >> shift)) ^ ((a ^ b) & (d >> shift));
+  }
+  {
+    const uint32_t a = A, b = B, c = C, d = D;
+
+    C ^= (a & (c >> 8)) ^ (b & (d >> 8));
+    D ^= (b & (c >> 8)) ^ ((a ^ b) & (d >> 8));
+  }
+
+  const uint32_t a  = C ^ (C >> 1);
+  const uint32_t b  = D ^ (D >> 1);
+  const uint32_t i0 = x ^ y;
+  const uint32_t i1 = b | (MASK ^ (i0 | a));
+  return (spreadBits(i1) << 1) | spreadBits(i0);
+}
+}  // namespace
+
+/**
+ * @param  dims number of coordinates of each point, 2 or 3
+ */
+Spatial::KDTree::KDTree(size_t dims)
+    : _dims(std::min(dims, MAX_DIMS)), root(NONE), live(0), dead(0)
+{
+}
+
+/**
+ * @brief  Returns the number of coordinates of each point
+ */
+size_t Spatial::KDTree::dims() const
+{
+  return _dims;
+}
+
+/**
+ * @brief  Returns the number of points in the tree
+ */
+size_t Spatial::KDTree::size() const
+{
+  return live;
+}
+
+/**
+ * @brief   Replaces the contents of the tree with a set of points
+ * @details Large 2D trees lay their nodes out in memory in Hilbert order.
+ *
+ * @param   points    interleaved coordinates of the points
+ * @param   numPoints number of points; point i gets id i
+ */
+void Spatial::KDTree::build(const double * points, size_t numPoints)
+{
+  nodes.clear();
+  nodes.reserve(numPoints);
+  nodeOf.assign(numPoints, NONE);
+  freeSlots.clear();
+  live = dead = 0;
+
+  // lay large planar trees out along a Hilbert curve, so that the nodes a
+  // query visits share cache lines
+  std::vector<size_t> order(numPoints);
+  if (_dims == 2 && numPoints >= HILBERT_BUILD) {
+    fillHilbertOrder(points, _dims, numPoints, order.data());
+  } else {
+    for (size_t i = 0; i < numPoints; ++i) {
+      order[i] = i;
+    }
+  }
+
+  std::vector<size_t> slots(numPoints);
+  for (size_t i = 0; i < numPoints; ++i) {
+    slots[i] = allocNode(order[i], points + order[i] * _dims);
+  }
+  root = relink(slots.data(), numPoints, 0);
+}
+
+/**
+ * @brief  Inserts a point, replacing any point with the same id
+ *
+ * @param  id    id of the point
+ * @param  point coordinates of the point
+ */
+void Spatial::KDTree::insert(size_t id, const double * point)
+{
+  remove(id);
+  const size_t slot = allocNode(id, point);
+  if (root == NONE) {
+    root = slot;
+    return;
+  }
+
+  // descend to an empty leaf, counting the new point in every subtree on the
+  // way down
+  std::vector<size_t> path;
+  size_t              cur = root;
+  for (;;) {
+    path.push_back(cur);
+    Node & node = nodes[cur];
+    ++node.size;
+    size_t & child =
+        point[node.axis] < node.point[node.axis] ? node.left : node.right;
+    if (child == NONE) {
+      child = slot;
+      break;
+    }
+    cur = child;
+  }
+  nodes[slot].axis = path.size() % _dims;
+
+  // too deep for a balanced tree, so rebuild the highest subtree on the path
+  // that has grown lopsided
+  const double maxDepth =
+      std::log(static_cast<double>(nodes[root].size)) / -std::log(BALANCE);
+  if (path.size() <= maxDepth + 1) {
+    return;
+  }
+  for (size_t i = 0; i < path.size(); ++i) {
+    const size_t child = i + 1 < path.size() ? path[i + 1] : slot;
+    if (nodes[child].size > BALANCE * nodes[path[i]].size) {
+      size_t * link = &root;
+      if (i > 0) {
+        Node & parent = nodes[path[i - 1]];
+        link          = parent.left == path[i] ? &parent.left : &parent.right;
+      }
+      rebuild(link, i, false);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief  Removes a point
+ *
+ * @param  id id of the point
+ *
+ * @return whether the point was in the tree
+ */
+bool Spatial::KDTree::remove(size_t id)
+{
+  if (id >= nodeOf.size() || nodeOf[id] == NONE) {
+    return false;
+  }
+
+  nodes[nodeOf[id]].dead = true;
+  nodeOf[id]             = NONE;
+  --live;
+  ++dead;
+
+  // tombstones slow every query down, so sweep them once they are the
+  // majority
+  if (dead > live) {
+    rebuild(&root, 0, true);
+  }
+  return true;
+}
+
+/**
+ * @brief  Gives a point a new id, replacing any point already holding it
+ *
+ * @param  from id of the point
+ * @param  to   new id of the point
+ *
+ * @return whether the point was in the tree
+ */
+bool Spatial::KDTree::relabel(size_t from, size_t to)
+{
+  if (from >= nodeOf.size() || nodeOf[from] == NONE) {
+    return false;
+  }
+  if (from == to) {
+    return true;
+  }
+
+  const size_t slot = nodeOf[from];
+  remove(to);
+  if (to >= nodeOf.size()) {
+    nodeOf.resize(to + 1, NONE);
+  }
+  nodes[slot].id = to;
+  nodeOf[to]     = slot;
+  nodeOf[from]   = NONE;
+  return true;
+}
+
+/**
+ * @brief  Returns the coordinates of a point
+ *
+ * @param  id id of the point
+ *
+ * @return coordinates of the point, or NULL if it is not in the tree
+ */
+const double * Spatial::KDTree::point(size_t id) const
+{
+  if (id >= nodeOf.size() || nodeOf[id] == NONE) {
+    return NULL;
+  }
+  return nodes[nodeOf[id]].point;
+}
+
+/**
+ * @brief  Finds the points closest to a query point
+ *
+ * @param  query coordinates of the query point
+ * @param  k     most points to find
+ * @param  fill  vector to fill with the points, nearest first
+ */
+void Spatial::KDTree::nearest(const double *          query,
+                              size_t                  k,
+                              std::vector<Neighbor> & fill) const
+{
+  fill.clear();
+  if (k == 0 || root == NONE) {
+    return;
+  }
+
+  // fill is kept as a max-heap of squared distances, so its front is the
+  // farthest point found so far; each pending subtree carries a lower bound
+  // on its squared distance from the query
+  const Pending        start = {root, 0, {0, 0, 0}};
+  std::vector<Pending> stack(1, start);
+  while (!stack.empty()) {
+    const Pending pending = stack.back();
+    stack.pop_back();
+    if (fill.size() == k && pending.bound >= fill.front().distance) {
+      continue;
+    }
+
+    const Node & node = nodes[pending.slot];
+    if (!node.dead) {
+      const Neighbor found = {node.id, distance2(node, query)};
+      if (fill.size() < k) {
+        fill.push_back(found);
+        std::push_heap(fill.begin(), fill.end(), nearer);
+      } else if (found.distance < fill.front().distance) {
+        std::pop_heap(fill.begin(), fill.end(), nearer);
+        fill.back() = found;
+        std::push_heap(fill.begin(), fill.end(), nearer);
+      }
+    }
+
+    const double diff = query[node.axis] - node.point[node.axis];
+    descend(pending, node.axis, diff, node.left, node.right, stack);
+  }
+
+  std::sort_heap(fill.begin(), fill.end(), nearer);
+  for (size_t i = 0; i < fill.size(); ++i) {
+    fill[i].distance = std::sqrt(fill[i].distance);
+  }
+}
+
+/**
+ * @brief  Finds the points within a distance of a query point
+ *
+ * @param  query  coordinates of the query point
+ * @param  radius greatest distance from the query point
+ * @param  fill   vector to fill with the points, nearest first
+ */
+void Spatial::KDTree::within(const double *          query,
+                             double                  radius,
+                             std::vector<Neighbor> & fill) const
+{
+  fill.clear();
+  if (root == NONE || radius < 0) {
+    return;
+  }
+
+  const double         radius2 = radius * radius;
+  const Pending        start   = {root, 0, {0, 0, 0}};
+  std::vector<Pending> stack(1, start);
+  while (!stack.empty()) {
+    const Pending pending = stack.back();
+    stack.pop_back();
+    if (pending.bound > radius2) {
+      continue;
+    }
+
+    const Node & node = nodes[pending.slot];
+    if (!node.dead) {
+      const Neighbor found = {node.id, distance2(node, query)};
+      if (found.distance <= radius2) {
+        fill.push_back(found);
+      }
+    }
+
+    const double diff = query[node.axis] - node.point[node.axis];
+    descend(pending, node.axis, diff, node.left, node.right, stack);
+  }
+
+  std::sort(fill.begin(), fill.end(), nearer);
+  for (size_t i = 0; i < fill.size(); ++i) {
+    fill[i].distance = std::sqrt(fill[i].distance);
+  }
+}
+
+/**
+ * @brief  Finds the points inside an axis-aligned box, bounds included
+ *
+ * @param  lo   lowest coordinates of the box
+ * @param  hi   highest coordinates of the box
+ * @param  fill vector to append the ids of the points to
+ */
+void Spatial::KDTree::inBox(const double *        lo,
+                            const double *        hi,
+                            std::vector<size_t> & fill) const
+{
+  if (root == NONE) {
+    return;
+  }
+
+  std::vector<size_t> stack(1, root);
+  while (!stack.empty()) {
+    const Node & node = nodes[stack.back()];
+    stack.pop_back();
+
+    bool inside = !node.dead;
+    for (size_t d = 0; inside && d < _dims; ++d) {
+      inside = lo[d] <= node.point[d] && node.point[d] <= hi[d];
+    }
+    if (inside) {
+      fill.push_back(node.id);
+    }
+
+    const size_t axis = node.axis;
+    if (node.left != NONE && lo[axis] <= node.point[axis]) {
+      stack.push_back(node.left);
+    }
+    if (node.right != NONE && hi[axis] >= node.point[axis]) {
+      stack.push_back(node.right);
+    }
+  }
+}
+
+/**
+ * @brief  Returns the squared distance between a node and a query point
+ */
+double Spatial::KDTree::distance2(const Node & node, const double * query) const
+{
+  double sum = 0;
+  for (size_t d = 0; d < _dims; ++d) {
+    const double diff = query[d] - node.point[d];
+    sum += diff * diff;
+  }
+  return sum;
+}
+
+/**
+ * @brief  Stores a point in a free node, without linking it into the tree
+ *
+ * @param  id    id of the point
+ * @param  point coordinates of the point
+ *
+ * @return slot of the node
+ */
+size_t Spatial::KDTree::allocNode(size_t id, const double * point)
+{
+  size_t slot;
+  if (freeSlots.empty()) {
+    slot = nodes.size();
+    nodes.push_back(Node());
+  } else {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+  }
+
+  Node & node = nodes[slot];
+  for (size_t d = 0; d < MAX_DIMS; ++d) {
+    node.point[d] = d < _dims ? point[d] : 0;
+  }
+  node.id    = id;
+  node.left  = NONE;
+  node.right = NONE;
+  node.size  = 1;
+  node.axis  = 0;
+  node.dead  = false;
+
+  if (id >= nodeOf.size()) {
+    nodeOf.resize(id + 1, NONE);
+  }
+  nodeOf[id] = slot;
+  ++live;
+  return slot;
+}
+
+/**
+ * @brief   Links a set of nodes into a balanced subtree
+ * @details Splits at the median along an axis that cycles with depth, so
+ *          nodes left of a split are no greater, and nodes right of it no
+ *          less, than the split on its axis.
+ *
+ * @param   slots slots of the nodes, reordered in place
+ * @param   count number of nodes
+ * @param   depth depth of the subtree's root in the tree
+ *
+ * @return  slot of the subtree's root, or NONE if it is empty
+ */
+size_t Spatial::KDTree::relink(size_t * slots, size_t count, size_t depth)
+{
+  if (count == 0) {
+    return NONE;
+  }
+
+  const size_t axis = depth % _dims;
+  const size_t mid  = count / 2;
+  std::nth_element(slots, slots + mid, slots + count,
+                   [this, axis](size_t a, size_t b) {
+                     return nodes[a].point[axis] < nodes[b].point[axis];
+                   });
+
+  const size_t slot = slots[mid];
+  const size_t left = relink(slots, mid, depth + 1);
+  const size_t right =
+      relink(slots + mid + 1, count - mid - 1, depth + 1);
+
+  Node & node = nodes[slot];
+  node.axis   = axis;
+  node.left   = left;
+  node.right  = right;
+  node.size   = count;
+  return slot;
+}
+
+/**
+ * @brief  Rebalances a subtree
+ *
+ * @param  link      link to the subtree's root, in its parent or the tree
+ * @param  depth     depth of the subtree's root in the tree
+ * @param  sweepDead whether to free tombstoned nodes, which is only valid for
+ *                   the whole tree since it changes the size of the subtree
+ */
+void Spatial::KDTree::rebuild(size_t * link, size_t depth, bool sweepDead)
+{
+  std::vector<size_t> slots;
+  std::vector<size_t> stack;
+  if (*link != NONE) {
+    stack.push_back(*link);
+  }
+  while (!stack.empty()) {
+    const size_t slot = stack.back();
+    stack.pop_back();
+
+    const Node & node = nodes[slot];
+    if (node.left != NONE) {
+      stack.push_back(node.left);
+    }
+    if (node.right != NONE) {
+      stack.push_back(node.right);
+    }
+    if (node.dead && sweepDead) {
+      freeSlots.push_back(slot);
+      --dead;
+    } else {
+      slots.push_back(slot);
+    }
+  }
+
+  *link = relink(slots.data(), slots.size(), depth);
+}
+
+/**
+ * @brief   Finds the position of each point along a Hilbert curve over the
+ *          bounding box of the points
+ * @details Snaps the first two coordinates of each point to a square grid of
+ *          65536 x 65536 cells over the bounding box, and maps each cell to
+ *          its index along the curve with bitwise prefix scans rather than
+ *          branches, so that the pass vectorizes. Points close along the
+ *          curve are close on the plane.
+ *
+ * @param   points    interleaved coordinates of the points
+ * @param   dims      number of coordinates of each point, at least 2
+ * @param   numPoints number of points
+ * @param   fill      array to fill with the key of each point
+ */
+void Spatial::fillHilbertKeys(const double * points,
+                              size_t         dims,
+                              size_t         numPoints,
+                              uint32_t       fill[])
+{
+  if (!numPoints) {
+    return;
+  }
+
+  double lo[2] = {points[0], points[1]};
+  double hi[2] = {points[0], points[1]};
+  for (size_t i = 1; i < numPoints; ++i) {
+    const double * point = points + i * dims;
+    lo[0] = std::min(lo[0], point[0]), hi[0] = std::max(hi[0], point[0]);
+    lo[1] = std::min(lo[1], point[1]), hi[1] = std::max(hi[1], point[1]);
+  }
+
+  // square cells, so that the curve keeps to the shape of the points
+  const double span  = std::max(hi[0] - lo[0], hi[1] - lo[1]);
+  const double scale = span > 0 ? 65535 / span : 0;
+  for (size_t i = 0; i < numPoints; ++i) {
+    const double * point = points + i * dims;
+    const uint32_t x     = (uint32_t)((point[0] - lo[0]) * scale);
+    const uint32_t y     = (uint32_t)((point[1] - lo[1]) * scale);
+    fill[i]              = hilbertIndex(x, y);
+  }
+}
+
+/**
+ * @brief   Orders points along a Hilbert curve over their bounding box
+ * @details Radix sorts the points by their Hilbert keys in O(n) time, keeping
+ *          points of the same cell in their original order.
+ *
+ * @param   points    interleaved coordinates of the points
+ * @param   dims      number of coordinates of each point, at least 2
+ * @param   numPoints number of points
+ * @param   fill      array to fill with the index of each point in the
+ *                    original order, in the order along the curve
+ */
+void Spatial::fillHilbertOrder(const double * points,
+                               size_t         dims,
+                               size_t         numPoints,
+                               size_t         fill[])
+{
+  const size_t RADIX = 256;
+
+  Arena::Scope scratch;
+  uint32_t *   keys     = scratch.alloc<uint32_t>(numPoints);
+  uint32_t *   nextKeys = scratch.alloc<uint32_t>(numPoints);
+  size_t *     order    = fill;
+  size_t *     next     = scratch.alloc<size_t>(numPoints);
+  fillHilbertKeys(points, dims, numPoints, keys);
+  for (size_t i = 0; i < numPoints; ++i) {
+    order[i] = i;
+  }
+
+  // least significant byte first, skipping bytes every key shares
+  for (uint32_t shift = 0; shift < 32; shift += 8) {
+    size_t counts[RADIX] = {0};
+    for (size_t i = 0; i < numPoints; ++i) {
+      ++counts[(keys[i] >> shift) & (RADIX - 1)];
+    }
+    if (numPoints && counts[(keys[0] >> shift) & (RADIX - 1)] == numPoints) {
+      continue;
+    }
+
+    size_t offset = 0;
+    for (size_t digit = 0; digit < RADIX; ++digit) {
+      const size_t count = counts[digit];
+      counts[digit]      = offset;
+      offset += count;
+    }
+    for (size_t i = 0; i < numPoints; ++i) {
+      const size_t slot = counts[(keys[i] >> shift) & (RADIX - 1)]++;
+      nextKeys[slot]    = keys[i];
+      next[slot]        = order[i];
+    }
+    std::swap(keys, nextKeys);
+    std::swap(order, next);
+  }
+
+  if (order != fill) {
+    std::copy(order, order + numPoints, fill);
+  }
+}
+
+Spatial::GeoIndex::GeoIndex() : tree(3)
+{
+}
+
+/**
+ * @brief  Returns the number of points in the index
+ */
+size_t Spatial::GeoIndex::size() const
+{
+  return tree.size();
+}
+
+/**
+ * @brief  Replaces the contents of the index with a set of points
+ *
+ * @param  points    Latitude/Longitude points, in degrees
+ * @param  numPoints number of points; point i gets id i
+ */
+void Spatial::GeoIndex::build(const double points[][2], size_t numPoints)
+{
+  std::vector<double> ecef(3 * numPoints);
+  for (size_t i = 0; i < numPoints; ++i) {
+    toECEF(points[i], &ecef[3 * i]);
+  }
+  tree.build(ecef.data(), numPoints);
+  coords.assign(2 * numPoints, 0);
+  for (size_t i = 0; i < numPoints; ++i) {
+    coords[2 * i]     = points[i][0];
+    coords[2 * i + 1] = points[i][1];
+  }
+}
+
+/**
+ * @brief  Inserts a point, replacing any point with the same id
+ *
+ * @param  id    id of the point
+ * @param  point Latitude/Longitude of the point, in degrees
+ */
+void Spatial::GeoIndex::insert(size_t id, const double point[2])
+{
+  double ecef[3];
+  toECEF(point, ecef);
+  tree.insert(id, ecef);
+
+  if (2 * id + 2 > coords.size()) {
+    coords.resize(2 * id + 2);
+  }
+  coords[2 * id]     = point[0];
+  coords[2 * id + 1] = point[1];
+}
+
+/**
+ * @brief  Removes a point
+ *
+ * @param  id id of the point
+ *
+ * @return whether the point was in the index
+ */
+bool Spatial::GeoIndex::remove(size_t id)
+{
+  return tree.remove(id);
+}
+
+/**
+ * @brief  Gives a point a new id, replacing any point already holding it
+ *
+ * @param  from id of the point
+ * @param  to   new id of the point
+ *
+ * @return whether the point was in the index
+ */
+bool Spatial::GeoIndex::relabel(size_t from, size_t to)
+{
+  if (!tree.relabel(from, to)) {
+    return false;
+  }
+
+  if (2 * to + 2 > coords.size()) {
+    coords.resize(2 * to + 2);
+  }
+  coords[2 * to]     = coords[2 * from];
+  coords[2 * to + 1] = coords[2 * from + 1];
+  return true;
+}
+
+/**
+ * @brief  Finds the points closest to a query point
+ *
+ * @param  query Latitude/Longitude of the query point, in degrees
+ * @param  k     most points to find
+ * @param  fill  vector to fill with the points, nearest first
+ */
+void Spatial::GeoIndex::nearest(const double            query[2],
+                                size_t                  k,
+                                std::vector<Neighbor> & fill) const
+{
+  double ecef[3];
+  toECEF(query, ecef);
+  tree.nearest(ecef, k, fill);
+  for (size_t i = 0; i < fill.size(); ++i) {
+    fill[i].distance = arcFromChord(fill[i].distance);
+  }
+}
+
+/**
+ * @brief  Finds the points within a distance of a query point
+ *
+ * @param  query  Latitude/Longitude of the query point, in degrees
+ * @param  radius greatest distance from the query point, in kilometers
+ * @param  fill   vector to fill with the points, nearest first
+ */
+void Spatial::GeoIndex::within(const double            query[2],
+                               double                  radius,
+                               std::vector<Neighbor> & fill) const
+{
+  const double r = earthRadiusKm();
+
+  // search the chord subtending the radius, slightly widened against
+  // rounding, then trim by distance along the surface
+  const double angle =
+      std::min(radius / (2 * r), static_cast<double>(Cartesian::PI) / 2);
+  const double chord = 2 * r * std::sin(angle) * (1 + 1e-9);
+
+  double ecef[3];
+  toECEF(query, ecef);
+  tree.within(ecef, chord, fill);
+
+  size_t kept = 0;
+  for (size_t i = 0; i < fill.size(); ++i) {
+    fill[i].distance = arcFromChord(fill[i].distance);
+    if (fill[i].distance <= radius) {
+      fill[kept++] = fill[i];
+    }
+  }
+  fill.resize(kept);
+}
+
+/**
+ * @brief  Finds the points inside a Latitude/Longitude box, bounds included
+ * @details A box whose western bound is east of its eastern bound crosses
+ *          the antimeridian.
+ *
+ * @param  lo   south-west corner of the box, in degrees
+ * @param  hi   north-east corner of the box, in degrees
+ * @param  fill vector to append the ids of the points to
+ */
+void Spatial::GeoIndex::inBox(const double          lo[2],
+                              const double          hi[2],
+                              std::vector<size_t> & fill) const
+{
+  if (lo[1] <= hi[1]) {
+    inLngRange(lo, hi, fill);
+    return;
+  }
+
+  const double east[2] = {hi[0], 180};
+  const double west[2] = {lo[0], -180};
+  inLngRange(lo, east, fill);
+  inLngRange(west, hi, fill);
+}
+
+/**
+ * @brief  Converts a Latitude/Longitude point to earth-centered Cartesian
+ *         coordinates
+ *
+ * @param  point Latitude/Longitude of the point, in degrees
+ * @param  fill  array to fill with coordinates, in kilometers
+ */
+void Spatial::GeoIndex::toECEF(const double point[2], double fill[3])
+{
+  const double r      = earthRadiusKm();
+  const double lat    = Cartesian::radiansFromDeg(point[0]);
+  const double lng    = Cartesian::radiansFromDeg(point[1]);
+  const double cosLat = std::cos(lat);
+
+  fill[0] = r * cosLat * std::cos(lng);
+  fill[1] = r * cosLat * std::sin(lng);
+  fill[2] = r * std::sin(lat);
+}
+
+/**
+ * @brief   Finds the points inside a Latitude/Longitude box that does not
+ *          cross the antimeridian
+ * @details Queries the tree with the Cartesian bounds of the box's patch of
+ *          the earth, then trims the candidates by Latitude/Longitude.
+ */
+void Spatial::GeoIndex::inLngRange(const double          lo[2],
+                                   const double          hi[2],
+                                   std::vector<size_t> & fill) const
+{
+  const double r       = earthRadiusKm();
+  const double PI      = Cartesian::PI;
+  const double latLo   = Cartesian::radiansFromDeg(std::max(lo[0], -90.0));
+  const double latHi   = Cartesian::radiansFromDeg(std::min(hi[0], 90.0));
+  const double lngLo   = Cartesian::radiansFromDeg(lo[1]);
+  const double lngHi   = Cartesian::radiansFromDeg(hi[1]);
+  const bool   equator = latLo <= 0 && 0 <= latHi;
+
+  // ranges of cos(lat), cos(lng) and sin(lng) over the box; cos(lng) is least
+  // at an end of any range of longitudes within [-180, 180]
+  const double cosLat[2] = {std::min(std::cos(latLo), std::cos(latHi)),
+                            equator ? 1 : std::max(std::cos(latLo),
+                                                   std::cos(latHi))};
+  const double cosLng[2] = {
+      std::min(std::cos(lngLo), std::cos(lngHi)),
+      lngLo <= 0 && 0 <= lngHi ? 1
+                               : std::max(std::cos(lngLo), std::cos(lngHi))};
+  const double sinLng[2] = {
+      lngLo <= -PI / 2 && -PI / 2 <= lngHi
+          ? -1
+          : std::min(std::sin(lngLo), std::sin(lngHi)),
+      lngLo <= PI / 2 && PI / 2 <= lngHi
+          ? 1
+          : std::max(std::sin(lngLo), std::sin(lngHi))};
+
+  double x[2], y[2];
+  productRange(cosLat, cosLng, x);
+  productRange(cosLat, sinLng, y);
+
+  const double pad      = r * 1e-9;
+  const double boxLo[3] = {r * x[0] - pad, r * y[0] - pad,
+                           r * std::sin(latLo) - pad};
+  const double boxHi[3] = {r * x[1] + pad, r * y[1] + pad,
+                           r * std::sin(latHi) + pad};
+
+  std::vector<size_t> candidates;
+  tree.inBox(boxLo, boxHi, candidates);
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const double * point = &coords[2 * candidates[i]];
+    if (lo[0] <= point[0] && point[0] <= hi[0] && lo[1] <= point[1] &&
+        point[1] <= hi[1]) {
+      fill.push_back(candidates[i]);
+    }
+  }
+}
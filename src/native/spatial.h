@@ -0,0 +1,306 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Spatial
+{
+extern const size_t NONE;
+extern const size_t MAX_DIMS;
+extern const double BALANCE;
+
+/**
+ * @struct
+ * @brief  A point found by a query, with its distance from the query point
+ *
+ * @prop   id       id the point was inserted under
+ * @prop   distance distance from the query point
+ */
+struct Neighbor {
+  size_t id;
+  double distance;
+};
+
+/**
+ * @class
+ * @brief   k-d tree over 2D or 3D points, addressed by caller-chosen ids
+ * @details Bulk builds split at the median of each axis in O(n log n).
+ *          Inserts keep the tree balanced by rebuilding the highest subtree
+ *          that became lopsided (as in a scapegoat tree), and removals leave
+ *          tombstones until they outnumber the live points, so both are
+ *          O(log n) amortized.
+ *
+ * ```
+ * Spatial::KDTree tree(2);
+ * tree.build(points[0], numPoints);
+ * std::vector<Spatial::Neighbor> nearest;
+ * tree.nearest(center, 5, nearest);
+ * ```
+ */
+class KDTree
+{
+ public:
+  /**
+   * @param  dims number of coordinates of each point, 2 or 3
+   */
+  explicit KDTree(size_t dims);
+
+  /**
+   * @brief  Returns the number of coordinates of each point
+   */
+  size_t dims() const;
+
+  /**
+   * @brief  Returns the number of points in the tree
+   */
+  size_t size() const;
+
+  /**
+   * @brief   Replaces the contents of the tree with a set of points
+   * @details Large 2D trees lay their nodes out in memory in Hilbert order.
+   *
+   * @param   points    interleaved coordinates of the points
+   * @param   numPoints number of points; point i gets id i
+   */
+  void build(const double * points, size_t numPoints);
+
+  /**
+   * @brief  Inserts a point, replacing any point with the same id
+   *
+   * @param  id    id of the point
+   * @param  point coordinates of the point
+   */
+  void insert(size_t id, const double * point);
+
+  /**
+   * @brief  Removes a point
+   *
+   * @param  id id of the point
+   *
+   * @return whether the point was in the tree
+   */
+  bool remove(size_t id);
+
+  /**
+   * @brief  Gives a point a new id, replacing any point already holding it
+   *
+   * @param  from id of the point
+   * @param  to   new id of the point
+   *
+   * @return whether the point was in the tree
+   */
+  bool relabel(size_t from, size_t to);
+
+  /**
+   * @brief  Returns the coordinates of a point
+   *
+   * @param  id id of the point
+   *
+   * @return coordinates of the point, or NULL if it is not in the tree
+   */
+  const double * point(size_t id) const;
+
+  /**
+   * @brief  Finds the points closest to a query point
+   *
+   * @param  query coordinates of the query point
+   * @param  k     most points to find
+   * @param  fill  vector to fill with the points, nearest first
+   */
+  void nearest(const double *          query,
+               size_t                  k,
+               std::vector<Neighbor> & fill) const;
+
+  /**
+   * @brief  Finds the points within a distance of a query point
+   *
+   * @param  query  coordinates of the query point
+   * @param  radius greatest distance from the query point
+   * @param  fill   vector to fill with the points, nearest first
+   */
+  void within(const double *          query,
+              double                  radius,
+              std::vector<Neighbor> & fill) const;
+
+  /**
+   * @brief  Finds the points inside an axis-aligned box, bounds included
+   *
+   * @param  lo   lowest coordinates of the box
+   * @param  hi   highest coordinates of the box
+   * @param  fill vector to append the ids of the points to
+   */
+  void inBox(const double *        lo,
+             const double *        hi,
+             std::vector<size_t> & fill) const;
+
+ private:
+  struct Node {
+    double point[3];
+    size_t id;
+    size_t left;
+    size_t right;
+    size_t size;
+    size_t axis;
+    bool   dead;
+  };
+
+  double distance2(const Node & node, const double * query) const;
+  size_t allocNode(size_t id, const double * point);
+  size_t relink(size_t * slots, size_t count, size_t depth);
+  void   rebuild(size_t * link, size_t depth, bool sweepDead);
+
+  const size_t        _dims;
+  std::vector<Node>   nodes;
+  std::vector<size_t> nodeOf;
+  std::vector<size_t> freeSlots;
+  size_t              root;
+  size_t              live;
+  size_t              dead;
+};
+
+/**
+ * @brief   Finds the position of each point along a Hilbert curve over the
+ *          bounding box of the points
+ * @details Snaps the first two coordinates of each point to a square grid of
+ *          65536 x 65536 cells over the bounding box, and maps each cell to
+ *          its index along the curve with bitwise prefix scans rather than
+ *          branches, so that the pass vectorizes. Points close along the
+ *          curve are close on the plane.
+ *
+ * @param   points    interleaved coordinates of the points
+ * @param   dims      number of coordinates of each point, at least 2
+ * @param   numPoints number of points
+ * @param   fill      array to fill with the key of each point
+ */
+void fillHilbertKeys(const double * points,
+                     size_t         dims,
+                     size_t         numPoints,
+                     uint32_t       fill[]);
+
+/**
+ * @brief   Orders points along a Hilbert curve over their bounding box
+ * @details Radix sorts the points by their Hilbert keys in O(n) time, keeping
+ *          points of the same cell in their original order.
+ *
+ * @param   points    interleaved coordinates of the points
+ * @param   dims      number of coordinates of each point, at least 2
+ * @param   numPoints number of points
+ * @param   fill      array to fill with the index of each point in the
+ *                    original order, in the order along the curve
+ */
+void fillHilbertOrder(const double * points,
+                      size_t         dims,
+                      size_t         numPoints,
+                      size_t         fill[]);
+
+/**
+ * @class
+ * @brief   Spatial index over Latitude/Longitude points
+ * @details Points are indexed by their position on the earth in Cartesian
+ *          (ECEF) coordinates, where straight-line distance grows with, and so
+ *          orders points the same as, distance along the earth's surface.
+ *          Distances are in kilometers.
+ */
+class GeoIndex
+{
+ public:
+  GeoIndex();
+
+  /**
+   * @brief  Returns the number of points in the index
+   */
+  size_t size() const;
+
+  /**
+   * @brief  Replaces the contents of the index with a set of points
+   *
+   * @param  points    Latitude/Longitude points, in degrees
+   * @param  numPoints number of points; point i gets id i
+   */
+  void build(const double points[][2], size_t numPoints);
+
+  /**
+   * @brief  Inserts a point, replacing any point with the same id
+   *
+   * @param  id    id of the point
+   * @param  point Latitude/Longitude of the point, in degrees
+   */
+  void insert(size_t id, const double point[2]);
+
+  /**
+   * @brief  Removes a point
+   *
+   * @param  id id of the point
+   *
+   * @return whether the point was in the index
+   */
+  bool remove(size_t id);
+
+  /**
+   * @brief  Gives a point a new id, replacing any point already holding it
+   *
+   * @param  from id of the point
+   * @param  to   new id of the point
+   *
+   * @return whether the point was in the index
+   */
+  bool relabel(size_t from, size_t to);
+
+  /**
+   * @brief  Finds the points closest to a query point
+   *
+   * @param  query Latitude/Longitude of the query point, in degrees
+   * @param  k     most points to find
+   * @param  fill  vector to fill with the points, nearest first
+   */
+  void nearest(const double            query[2],
+               size_t                  k,
+               std::vector<Neighbor> & fill) const;
+
+  /**
+   * @brief  Finds the points within a distance of a query point
+   *
+   * @param  query  Latitude/Longitude of the query point, in degrees
+   * @param  radius greatest distance from the query point, in kilometers
+   * @param  fill   vector to fill with the points, nearest first
+   */
+  void within(const double            query[2],
+              double                  radius,
+              std::vector<Neighbor> & fill) const;
+
+  /**
+   * @brief  Finds the points inside a Latitude/Longitude box, bounds included
+   * @details A box whose western bound is east of its eastern bound crosses
+   *          the antimeridian.
+   *
+   * @param  lo   south-west corner of the box, in degrees
+   * @param  hi   north-east corner of the box, in degrees
+   * @param  fill vector to append the ids of the points to
+   */
+  void inBox(const double          lo[2],
+             const double          hi[2],
+             std::vector<size_t> & fill) const;
+
+  /**
+   * @brief  Converts a Latitude/Longitude point to earth-centered Cartesian
+   *         coordinates
+   *
+   * @param  point Latitude/Longitude of the point, in degrees
+   * @param  fill  array to fill with coordinates, in kilometers
+   */
+  static void toECEF(const double point[2], double fill[3]);
+
+ private:
+  void inLngRange(const double          lo[2],
+                  const double          hi[2],
+                  std::vector<size_t> & fill) const;
+
+  KDTree              tree;
+  std::vector<double> coords;
+};
+
+}  // namespace Spatial
+
+#endif
@@ -0,0 +1,166 @@
+#include "stream.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief  Creates an empty window
+ *
+ * @param  options   options of the geometric center search
+ * @param  tolerance distance the center of mass may drift before the
+ *                   geometric center is solved again
+ */
+Stream::SlidingCenter::SlidingCenter(
+    const Center::GeometricCenterOptions & options,
+    double                                 tolerance)
+    : _options(options),
+      _tolerance(tolerance),
+      _head(0),
+      _solved(false),
+      _score(0),
+      _churn(0)
+{
+  _sum[0] = _sum[1] = 0;
+  _center[0] = _center[1] = 0;
+  _mass[0] = _mass[1] = 0;
+
+  const Center::GeometricCenterStats stats = {0, 0, 0, 0, false};
+  _stats                                   = stats;
+}
+
+/**
+ * @brief  Adds a point to the end of the window
+ *
+ * @param  point point to add
+ * @param  time  time of the point, no earlier than the points before it
+ */
+void Stream::SlidingCenter::push(const double point[2], double time)
+{
+  _points.push_back(point[0]);
+  _points.push_back(point[1]);
+  _times.push_back(time);
+  _sum[0] += point[0];
+  _sum[1] += point[1];
+  ++_churn;
+}
+
+/**
+ * @brief  Drops the points older than a time from the window
+ *
+ * @param  before time that points must be no earlier than to stay
+ *
+ * @return number of points dropped
+ */
+size_t Stream::SlidingCenter::expire(double before)
+{
+  const size_t head = _head;
+
+  while (_head < _times.size() && _times[_head] < before) {
+    _sum[0] -= _points[2 * _head];
+    _sum[1] -= _points[2 * _head + 1];
+    ++_head;
+  }
+  _churn += _head - head;
+
+  // once most of the buffer is expired, move the window to its front
+  if (_head > size()) {
+    compact();
+  }
+  return _head - head;
+}
+
+/**
+ * @brief  Returns the number of points in the window
+ */
+size_t Stream::SlidingCenter::size() const
+{
+  return _times.size() - _head;
+}
+
+/**
+ * @brief  Finds the center of mass of the window, from its running sums
+ *
+ * @param  fill array to fill with center of mass
+ */
+void Stream::SlidingCenter::centerOfMass(double fill[2]) const
+{
+  fill[0] = _sum[0] / size();
+  fill[1] = _sum[1] / size();
+}
+
+/**
+ * @brief  Finds the geometric center of the window, solving again only if
+ *         the center of mass has drifted past the tolerance
+ *
+ * @param  fill  array to fill with geometric center
+ * @param  stats optional telemetry to fill about the last solve
+ *
+ * @return whether the center was solved again
+ */
+bool Stream::SlidingCenter::center(double                         fill[2],
+                                   Center::GeometricCenterStats * stats)
+{
+  const size_t numPoints = size();
+  bool         solve     = false;
+
+  if (numPoints) {
+    double mass[2];
+    centerOfMass(mass);
+    const double dx    = mass[0] - _mass[0];
+    const double dy    = mass[1] - _mass[1];
+    const double drift = std::sqrt(dx * dx + dy * dy);
+
+    const double(*points)[2] =
+        reinterpret_cast<const double(*)[2]>(&_points[2 * _head]);
+    if (!_solved || _churn >= numPoints) {
+      _score = Center::geometricCenter(points, numPoints, _options, _center,
+                                       &_stats);
+      solve  = true;
+    } else if (drift > _tolerance) {
+      // warm-start from the last center with a step the size of the drift;
+      // the geometric center may have moved further than the center of mass
+      const double step = std::max(drift, _options.epsilon);
+      _score = Center::refineCenter(points, numPoints, _options, step, _center,
+                                    &_stats);
+      solve  = true;
+    }
+
+    if (solve) {
+      _solved  = true;
+      _mass[0] = mass[0], _mass[1] = mass[1];
+      _churn   = 0;
+    }
+  }
+
+  fill[0] = _center[0], fill[1] = _center[1];
+  if (stats) {
+    *stats = _stats;
+  }
+  return solve;
+}
+
+/**
+ * @brief  Returns the net cost of travelling to the geometric center, as of
+ *         the last solve
+ */
+double Stream::SlidingCenter::score() const
+{
+  return _score;
+}
+
+/**
+ * @brief   Moves the window to the front of its buffers
+ * @details Also sums the window afresh, so that rounding in the running sums
+ *          cannot build up over a long stream.
+ */
+void Stream::SlidingCenter::compact()
+{
+  _points.erase(_points.begin(), _points.begin() + 2 * _head);
+  _times.erase(_times.begin(), _times.begin() + _head);
+  _head = 0;
+
+  _sum[0] = _sum[1] = 0;
+  for (size_t i = 0; i < _times.size(); ++i) {
+    _sum[0] += _points[2 * i];
+    _sum[1] += _points[2 * i + 1];
+  }
+}
@@ -0,0 +1,115 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "center.h"
+#include <stddef.h>
+#include <vector>
+
+namespace Stream
+{
+/**
+ * @class
+ * @brief   The geometric center of a sliding window of timestamped points
+ * @details Points are pushed as they arrive and expired once they fall out of
+ *          the window. Running sums keep the center of mass current at O(1)
+ *          per point, and the geometric center is solved lazily: only once
+ *          the center of mass has drifted more than a tolerance since the last
+ *          solve, and then warm-started from the previous center with a step
+ *          about the size of the drift. Between solves the previous center
+ *          is returned, so most queries cost nothing, with no bound on how
+ *          far it is from the true center: the tolerance limits the drift of
+ *          the center of mass, and a point can move the median across the
+ *          window while barely moving the mean. The window is solved from
+ *          scratch once every point in it has changed since the last solve.
+ *          Points should be pushed in time order, since expiry drops points
+ *          from the front of the window.
+ *
+ * ```
+ * Stream::SlidingCenter window(options, 1e-3);
+ * window.push(ping, now);
+ * window.expire(now - 60);
+ * window.center(center);
+ * ```
+ */
+class SlidingCenter
+{
+ public:
+  /**
+   * @brief  Creates an empty window
+   *
+   * @param  options   options of the geometric center search
+   * @param  tolerance distance the center of mass may drift before the
+   *                   geometric center is solved again
+   */
+  SlidingCenter(const Center::GeometricCenterOptions & options,
+                double                                 tolerance);
+
+  /**
+   * @brief  Adds a point to the end of the window
+   *
+   * @param  point point to add
+   * @param  time  time of the point, no earlier than the points before it
+   */
+  void push(const double point[2], double time);
+
+  /**
+   * @brief  Drops the points older than a time from the window
+   *
+   * @param  before time that points must be no earlier than to stay
+   *
+   * @return number of points dropped
+   */
+  size_t expire(double before);
+
+  /**
+   * @brief  Returns the number of points in the window
+   */
+  size_t size() const;
+
+  /**
+   * @brief  Finds the center of mass of the window, from its running sums
+   *
+   * @param  fill array to fill with center of mass
+   */
+  void centerOfMass(double fill[2]) const;
+
+  /**
+   * @brief  Finds the geometric center of the window, solving again only if
+   *         the center of mass has drifted past the tolerance
+   *
+   * @param  fill  array to fill with geometric center
+   * @param  stats optional telemetry to fill about the last solve
+   *
+   * @return whether the center was solved again
+   */
+  bool center(double fill[2], Center::GeometricCenterStats * stats = NULL);
+
+  /**
+   * @brief  Returns the net cost of travelling to the geometric center, as of
+   *         the last solve
+   */
+  double score() const;
+
+ private:
+  void compact();
+
+  const Center::GeometricCenterOptions _options;
+  const double                         _tolerance;
+
+  // interleaved points and their times; the window starts at _head
+  std::vector<double> _points;
+  std::vector<double> _times;
+  size_t              _head;
+  double              _sum[2];
+
+  // state of the last solve, and the points pushed or expired since
+  bool                         _solved;
+  double                       _center[2];
+  double                       _mass[2];
+  double                       _score;
+  Center::GeometricCenterStats _stats;
+  size_t                       _churn;
+};
+}  // namespace Stream
+
+#endif
@@ -1,6 +1,357 @@
 #include "tsp.h"
+#include "arena.h"
+#include "center.h"
+#include "spatial.h"
 #include "util.h"
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
 #include <limits>
+#include <thread>
+#include <vector>
+
+const size_t TSP::MATRIX_LIMIT = 2048;
+const size_t TSP::EXACT_LIMIT  = 16;
+
+namespace
+{
+/**
+ * @brief   Greedily orders points by straight-line travel without a cost
+ *          matrix
+ * @details Finds each nearest unvisited point with a k-d tree that visited
+ *          points are removed from, in O(n log n) time and O(n) memory.
+ *
+ * @param   points    interleaved coordinates of the points to visit
+ * @param   dims      number of coordinates of each point
+ * @param   numPoints number of points
+ * @param   startCity index of the point to start from
+ * @param   fill      array to fill with the visiting order
+ *
+ * @return  number of points in the order
+ */
+size_t fillRouteIndexed(const double * points,
+                        size_t         dims,
+                        size_t         numPoints,
+                        size_t         startCity,
+                        size_t         fill[])
+{
+  Spatial::KDTree tree(dims);
+  tree.build(points, numPoints);
+
+  std::vector<Spatial::Neighbor> nearest;
+  size_t                         city   = startCity;
+  size_t                         length = 0;
+
+  fill[length++] = city;
+  tree.remove(city);
+  while (tree.size()) {
+    tree.nearest(&points[dims * city], 1, nearest);
+    city           = nearest[0].id;
+    fill[length++] = city;
+    tree.remove(city);
+  }
+
+  return length;
+}
+
+/**
+ * @brief   Orders points along a Hilbert curve over them
+ * @details Visits the points in curve order, rotated to start from the start
+ *          point, in O(n) time and memory. Routes are no longer than
+ *          O(sqrt(n)) times the side of the bounding box, a constant factor
+ *          from the optimum on uniform points, but cross it once where the
+ *          rotation joins the ends of the curve.
+ *
+ * @param   points    interleaved coordinates of the points to visit
+ * @param   numPoints number of points
+ * @param   startCity index of the point to start from
+ * @param   fill      array to fill with the visiting order
+ *
+ * @return  number of points in the order
+ */
+size_t fillRouteHilbert(const double * points,
+                        size_t         numPoints,
+                        size_t         startCity,
+                        size_t         fill[])
+{
+  Spatial::fillHilbertOrder(points, 2, numPoints, fill);
+  std::rotate(fill, std::find(fill, fill + numPoints, startCity),
+              fill + numPoints);
+  return numPoints;
+}
+
+/**
+ * @brief  TSP::nearestCity, over a cost matrix of either precision
+ */
+template <typename Cost>
+int nearestIn(Cost * const * costMatrix,
+              size_t         len,
+              size_t         currentCity,
+              const bool     visited[])
+{
+  int  nearest = -1;
+  Cost minCost = 0;
+
+  // compare costs as they are, however small: cities may lie closer than one
+  // unit apart, or on top of one another
+  for (size_t newCity = 0; newCity < len; ++newCity) {
+    if (visited[newCity] || newCity == currentCity) {
+      continue;
+    }
+    const Cost _minCost = costMatrix[currentCity][newCity];
+
+    if (nearest == -1 || _minCost < minCost) {
+      minCost = _minCost;
+      nearest = newCity;
+    }
+  }
+
+  return nearest;
+}
+
+/**
+ * @brief  Greedily orders points by a cost matrix of either precision, as
+ *         TSP::fillRoute
+ */
+template <typename Coord, typename Cost>
+size_t fillRouteMatrix(const Coord      points[][2],
+                       size_t           numPoints,
+                       size_t           startCity,
+                       TSP::VisitMethod method,
+                       size_t           fill[])
+{
+  Arena::Scope scratch;
+
+  // setup visited-cities and cost matrix
+  bool *  visited    = scratch.zeroed<bool>(numPoints);
+  Cost ** costMatrix = scratch.matrix<Cost>(numPoints, numPoints);
+  TSP::fillCostMatrix(points, numPoints, method, costMatrix);
+
+  size_t city   = startCity;
+  size_t length = 0;
+
+  fill[length++] = city;
+
+  // calculate nearest node (city) and add it to the order until every node
+  // has been visited
+  while (Util::arr_contains(visited, numPoints, false)) {
+    visited[city]     = true;
+    const int nearest = TSP::nearestCity(costMatrix, numPoints, city, visited);
+    if (nearest == -1) {
+      break;
+    }
+    fill[length++] = nearest;
+    city           = nearest;
+  }
+
+  return length;
+}
+
+/**
+ * @class
+ * @brief   Blocks a fixed number of threads until all of them have arrived,
+ *          and can be reused as soon as they have
+ */
+class Barrier
+{
+ public:
+  explicit Barrier(size_t parties)
+      : _parties(parties), _waiting(0), _generation(0)
+  {
+  }
+
+  /**
+   * @brief  Waits for every other party, publishing the writes made before
+   *         the call to all of them
+   */
+  void wait()
+  {
+    const size_t generation = _generation.load(std::memory_order_acquire);
+    if (_waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == _parties) {
+      _waiting.store(0, std::memory_order_relaxed);
+      _generation.fetch_add(1, std::memory_order_release);
+      return;
+    }
+    while (_generation.load(std::memory_order_acquire) == generation) {
+      std::this_thread::yield();
+    }
+  }
+
+ private:
+  const size_t        _parties;
+  std::atomic<size_t> _waiting;
+  std::atomic<size_t> _generation;
+};
+
+/**
+ * @brief  Lanes a row of path costs is extended in at once; rows are padded
+ *         to a multiple of them
+ */
+const size_t LANES = 8;
+
+/**
+ * @brief  Widest row of costs an exact route is extended over, which must
+ *         hold the cities of a route besides its start
+ */
+const size_t MAX_STRIDE = 3 * LANES;
+static_assert(TSP::EXACT_LIMIT - 1 <= MAX_STRIDE,
+              "exact routes must fit the widest row ExactTable extends");
+
+/**
+ * @brief  Floats between the columns of a Held-Karp table beyond its subsets,
+ *         so that the columns, a power of two apart otherwise, do not contend
+ *         for the same cache sets
+ */
+const size_t COLUMN_PADDING = 16;
+
+/**
+ * @brief  Subsets at which an exact route is worth spreading across threads
+ */
+const size_t PARALLEL_SETS = size_t(1) << 13;
+
+/**
+ * @brief  Most threads an exact route is spread across
+ */
+const size_t MAX_THREADS = 8;
+
+/**
+ * @struct
+ * @brief   Held-Karp table of the cheapest paths from a start city through
+ *          every subset of the other cities, ending at each city of the
+ *          subset
+ * @details Column j of the table holds, for each subset s (a bitmask of the
+ *          other cities), the cost of the cheapest path through s that ends
+ *          at city j; cells of cities outside s are never read. The paths
+ *          through s are extended to every other city at once, as a min-plus
+ *          product of their costs with the padded rows of costs out of their
+ *          cities. Each result is the only candidate for its cell, so threads
+ *          extending different subsets never write the same cell.
+ */
+struct ExactTable {
+  size_t           numCities;
+  size_t           numSets;
+  size_t           column;
+  size_t           stride;
+  const float *    from;
+  float *          paths;
+  const uint32_t * sets;
+  const size_t *   layers;
+  size_t           numThreads;
+  Barrier *        barrier;
+
+  /**
+   * @brief  Extends the paths through a subset to each city outside it, over
+   *         rows of a fixed stride so that they stay in registers
+   */
+  template <size_t STRIDE>
+  void extend(uint32_t set) const
+  {
+    float best[STRIDE];
+    for (size_t j = 0; j < STRIDE; ++j) {
+      best[j] = std::numeric_limits<float>::infinity();
+    }
+    for (uint32_t rest = set; rest; rest &= rest - 1) {
+      const size_t  k     = __builtin_ctz(rest);
+      const float   cost  = paths[k * column + set];
+      const float * costs = from + k * STRIDE;
+      for (size_t j = 0; j < STRIDE; ++j) {
+        const float next = cost + costs[j];
+        best[j]          = next < best[j] ? next : best[j];
+      }
+    }
+    for (uint32_t rest = ~set & (numSets - 1); rest; rest &= rest - 1) {
+      const size_t j = __builtin_ctz(rest);
+      paths[j * column + (set | (rest & -rest))] = best[j];
+    }
+  }
+
+  /**
+   * @brief  Extends a thread's share of every layer of subsets, smallest
+   *         first, waiting for the other threads between layers
+   */
+  void extendLayers(size_t thread) const
+  {
+    switch (stride) {
+      case LANES:
+        return extendShare<LANES>(thread);
+      case 2 * LANES:
+        return extendShare<2 * LANES>(thread);
+      case 3 * LANES:
+        return extendShare<3 * LANES>(thread);
+      default:
+        // strides round the cities besides the start up to LANES, which
+        // the static_assert on EXACT_LIMIT keeps within MAX_STRIDE
+        assert(false && "ExactTable stride wider than MAX_STRIDE");
+        return;
+    }
+  }
+
+  /**
+   * @brief  extendLayers, over rows of a fixed stride
+   */
+  template <size_t STRIDE>
+  void extendShare(size_t thread) const
+  {
+    for (size_t layer = 1; layer < numCities; ++layer) {
+      const size_t begin = layers[layer];
+      const size_t count = layers[layer + 1] - begin;
+      const size_t first = begin + count * thread / numThreads;
+      const size_t last  = begin + count * (thread + 1) / numThreads;
+      for (size_t i = first; i < last; ++i) {
+        extend<STRIDE>(sets[i]);
+      }
+      if (numThreads > 1) {
+        barrier->wait();
+      }
+    }
+  }
+
+  /**
+   * @brief  Finds the last city of the cheapest path through a subset that
+   *         goes on to a city, or to none when it is numCities
+   */
+  size_t cheapestLast(uint32_t set, size_t next) const
+  {
+    size_t best = numCities;
+    float  cost = std::numeric_limits<float>::infinity();
+    for (uint32_t rest = set; rest; rest &= rest - 1) {
+      const size_t k     = __builtin_ctz(rest);
+      const float  total = paths[k * column + set] +
+                          (next < numCities ? from[k * stride + next] : 0);
+      if (total < cost) {
+        best = k;
+        cost = total;
+      }
+    }
+    return best;
+  }
+};
+
+/**
+ * @brief  Orders points optimally by a cost matrix measured in their own
+ *         precision, as TSP::fillExactRoute
+ */
+template <typename Coord>
+size_t fillRouteExact(const Coord      points[][2],
+                      size_t           numPoints,
+                      size_t           startCity,
+                      TSP::VisitMethod method,
+                      size_t           fill[])
+{
+  Arena::Scope scratch;
+  Coord ** costMatrix = scratch.matrix<Coord>(numPoints, numPoints);
+  float ** narrow     = scratch.matrix<float>(numPoints, numPoints);
+  TSP::fillCostMatrix(points, numPoints, method, costMatrix);
+  for (size_t i = 0; i < numPoints; ++i) {
+    for (size_t j = 0; j < numPoints; ++j) {
+      narrow[i][j] = costMatrix[i][j];
+    }
+  }
+  return TSP::fillExactRoute(narrow, numPoints, startCity, fill);
+}
+}  // namespace
 
 /**
  * @brief   Calculates the nearest unvisited city to a specified one
@@ -19,19 +370,339 @@ int TSP::nearestCity(const Util::DoubleArr2D costMatrix,
                      size_t                  currentCity,
                      const bool              visited[])
 {
-  int    nearest = -1;
-  size_t minCost = std::numeric_limits<size_t>::max();
+  return nearestIn(costMatrix, len, currentCity, visited);
+}
 
-  for (size_t newCity = 0; newCity < len; ++newCity) {
-    const size_t _minCost = costMatrix[currentCity][newCity];
+/**
+ * @brief   Calculates the nearest unvisited city to a specified one, over a
+ *          single-precision cost matrix
+ * @details As nearestCity.
+ *
+ * @param   costMatrix  costs of travelling between each city
+ * @param   len         size of the cost matrix
+ * @param   currentCity city to find the next one from
+ * @param   visited     tracks visited cities
+ *
+ * @return  index of nearest city, or -1 if no cities left
+ */
+int TSP::nearestCity(const Util::FloatArr2D costMatrix,
+                     size_t                 len,
+                     size_t                 currentCity,
+                     const bool             visited[])
+{
+  return nearestIn(costMatrix, len, currentCity, visited);
+}
+
+/**
+ * @brief   Fills a cost matrix with the cost of travelling between every pair
+ *          of points
+ *
+ * @param   points     points to travel between
+ * @param   numPoints  number of points
+ * @param   method     metric to measure travel with
+ * @param   costMatrix numPoints x numPoints matrix to fill
+ */
+void TSP::fillCostMatrix(const double      points[][2],
+                         size_t            numPoints,
+                         VisitMethod       method,
+                         Util::DoubleArr2D costMatrix)
+{
+  const size_t matrixLen = 1;
+
+  for (size_t i = 0; i < numPoints; ++i) {
+    for (size_t j = 0; j < numPoints; ++j) {
+      const double(*to)[2] = &points[j];
+      const double * from  = points[i];
 
-    if (_minCost != 0 && !visited[newCity]) {
-      if (_minCost < minCost) {
-        minCost = _minCost;
-        nearest = newCity;
+      switch (method) {
+        case VisitMethod::tsp:
+        case VisitMethod::hilbert:
+          costMatrix[i][j] = Center::cost(from[0], from[1], to, matrixLen);
+          break;
+        case VisitMethod::naiveVrp:
+          costMatrix[i][j] =
+              Center::manhattanCost(from[0], from[1], to, matrixLen);
+          break;
       }
     }
   }
+}
 
-  return nearest;
+/**
+ * @brief   Fills a single-precision cost matrix with the cost of travelling
+ *          between every pair of single-precision points
+ * @details As fillCostMatrix, measuring each cost in single precision a row
+ *          at a time, so that rows vectorize.
+ *
+ * @param   points     points to travel between
+ * @param   numPoints  number of points
+ * @param   method     metric to measure travel with
+ * @param   costMatrix numPoints x numPoints matrix to fill
+ */
+void TSP::fillCostMatrix(const float      points[][2],
+                         size_t           numPoints,
+                         VisitMethod      method,
+                         Util::FloatArr2D costMatrix)
+{
+  for (size_t i = 0; i < numPoints; ++i) {
+    const float x   = points[i][0];
+    const float y   = points[i][1];
+    float *     row = costMatrix[i];
+
+    switch (method) {
+      case VisitMethod::tsp:
+      case VisitMethod::hilbert:
+        for (size_t j = 0; j < numPoints; ++j) {
+          const float dx = points[j][0] - x;
+          const float dy = points[j][1] - y;
+          row[j]         = std::sqrt(dx * dx + dy * dy);
+        }
+        break;
+      case VisitMethod::naiveVrp:
+        for (size_t j = 0; j < numPoints; ++j) {
+          row[j] = std::abs(points[j][0] - x) + std::abs(points[j][1] - y);
+        }
+        break;
+    }
+  }
+}
+
+/**
+ * @brief   Determines the cheapest order to visit a set of cities in
+ * @details Solves for the optimal path from the start city by dynamic
+ *          programming over subsets of the other cities (Held-Karp), in
+ *          O(2^n n^2) time and O(2^n n) memory, so only up to EXACT_LIMIT
+ *          cities. The paths through each subset are extended to every other
+ *          city at once, several lanes at a time, and large problems split
+ *          each layer of subsets of one size across threads.
+ *
+ * @param   costMatrix costs of travelling between each city
+ * @param   numPoints  number of cities
+ * @param   startCity  index of the city to start from
+ * @param   fill       array to fill with the visiting order
+ *
+ * @return  number of cities in the order, or 0 if the start is out of range
+ *          or there are more than EXACT_LIMIT cities
+ */
+size_t TSP::fillExactRoute(const Util::FloatArr2D costMatrix,
+                           size_t                 numPoints,
+                           size_t                 startCity,
+                           size_t                 fill[])
+{
+  if (startCity >= numPoints || numPoints > EXACT_LIMIT) {
+    return 0;
+  }
+  fill[0] = startCity;
+  if (numPoints == 1) {
+    return 1;
+  }
+
+  Arena::Scope scratch;
+  const size_t numCities = numPoints - 1;
+  const size_t stride    = (numCities + LANES - 1) / LANES * LANES;
+  const size_t numSets   = size_t(1) << numCities;
+
+  // number the cities besides the start, with the cost out of each of them
+  // to each other, padded with free lanes
+  size_t * cities = scratch.alloc<size_t>(numCities);
+  float *  from   = scratch.zeroed<float>(numCities * stride);
+  for (size_t city = 0, j = 0; city < numPoints; ++city) {
+    if (city != startCity) {
+      cities[j++] = city;
+    }
+  }
+  for (size_t k = 0; k < numCities; ++k) {
+    for (size_t j = 0; j < numCities; ++j) {
+      from[k * stride + j] = costMatrix[cities[k]][cities[j]];
+    }
+  }
+
+  // order the subsets by size, so that each layer only reads the last
+  size_t *   layers = scratch.zeroed<size_t>(numCities + 2);
+  uint32_t * sets   = scratch.alloc<uint32_t>(numSets);
+  for (size_t set = 0; set < numSets; ++set) {
+    ++layers[__builtin_popcount(set) + 1];
+  }
+  for (size_t layer = 1; layer <= numCities + 1; ++layer) {
+    layers[layer] += layers[layer - 1];
+  }
+  size_t * next = scratch.alloc<size_t>(numCities + 1);
+  std::copy(layers, layers + numCities + 1, next);
+  for (size_t set = 0; set < numSets; ++set) {
+    sets[next[__builtin_popcount(set)]++] = set;
+  }
+
+  // paths through a single city come straight from the start
+  const size_t column = numSets + COLUMN_PADDING;
+  float *      paths  = scratch.alloc<float>(numCities * column);
+  for (size_t j = 0; j < numCities; ++j) {
+    paths[j * column + (size_t(1) << j)] = costMatrix[startCity][cities[j]];
+  }
+
+  size_t numThreads = 1;
+  if (numSets >= PARALLEL_SETS) {
+    const size_t cores = std::thread::hardware_concurrency();
+    numThreads         = std::max<size_t>(1, std::min(cores, MAX_THREADS));
+  }
+  Barrier          barrier(numThreads);
+  const ExactTable table = {numCities, numSets, column,     stride,  from,
+                            paths,     sets,    layers,     numThreads,
+                            &barrier};
+
+  std::vector<std::thread> threads;
+  for (size_t thread = 1; thread < numThreads; ++thread) {
+    threads.push_back(std::thread(&ExactTable::extendLayers, &table, thread));
+  }
+  table.extendLayers(0);
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].join();
+  }
+
+  // walk back from the cheapest path through every city
+  uint32_t set  = numSets - 1;
+  size_t   last = table.cheapestLast(set, numCities);
+  for (size_t position = numCities; position > 0; --position) {
+    fill[position] = cities[last];
+    const size_t city = last;
+    set ^= uint32_t(1) << city;
+    last = table.cheapestLast(set, city);
+  }
+
+  return numPoints;
+}
+
+/**
+ * @brief   Determines an efficient order to visit a set of points in
+ * @details Greedily travels to the nearest unvisited point, starting from a
+ *          designated one, until every point has been visited. Routes over
+ *          up to EXACT_LIMIT points are solved exactly instead, and
+ *          Pythagorean routes over more than MATRIX_LIMIT points search a
+ *          spatial index instead of a cost matrix. Hilbert routes follow a
+ *          Hilbert curve from the start instead, in O(n) time, for inputs
+ *          too large even for the spatial index.
+ *
+ * @param   points    points to visit
+ * @param   numPoints number of points
+ * @param   startCity index of the point to start from
+ * @param   method    metric to measure travel with
+ * @param   fill      array to fill with the visiting order
+ *
+ * @return  number of points in the order, or 0 if the start is out of range
+ */
+size_t TSP::fillRoute(const double points[][2],
+                      size_t       numPoints,
+                      size_t       startCity,
+                      VisitMethod  method,
+                      size_t       fill[])
+{
+  if (startCity >= numPoints) {
+    return 0;
+  }
+  if (method == VisitMethod::hilbert) {
+    return fillRouteHilbert(points[0], numPoints, startCity, fill);
+  }
+  if (numPoints <= EXACT_LIMIT) {
+    return fillRouteExact(points, numPoints, startCity, method, fill);
+  }
+  if (method == VisitMethod::tsp && numPoints > MATRIX_LIMIT) {
+    return fillRouteIndexed(points[0], 2, numPoints, startCity, fill);
+  }
+
+  return fillRouteMatrix<double, double>(points, numPoints, startCity, method,
+                                         fill);
+}
+
+/**
+ * @brief   Determines an efficient order to visit a set of single-precision
+ *          points in
+ * @details As fillRoute, over a single-precision cost matrix of half the
+ *          memory. Costs are measured and compared in single precision
+ *          too, and routes over up to EXACT_LIMIT points are solved exactly.
+ *          Pythagorean routes over more than MATRIX_LIMIT points, and
+ *          Hilbert routes, widen the points to double precision first.
+ *
+ * @param   points    points to visit
+ * @param   numPoints number of points
+ * @param   startCity index of the point to start from
+ * @param   method    metric to measure travel with
+ * @param   fill      array to fill with the visiting order
+ *
+ * @return  number of points in the order, or 0 if the start is out of range
+ */
+size_t TSP::fillRoute(const float points[][2],
+                      size_t      numPoints,
+                      size_t      startCity,
+                      VisitMethod method,
+                      size_t      fill[])
+{
+  if (startCity >= numPoints) {
+    return 0;
+  }
+  if (method == VisitMethod::hilbert ||
+      (method == VisitMethod::tsp && numPoints > MATRIX_LIMIT)) {
+    Arena::Scope scratch;
+    double *     wide = scratch.alloc<double>(2 * numPoints);
+    for (size_t i = 0; i < numPoints; ++i) {
+      wide[2 * i]     = points[i][0];
+      wide[2 * i + 1] = points[i][1];
+    }
+    return method == VisitMethod::hilbert
+               ? fillRouteHilbert(wide, numPoints, startCity, fill)
+               : fillRouteIndexed(wide, 2, numPoints, startCity, fill);
+  }
+  if (numPoints <= EXACT_LIMIT) {
+    return fillRouteExact(points, numPoints, startCity, method, fill);
+  }
+
+  return fillRouteMatrix<float, float>(points, numPoints, startCity, method,
+                                       fill);
+}
+
+/**
+ * @brief   Determines an efficient order to visit the points of a store in
+ * @details Greedily travels to the nearest unvisited point by great-circle
+ *          distance, starting from a designated one. Straight-line distance
+ *          between the cached unit vectors orders points the same as
+ *          great-circle distance, so no trigonometry is needed. Routes over
+ *          up to EXACT_LIMIT points are solved exactly, by great-circle
+ *          distance.
+ *
+ * @param   store     points to visit
+ * @param   startCity index of the point to start from
+ * @param   fill      array of store.size() to fill with the visiting order
+ *
+ * @return  number of points in the order, or 0 if the start is out of range
+ */
+size_t TSP::fillRoute(const Geo::PointStore & store,
+                      size_t                  startCity,
+                      size_t                  fill[])
+{
+  const size_t numPoints = store.size();
+  if (startCity >= numPoints) {
+    return 0;
+  }
+
+  Arena::Scope scratch;
+  if (numPoints <= EXACT_LIMIT) {
+    // costs add up along a route as angles do, not as chords
+    float ** costMatrix = scratch.matrix<float>(numPoints, numPoints);
+    for (size_t i = 0; i < numPoints; ++i) {
+      for (size_t j = 0; j < numPoints; ++j) {
+        const double dx    = store.x()[i] - store.x()[j];
+        const double dy    = store.y()[i] - store.y()[j];
+        const double dz    = store.z()[i] - store.z()[j];
+        const double chord = std::sqrt(dx * dx + dy * dy + dz * dz);
+        costMatrix[i][j]   = 2 * std::asin(std::min(1.0, chord / 2));
+      }
+    }
+    return fillExactRoute(costMatrix, numPoints, startCity, fill);
+  }
+
+  double * points = scratch.alloc<double>(3 * numPoints);
+  for (size_t i = 0; i < numPoints; ++i) {
+    points[3 * i]     = store.x()[i];
+    points[3 * i + 1] = store.y()[i];
+    points[3 * i + 2] = store.z()[i];
+  }
+  return fillRouteIndexed(points, 3, numPoints, startCity, fill);
 }
@@ -1,6 +1,7 @@
 #ifndef TSP_H
 #define TSP_H
 
+#include "geo.h"
 #include "util.h"
 #include <stddef.h>
 
@@ -12,8 +13,13 @@ namespace TSP
  *
  * @prop  tsp      Travelling Salesman Problem
  * @prop  naiveVsp Vehicle Routing Problem, with Manhattan distance
+ * @prop  hilbert  Travelling Salesman Problem, approximated by the order of a
+ *                 Hilbert curve over the points
  */
-enum VisitMethod { tsp = 't', naiveVrp = 'n' };
+enum VisitMethod { tsp = 't', naiveVrp = 'n', hilbert = 'h' };
+
+extern const size_t MATRIX_LIMIT;
+extern const size_t EXACT_LIMIT;
 
 /**
  * @brief   Calculates the nearest unvisited city to a specified one
@@ -32,6 +38,141 @@ int nearestCity(const Util::DoubleArr2D costMatrix,
                 size_t                  currentCity,
                 const bool              visited[]);
 
+/**
+ * @brief   Calculates the nearest unvisited city to a specified one, over a
+ *          single-precision cost matrix
+ * @details As nearestCity.
+ *
+ * @param   costMatrix  costs of travelling between each city
+ * @param   len         size of the cost matrix
+ * @param   currentCity city to find the next one from
+ * @param   visited     tracks visited cities
+ *
+ * @return  index of nearest city, or -1 if no cities left
+ */
+int nearestCity(const Util::FloatArr2D costMatrix,
+                size_t                 len,
+                size_t                 currentCity,
+                const bool             visited[]);
+
+/**
+ * @brief   Fills a cost matrix with the cost of travelling between every pair
+ *          of points
+ *
+ * @param   points     points to travel between
+ * @param   numPoints  number of points
+ * @param   method     metric to measure travel with
+ * @param   costMatrix numPoints x numPoints matrix to fill
+ */
+void fillCostMatrix(const double      points[][2],
+                    size_t            numPoints,
+                    VisitMethod       method,
+                    Util::DoubleArr2D costMatrix);
+
+/**
+ * @brief   Fills a single-precision cost matrix with the cost of travelling
+ *          between every pair of single-precision points
+ * @details As fillCostMatrix, measuring each cost in single precision a row
+ *          at a time, so that rows vectorize.
+ *
+ * @param   points     points to travel between
+ * @param   numPoints  number of points
+ * @param   method     metric to measure travel with
+ * @param   costMatrix numPoints x numPoints matrix to fill
+ */
+void fillCostMatrix(const float      points[][2],
+                    size_t           numPoints,
+                    VisitMethod      method,
+                    Util::FloatArr2D costMatrix);
+
+/**
+ * @brief   Determines the cheapest order to visit a set of cities in
+ * @details Solves for the optimal path from the start city by dynamic
+ *          programming over subsets of the other cities (Held-Karp), in
+ *          O(2^n n^2) time and O(2^n n) memory, so only up to EXACT_LIMIT
+ *          cities. The paths through each subset are extended to every other
+ *          city at once, several lanes at a time, and large problems split
+ *          each layer of subsets of one size across threads.
+ *
+ * @param   costMatrix costs of travelling between each city
+ * @param   numPoints  number of cities
+ * @param   startCity  index of the city to start from
+ * @param   fill       array to fill with the visiting order
+ *
+ * @return  number of cities in the order, or 0 if the start is out of range
+ *          or there are more than EXACT_LIMIT cities
+ */
+size_t fillExactRoute(const Util::FloatArr2D costMatrix,
+                      size_t                 numPoints,
+                      size_t                 startCity,
+                      size_t                 fill[]);
+
+/**
+ * @brief   Determines an efficient order to visit a set of points in
+ * @details Greedily travels to the nearest unvisited point, starting from a
+ *          designated one, until every point has been visited. Routes over
+ *          up to EXACT_LIMIT points are solved exactly instead, and
+ *          Pythagorean routes over more than MATRIX_LIMIT points search a
+ *          spatial index instead of a cost matrix. Hilbert routes follow a
+ *          Hilbert curve from the start instead, in O(n) time, for inputs
+ *          too large even for the spatial index.
+ *
+ * @param   points    points to visit
+ * @param   numPoints number of points
+ * @param   startCity index of the point to start from
+ * @param   method    metric to measure travel with
+ * @param   fill      array to fill with the visiting order
+ *
+ * @return  number of points in the order, or 0 if the start is out of range
+ */
+size_t fillRoute(const double points[][2],
+                 size_t       numPoints,
+                 size_t       startCity,
+                 VisitMethod  method,
+                 size_t       fill[]);
+
+/**
+ * @brief   Determines an efficient order to visit a set of single-precision
+ *          points in
+ * @details As fillRoute, over a single-precision cost matrix of half the
+ *          memory. Costs are measured and compared in single precision
+ *          too, and routes over up to EXACT_LIMIT points are solved exactly.
+ *          Pythagorean routes over more than MATRIX_LIMIT points, and
+ *          Hilbert routes, widen the points to double precision first.
+ *
+ * @param   points    points to visit
+ * @param   numPoints number of points
+ * @param   startCity index of the point to start from
+ * @param   method    metric to measure travel with
+ * @param   fill      array to fill with the visiting order
+ *
+ * @return  number of points in the order, or 0 if the start is out of range
+ */
+size_t fillRoute(const float points[][2],
+                 size_t      numPoints,
+                 size_t      startCity,
+                 VisitMethod method,
+                 size_t      fill[]);
+
+/**
+ * @brief   Determines an efficient order to visit the points of a store in
+ * @details Greedily travels to the nearest unvisited point by great-circle
+ *          distance, starting from a designated one. Straight-line distance
+ *          between the cached unit vectors orders points the same as
+ *          great-circle distance, so no trigonometry is needed. Routes over
+ *          up to EXACT_LIMIT points are solved exactly, by great-circle
+ *          distance.
+ *
+ * @param   store     points to visit
+ * @param   startCity index of the point to start from
+ * @param   fill      array of store.size() to fill with the visiting order
+ *
+ * @return  number of points in the order, or 0 if the start is out of range
+ */
+size_t fillRoute(const Geo::PointStore & store,
+                 size_t                  startCity,
+                 size_t                  fill[]);
+
 }  // namespace TSP
 
 #endif
@@ -7,6 +7,7 @@ namespace Util
 {
 typedef double *  DoubleArr;
 typedef double ** DoubleArr2D;
+typedef float **  FloatArr2D;
 
 /**
  * @brief  Checks if an array contains a certain value
@@ -0,0 +1,32 @@
+#include "wrapper.h"
+
+namespace
+{
+typedef void (*ModuleInit)(v8::Local<v8::Object> exports);
+
+/**
+ * Mounts a module's bindings on the addon exports under a name.
+ */
+void mount(v8::Local<v8::Object> exports, const char * name, ModuleInit init)
+{
+  v8::Isolate *         isolate = exports->GetIsolate();
+  v8::Local<v8::Object> module  = v8::Object::New(isolate);
+  init(module);
+  exports->Set(v8::String::NewFromUtf8(isolate, name), module);
+}
+
+void init(v8::Local<v8::Object> exports)
+{
+  mount(exports, "cartesian", Cartesian::init);
+  mount(exports, "center", Center::init);
+  mount(exports, "geo", Geo::init);
+  mount(exports, "metrics", Metrics::init);
+  mount(exports, "pointFile", PointFile::init);
+  mount(exports, "polynomial", Polynomial::init);
+  mount(exports, "spatial", Spatial::init);
+  mount(exports, "stream", Stream::init);
+  mount(exports, "tsp", TSP::init);
+}
+}  // namespace
+
+NODE_MODULE(meethere, init);
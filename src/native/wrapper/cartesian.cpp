@@ -1,10 +1,14 @@
+#include "../arena.h"
 #include "../cartesian.h"
-#include <node.h>
+#include "../metrics.h"
+#include "wrapper.h"
 
 namespace Cartesian
 {
 /**
- * Calculates the Cartesian (Earthly) distance between two Lat/Lng points.
+ * Calculates the Cartesian (Earthly) distance between two Lat/Lng points, by
+ * a DistanceMode (exact if not given), from points held in single precision
+ * if asked.
  */
 void distance(const v8::FunctionCallbackInfo<v8::Value> & args)
 {
@@ -14,16 +18,15 @@ void distance(const v8::FunctionCallbackInfo<v8::Value> & args)
   v8::Local<v8::Array> _points = v8::Local<v8::Array>::Cast(args[0]);
   v8::Local<v8::Array> _center = v8::Local<v8::Array>::Cast(args[1]);
   const char           unit    = (char)(args[2]->Uint32Value());
+  const DistanceMode   mode    = (DistanceMode)(args[3]->Uint32Value());
+  const bool           single  = args[4]->BooleanValue();
 
   const size_t length = _points->Length();
 
-  // pass locations to C++ array
-  double points[length][2];
-  for (size_t i = 0; i < length; ++i) {
-    v8::Local<v8::Array> _element = v8::Local<v8::Array>::Cast(_points->Get(i));
-    points[i][0]                  = _element->Get(0)->NumberValue();
-    points[i][1]                  = _element->Get(1)->NumberValue();
-  }
+  static Metrics::EntryPoint & metrics =
+      Metrics::entryPoint("cartesian.distance");
+  Metrics::Call call(metrics, length);
+
   double center[2];
   {
     v8::Local<v8::Array> _centerElement = v8::Local<v8::Array>::Cast(_center);
@@ -31,20 +34,26 @@ void distance(const v8::FunctionCallbackInfo<v8::Value> & args)
     center[1]                           = _centerElement->Get(1)->NumberValue();
   }
 
-  // record distances from each location to center
+  // pass locations to C++ array of the precision asked for, and record
+  // distances from each location to center
+  Arena::Scope scratch;
+  double *     _distances = scratch.alloc<double>(length);
+  if (single) {
+    float(*points)[2] = scratch.alloc<float[2]>(length);
+    Spatial::unwrapPoints(_points, points);
+    call.enter(Metrics::compute);
+    fillDistances(points, length, center, unit, _distances, mode);
+  } else {
+    double(*points)[2] = scratch.alloc<double[2]>(length);
+    Spatial::unwrapPoints(_points, points);
+    call.enter(Metrics::compute);
+    fillDistances(points, length, center, unit, _distances, mode);
+  }
+
+  call.enter(Metrics::unmarshal);
   v8::Local<v8::Array> distances = v8::Array::New(isolate);
   for (size_t i = 0; i < length; ++i) {
-    // latitudes
-    const double lat1 = radiansFromDeg(center[0]);
-    const double lat2 = radiansFromDeg(points[i][0]);
-
-    // dLat, dLng
-    const double dlat = radiansFromDeg(points[i][0] - center[0]);
-    const double dlng = radiansFromDeg(points[i][1] - center[1]);
-
-    const double distance = haversine(lat1, lat2, dlat, dlng, unit);
-
-    distances->Set(i, v8::Number::New(isolate, distance));
+    distances->Set(i, v8::Number::New(isolate, _distances[i]));
   }
 
   // create object to hold results
@@ -61,6 +70,4 @@ void init(v8::Local<v8::Object> exports)
   NODE_SET_METHOD(exports, "distance", distance);
 }
 
-NODE_MODULE(addon, init);
-
 }  // namespace Cartesian
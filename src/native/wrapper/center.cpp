@@ -1,10 +1,56 @@
+#include "../arena.h"
 #include "../center.h"
-#include <node.h>
+#include "../metrics.h"
+#include "wrapper.h"
 
 namespace Center
 {
 /**
- * Calculates the geometric center of an arbitrary amount of points.
+ * Converts geometric center search telemetry to a JS Object.
+ */
+v8::Local<v8::Object> wrapStats(v8::Isolate *                isolate,
+                                const GeometricCenterStats & stats)
+{
+  v8::Local<v8::Object> _stats = v8::Object::New(isolate);
+  _stats->Set(v8::String::NewFromUtf8(isolate, "iterations"),
+              v8::Number::New(isolate, stats.iterations));
+  _stats->Set(v8::String::NewFromUtf8(isolate, "costEvaluations"),
+              v8::Number::New(isolate, stats.costEvaluations));
+  _stats->Set(v8::String::NewFromUtf8(isolate, "stepHalvings"),
+              v8::Number::New(isolate, stats.stepHalvings));
+  _stats->Set(v8::String::NewFromUtf8(isolate, "finalStep"),
+              v8::Number::New(isolate, stats.finalStep));
+  _stats->Set(v8::String::NewFromUtf8(isolate, "converged"),
+              v8::Boolean::New(isolate, stats.converged));
+  return _stats;
+}
+
+/**
+ * Converts the result of a center search to a JS Object holding the center,
+ * its score and the search telemetry.
+ */
+v8::Local<v8::Object> wrapSearch(v8::Isolate *                isolate,
+                                 const double                 center[2],
+                                 double                       score,
+                                 const GeometricCenterStats & stats)
+{
+  v8::Local<v8::Array> _center = v8::Array::New(isolate);
+  _center->Set(0, v8::Number::New(isolate, center[0]));
+  _center->Set(1, v8::Number::New(isolate, center[1]));
+
+  v8::Local<v8::Object> result = v8::Object::New(isolate);
+  result->Set(v8::String::NewFromUtf8(isolate, "center"), _center);
+  result->Set(v8::String::NewFromUtf8(isolate, "score"),
+              v8::Number::New(isolate, score));
+  result->Set(v8::String::NewFromUtf8(isolate, "stats"),
+              wrapStats(isolate, stats));
+  return result;
+}
+
+/**
+ * Calculates the geometric center of an arbitrary amount of points, merging
+ * points that share a grid cell first if given a cell size, or else in
+ * single precision if asked.
  */
 void geometric(const v8::FunctionCallbackInfo<v8::Value> & args)
 {
@@ -16,32 +62,131 @@ void geometric(const v8::FunctionCallbackInfo<v8::Value> & args)
   const bool                   subsearch = args[1]->BooleanValue();
   const double                 epsilon   = args[2]->NumberValue();
   const double                 bounds    = args[3]->NumberValue();
-  const GeometricCenterOptions opts      = {epsilon, bounds, subsearch};
+  const size_t                 maxIters  = args[4]->Uint32Value();
+  const double                 maxMicros = args[5]->NumberValue();
+  const double                 cellSize  = args[6]->NumberValue();
+  const bool                   single    = args[7]->BooleanValue();
+  const GeometricCenterOptions opts      = {epsilon, bounds, subsearch,
+                                       maxIters, maxMicros};
+
+  static Metrics::EntryPoint & metrics =
+      Metrics::entryPoint("center.geometric");
+  Metrics::Call call(metrics, numPoints);
+
+  double               center[2] = {0, 0};
+  GeometricCenterStats stats;
+  double               score;
+  Arena::Scope         scratch;
+
+  if (single && !(cellSize > 0)) {
+    float(*points)[2] = scratch.alloc<float[2]>(numPoints);
+    Spatial::unwrapPoints(_points, points);
+
+    call.enter(Metrics::compute);
+    score = geometricCenter(points, numPoints, opts, center, &stats);
+
+    call.enter(Metrics::unmarshal);
+    args.GetReturnValue().Set(wrapSearch(isolate, center, score, stats));
+    return;
+  }
 
   // pass locations to native array
-  double points[numPoints][2];
+  double(*points)[2] = scratch.alloc<double[2]>(numPoints);
+  Spatial::unwrapPoints(_points, points);
+
+  // calculate geometric center, of the points merged by grid cell if asked
+  call.enter(Metrics::compute);
+  if (cellSize > 0) {
+    double(*cells)[2] = scratch.alloc<double[2]>(numPoints);
+    double *     weights  = scratch.alloc<double>(numPoints);
+    const size_t numCells =
+        aggregate(points, numPoints, cellSize, cells, weights);
+    geometricCenter(cells, weights, numCells, opts, center, &stats);
+    score = cost(center[0], center[1], points, numPoints);
+  } else {
+    score = geometricCenter(points, numPoints, opts, center, &stats);
+  }
+
+  call.enter(Metrics::unmarshal);
+  args.GetReturnValue().Set(wrapSearch(isolate, center, score, stats));
+}
+
+/**
+ * Calculates the geometric center of Latitude/Longitude points on the earth's
+ * surface.
+ */
+void spherical(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+
+  // get args
+  v8::Local<v8::Array>         _points   = v8::Local<v8::Array>::Cast(args[0]);
+  const size_t                 numPoints = _points->Length();
+  const double                 epsilon   = args[1]->NumberValue();
+  const size_t                 maxIters  = args[2]->Uint32Value();
+  const double                 maxMicros = args[3]->NumberValue();
+  const GeometricCenterOptions opts      = {epsilon, 0, false, maxIters,
+                                       maxMicros};
+
+  static Metrics::EntryPoint & metrics =
+      Metrics::entryPoint("center.spherical");
+  Metrics::Call call(metrics, numPoints);
+
+  // pass locations to native array
+  Arena::Scope scratch;
+  double(*points)[2] = scratch.alloc<double[2]>(numPoints);
   for (unsigned int i = 0; i < numPoints; ++i) {
     v8::Local<v8::Array> _element = v8::Local<v8::Array>::Cast(_points->Get(i));
     points[i][0]                  = _element->Get(0)->NumberValue();
     points[i][1]                  = _element->Get(1)->NumberValue();
   }
 
-  // calculate geometric center
-  double       center[2] = {0, 0};
-  const double score     = geometricCenter(points, numPoints, opts, center);
+  // calculate spherical geometric center
+  call.enter(Metrics::compute);
+  double               center[2] = {0, 0};
+  GeometricCenterStats stats;
+  const double score = sphericalCenter(points, numPoints, opts, center, &stats);
 
-  // convert center back to JS Array
-  v8::Local<v8::Array> _center = v8::Array::New(isolate);
-  _center->Set(0, v8::Number::New(isolate, center[0]));
-  _center->Set(1, v8::Number::New(isolate, center[1]));
+  call.enter(Metrics::unmarshal);
+  args.GetReturnValue().Set(wrapSearch(isolate, center, score, stats));
+}
 
-  // create object to hold center and score
-  v8::Local<v8::Object> result = v8::Object::New(isolate);
-  result->Set(v8::String::NewFromUtf8(isolate, "center"), _center);
-  result->Set(v8::String::NewFromUtf8(isolate, "score"),
-              v8::Number::New(isolate, score));
+/**
+ * Calculates the net great-circle distance, in kilometers, from
+ * Latitude/Longitude points to a center.
+ */
+void sphericalScore(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
 
-  args.GetReturnValue().Set(result);
+  // get args
+  v8::Local<v8::Array> _points   = v8::Local<v8::Array>::Cast(args[0]);
+  v8::Local<v8::Array> _center   = v8::Local<v8::Array>::Cast(args[1]);
+  const size_t         numPoints = _points->Length();
+  const double         lat       = _center->Get(0)->NumberValue();
+  const double         lng       = _center->Get(1)->NumberValue();
+  const Cartesian::DistanceMode mode =
+      (Cartesian::DistanceMode)(args[2]->Uint32Value());
+
+  static Metrics::EntryPoint & metrics =
+      Metrics::entryPoint("center.sphericalScore");
+  Metrics::Call call(metrics, numPoints);
+
+  // pass locations to native array
+  Arena::Scope scratch;
+  double(*points)[2] = scratch.alloc<double[2]>(numPoints);
+  for (unsigned int i = 0; i < numPoints; ++i) {
+    v8::Local<v8::Array> _element = v8::Local<v8::Array>::Cast(_points->Get(i));
+    points[i][0]                  = _element->Get(0)->NumberValue();
+    points[i][1]                  = _element->Get(1)->NumberValue();
+  }
+
+  // sum distances from each location to center
+  call.enter(Metrics::compute);
+  const double score = sphericalCost(lat, lng, points, numPoints, mode);
+
+  call.enter(Metrics::unmarshal);
+  args.GetReturnValue().Set(v8::Number::New(isolate, score));
 }
 
 /**
@@ -56,8 +201,12 @@ void mass(const v8::FunctionCallbackInfo<v8::Value> & args)
 
   const unsigned int length = _points->Length();
 
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("center.mass");
+  Metrics::Call                call(metrics, length);
+
   // pass locations to C++ array
-  double points[length][2];
+  Arena::Scope scratch;
+  double(*points)[2] = scratch.alloc<double[2]>(length);
   for (unsigned int i = 0; i < length; ++i) {
     v8::Local<v8::Array> element = v8::Local<v8::Array>::Cast(_points->Get(i));
     points[i][0]                 = element->Get(0)->NumberValue();
@@ -65,11 +214,13 @@ void mass(const v8::FunctionCallbackInfo<v8::Value> & args)
   }
 
   // get results
+  call.enter(Metrics::compute);
   double center[2] = {0, 0};
   centerOfMass(points, length, center);
   const double score = cost(center[0], center[1], points, length);
 
   // convert center back to JS Array
+  call.enter(Metrics::unmarshal);
   v8::Local<v8::Array> _center = v8::Array::New(isolate);
   _center->Set(0, v8::Number::New(isolate, center[0]));
   _center->Set(1, v8::Number::New(isolate, center[1]));
@@ -87,8 +238,8 @@ void init(v8::Local<v8::Object> exports)
 {
   NODE_SET_METHOD(exports, "geometric", geometric);
   NODE_SET_METHOD(exports, "mass", mass);
+  NODE_SET_METHOD(exports, "spherical", spherical);
+  NODE_SET_METHOD(exports, "sphericalScore", sphericalScore);
 }
 
-NODE_MODULE(addon, init);
-
 }  // namespace Center
@@ -0,0 +1,286 @@
+#include "../arena.h"
+#include "../center.h"
+#include "../geo.h"
+#include "../metrics.h"
+#include "../tsp.h"
+#include "wrapper.h"
+#include <node_object_wrap.h>
+
+namespace Geo
+{
+/**
+ * A JS handle on a store of Latitude/Longitude points with their trigonometry
+ * cached, kept in step with a set of locations by slot.
+ */
+class Store : public node::ObjectWrap
+{
+ public:
+  static void init(v8::Local<v8::Object> exports);
+
+ private:
+  static void wrapNew(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapBuild(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapAdd(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapSet(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapRemove(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapSize(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapDistances(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapCenter(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapScore(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapRoute(const v8::FunctionCallbackInfo<v8::Value> & args);
+
+  PointStore store;
+};
+
+/**
+ * Creates an empty store.
+ */
+void Store::wrapNew(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  Store * store = new Store();
+  store->Wrap(args.This());
+  args.GetReturnValue().Set(args.This());
+}
+
+/**
+ * Replaces the contents of the store with a set of points, in slots matching
+ * their positions.
+ */
+void Store::wrapBuild(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  Store * store = ObjectWrap::Unwrap<Store>(args.Holder());
+
+  // get args
+  v8::Local<v8::Array> _points   = v8::Local<v8::Array>::Cast(args[0]);
+  const size_t         numPoints = _points->Length();
+
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("geo.build");
+  Metrics::Call                call(metrics, numPoints);
+
+  // pass locations to native array
+  Arena::Scope scratch;
+  double(*points)[2] = scratch.alloc<double[2]>(numPoints);
+  for (size_t i = 0; i < numPoints; ++i) {
+    Spatial::unwrapPoint(_points->Get(i), points[i]);
+  }
+
+  // work out trigonometry of every point
+  call.enter(Metrics::compute);
+  store->store.build(points, numPoints);
+}
+
+/**
+ * Appends a point.
+ */
+void Store::wrapAdd(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  Store * store = ObjectWrap::Unwrap<Store>(args.Holder());
+  double  point[2];
+  Spatial::unwrapPoint(args[0], point);
+
+  store->store.add(point);
+}
+
+/**
+ * Replaces the point in a slot.
+ */
+void Store::wrapSet(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  Store *      store = ObjectWrap::Unwrap<Store>(args.Holder());
+  const size_t slot  = args[0]->Uint32Value();
+  double       point[2];
+  Spatial::unwrapPoint(args[1], point);
+
+  if (slot < store->store.size()) {
+    store->store.set(slot, point);
+  }
+}
+
+/**
+ * Removes the point in a slot, moving the last point into it.
+ */
+void Store::wrapRemove(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  Store *      store = ObjectWrap::Unwrap<Store>(args.Holder());
+  const size_t slot  = args[0]->Uint32Value();
+
+  if (slot < store->store.size()) {
+    store->store.remove(slot);
+  }
+}
+
+/**
+ * Returns the number of points in the store.
+ */
+void Store::wrapSize(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Store *       store   = ObjectWrap::Unwrap<Store>(args.Holder());
+
+  args.GetReturnValue().Set(v8::Number::New(isolate, store->store.size()));
+}
+
+/**
+ * Calculates the earthly distance from each point to a center, by a
+ * DistanceMode (exact if not given).
+ */
+void Store::wrapDistances(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate   = args.GetIsolate();
+  Store *       store     = ObjectWrap::Unwrap<Store>(args.Holder());
+  const size_t  numPoints = store->store.size();
+
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("geo.distances");
+  Metrics::Call                call(metrics, numPoints);
+
+  // get args
+  double center[2];
+  Spatial::unwrapPoint(args[0], center);
+  const char                    unit = (char)(args[1]->Uint32Value());
+  const Cartesian::DistanceMode mode =
+      (Cartesian::DistanceMode)(args[2]->Uint32Value());
+
+  // record distances from each location to center
+  call.enter(Metrics::compute);
+  Arena::Scope scratch;
+  double *     _distances = scratch.alloc<double>(numPoints);
+  fillDistances(store->store, center, unit, _distances, mode);
+
+  call.enter(Metrics::unmarshal);
+  v8::Local<v8::Array> distances = v8::Array::New(isolate);
+  for (size_t i = 0; i < numPoints; ++i) {
+    distances->Set(i, v8::Number::New(isolate, _distances[i]));
+  }
+  args.GetReturnValue().Set(distances);
+}
+
+/**
+ * Calculates the geometric center of the points on the earth's surface, of
+ * the points merged by grid cell if given a cell size in degrees.
+ */
+void Store::wrapCenter(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Store *       store   = ObjectWrap::Unwrap<Store>(args.Holder());
+
+  // get args
+  const double                         epsilon   = args[0]->NumberValue();
+  const size_t                         maxIters  = args[1]->Uint32Value();
+  const double                         maxMicros = args[2]->NumberValue();
+  const double                         cellSize  = args[3]->NumberValue();
+  const Center::GeometricCenterOptions opts      = {epsilon, 0, false,
+                                               maxIters, maxMicros};
+  const size_t                         numPoints = store->store.size();
+
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("geo.center");
+  Metrics::Call                call(metrics, numPoints);
+
+  // calculate geometric center
+  call.enter(Metrics::compute);
+  double                       center[2];
+  Center::GeometricCenterStats stats;
+  double                       score;
+  if (cellSize > 0) {
+    Arena::Scope scratch;
+    double(*cells)[2] = scratch.alloc<double[2]>(numPoints);
+    double *     weights  = scratch.alloc<double>(numPoints);
+    const size_t numCells =
+        Center::aggregate(store->store, cellSize, cells, weights);
+
+    PointStore merged;
+    merged.build(cells, numCells);
+    Center::sphericalCenter(merged, weights, opts, center, &stats);
+    score = Center::sphericalCost(center[0], center[1], store->store);
+  } else {
+    score = Center::sphericalCenter(store->store, opts, center, &stats);
+  }
+
+  call.enter(Metrics::unmarshal);
+  args.GetReturnValue().Set(Center::wrapSearch(isolate, center, score, stats));
+}
+
+/**
+ * Calculates the net great-circle distance from the points to a center, by a
+ * DistanceMode (exact if not given).
+ */
+void Store::wrapScore(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate   = args.GetIsolate();
+  Store *       store     = ObjectWrap::Unwrap<Store>(args.Holder());
+  const size_t  numPoints = store->store.size();
+
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("geo.score");
+  Metrics::Call                call(metrics, numPoints);
+
+  // get args
+  double center[2];
+  Spatial::unwrapPoint(args[0], center);
+  const Cartesian::DistanceMode mode =
+      (Cartesian::DistanceMode)(args[1]->Uint32Value());
+
+  // sum distances from each location to center
+  call.enter(Metrics::compute);
+  const double score =
+      Center::sphericalCost(center[0], center[1], store->store, mode);
+
+  call.enter(Metrics::unmarshal);
+  args.GetReturnValue().Set(v8::Number::New(isolate, score));
+}
+
+/**
+ * Determines an efficient order to visit the points in by great-circle
+ * distance.
+ */
+void Store::wrapRoute(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate   = args.GetIsolate();
+  Store *       store     = ObjectWrap::Unwrap<Store>(args.Holder());
+  const size_t  numPoints = store->store.size();
+  const size_t  startCity = args[0]->Uint32Value();
+
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("geo.route");
+  Metrics::Call                call(metrics, numPoints);
+
+  // calculate route
+  call.enter(Metrics::compute);
+  Arena::Scope scratch;
+  size_t *     route  = scratch.alloc<size_t>(numPoints);
+  const size_t length = TSP::fillRoute(store->store, startCity, route);
+
+  // convert order back to JS Array
+  call.enter(Metrics::unmarshal);
+  v8::Local<v8::Array> order = v8::Array::New(isolate);
+  for (size_t i = 0; i < length; ++i) {
+    order->Set(i, v8::Number::New(isolate, route[i]));
+  }
+  args.GetReturnValue().Set(order);
+}
+
+void Store::init(v8::Local<v8::Object> exports)
+{
+  v8::Isolate * isolate = exports->GetIsolate();
+
+  v8::Local<v8::FunctionTemplate> tpl =
+      v8::FunctionTemplate::New(isolate, wrapNew);
+  tpl->SetClassName(v8::String::NewFromUtf8(isolate, "Store"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+  NODE_SET_PROTOTYPE_METHOD(tpl, "build", wrapBuild);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "add", wrapAdd);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "set", wrapSet);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "remove", wrapRemove);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "size", wrapSize);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "distances", wrapDistances);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "center", wrapCenter);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "score", wrapScore);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "route", wrapRoute);
+
+  exports->Set(v8::String::NewFromUtf8(isolate, "Store"), tpl->GetFunction());
+}
+
+void init(v8::Local<v8::Object> exports)
+{
+  Store::init(exports);
+}
+
+}  // namespace Geo
@@ -0,0 +1,99 @@
+#include "../metrics.h"
+#include "wrapper.h"
+
+namespace Metrics
+{
+/**
+ * Converts a histogram snapshot to a JS Object.
+ */
+v8::Local<v8::Object> wrapHistogram(v8::Isolate *             isolate,
+                                    const HistogramSnapshot & histogram)
+{
+  v8::Local<v8::Object> result = v8::Object::New(isolate);
+  result->Set(v8::String::NewFromUtf8(isolate, "count"),
+              v8::Number::New(isolate, histogram.count));
+  result->Set(v8::String::NewFromUtf8(isolate, "sum"),
+              v8::Number::New(isolate, histogram.sum));
+  result->Set(v8::String::NewFromUtf8(isolate, "min"),
+              v8::Number::New(isolate, histogram.min));
+  result->Set(v8::String::NewFromUtf8(isolate, "max"),
+              v8::Number::New(isolate, histogram.max));
+  result->Set(v8::String::NewFromUtf8(isolate, "mean"),
+              v8::Number::New(isolate, histogram.mean));
+  result->Set(v8::String::NewFromUtf8(isolate, "p50"),
+              v8::Number::New(isolate, histogram.p50));
+  result->Set(v8::String::NewFromUtf8(isolate, "p90"),
+              v8::Number::New(isolate, histogram.p90));
+  result->Set(v8::String::NewFromUtf8(isolate, "p99"),
+              v8::Number::New(isolate, histogram.p99));
+  result->Set(v8::String::NewFromUtf8(isolate, "p999"),
+              v8::Number::New(isolate, histogram.p999));
+  return result;
+}
+
+/**
+ * Turns instrumentation on or off, with a fraction of calls to trace.
+ */
+void wrapEnable(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  const bool   on         = args[0]->BooleanValue();
+  const double sampleRate = args[1]->IsNumber() ? args[1]->NumberValue() : 0;
+  enable(on, sampleRate);
+}
+
+/**
+ * Returns the metrics of every entry point, keyed by entry point name.
+ */
+void wrapSnapshot(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+
+  const std::vector<EntryPointSnapshot> entries = snapshot();
+
+  v8::Local<v8::Object> result = v8::Object::New(isolate);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const EntryPointSnapshot & entry = entries[i];
+
+    v8::Local<v8::Object> _entry = v8::Object::New(isolate);
+    _entry->Set(v8::String::NewFromUtf8(isolate, "calls"),
+                v8::Number::New(isolate, entry.calls));
+    _entry->Set(v8::String::NewFromUtf8(isolate, "size"),
+                wrapHistogram(isolate, entry.sizes));
+    for (size_t p = 0; p < NUM_PHASES; ++p) {
+      _entry->Set(v8::String::NewFromUtf8(isolate, PHASE_NAMES[p]),
+                  wrapHistogram(isolate, entry.phases[p]));
+    }
+    result->Set(v8::String::NewFromUtf8(isolate, entry.name), _entry);
+  }
+
+  args.GetReturnValue().Set(result);
+}
+
+/**
+ * Forgets every recorded metric and trace event.
+ */
+void wrapReset(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  reset();
+}
+
+/**
+ * Returns the sampled calls as Chrome trace-event JSON.
+ */
+void wrapTrace(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+
+  const std::string trace = traceJSON();
+  args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, trace.c_str()));
+}
+
+void init(v8::Local<v8::Object> exports)
+{
+  NODE_SET_METHOD(exports, "enable", wrapEnable);
+  NODE_SET_METHOD(exports, "snapshot", wrapSnapshot);
+  NODE_SET_METHOD(exports, "reset", wrapReset);
+  NODE_SET_METHOD(exports, "trace", wrapTrace);
+}
+
+}  // namespace Metrics
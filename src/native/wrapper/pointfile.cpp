@@ -0,0 +1,223 @@
+#include "../arena.h"
+#include "../metrics.h"
+#include "../pointfile.h"
+#include "../polynomial.h"
+#include "wrapper.h"
+
+namespace PointFile
+{
+/**
+ * Maps the point file at the path in the first argument, throwing a JS Error
+ * if it cannot be read.
+ */
+bool openArg(const v8::FunctionCallbackInfo<v8::Value> & args, Reader & file)
+{
+  v8::Isolate *         isolate = args.GetIsolate();
+  v8::String::Utf8Value path(args[0]);
+
+  if (!file.open(*path)) {
+    isolate->ThrowException(v8::Exception::Error(
+        v8::String::NewFromUtf8(isolate, file.error())));
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Throws a JS Error if a point file holds no points, where a center or fit of
+ * them is asked for.
+ */
+bool hasPoints(const v8::FunctionCallbackInfo<v8::Value> & args,
+               const Reader &                              file)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+
+  if (!file.size()) {
+    isolate->ThrowException(v8::Exception::Error(
+        v8::String::NewFromUtf8(isolate, "point file holds no points")));
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Describes the layout of a point file.
+ */
+void info(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Reader        file;
+  if (!openArg(args, file)) {
+    return;
+  }
+
+  v8::Local<v8::Object> result = v8::Object::New(isolate);
+  result->Set(v8::String::NewFromUtf8(isolate, "count"),
+              v8::Number::New(isolate, file.size()));
+  result->Set(v8::String::NewFromUtf8(isolate, "single"),
+              v8::Boolean::New(isolate, file.flags() & single));
+  result->Set(v8::String::NewFromUtf8(isolate, "columnar"),
+              v8::Boolean::New(isolate, file.flags() & columnar));
+  result->Set(v8::String::NewFromUtf8(isolate, "weighted"),
+              v8::Boolean::New(isolate, file.flags() & weighted));
+  args.GetReturnValue().Set(result);
+}
+
+/**
+ * Calculates the net cost of travelling from the points of a file to a
+ * center.
+ */
+void wrapCost(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Reader        file;
+  if (!openArg(args, file)) {
+    return;
+  }
+  const double x = args[1]->NumberValue();
+  const double y = args[2]->NumberValue();
+
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("pointFile.cost");
+  Metrics::Call                call(metrics, file.size());
+
+  call.enter(Metrics::compute);
+  const double score = cost(file, x, y);
+  args.GetReturnValue().Set(v8::Number::New(isolate, score));
+}
+
+/**
+ * Calculates the center of mass of the points of a file, and its score.
+ */
+void mass(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Reader        file;
+  if (!openArg(args, file) || !hasPoints(args, file)) {
+    return;
+  }
+
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("pointFile.mass");
+  Metrics::Call                call(metrics, file.size());
+
+  call.enter(Metrics::compute);
+  double center[2] = {0, 0};
+  centerOfMass(file, center);
+  const double score = cost(file, center[0], center[1]);
+
+  call.enter(Metrics::unmarshal);
+  v8::Local<v8::Array> _center = v8::Array::New(isolate);
+  _center->Set(0, v8::Number::New(isolate, center[0]));
+  _center->Set(1, v8::Number::New(isolate, center[1]));
+
+  v8::Local<v8::Object> result = v8::Object::New(isolate);
+  result->Set(v8::String::NewFromUtf8(isolate, "center"), _center);
+  result->Set(v8::String::NewFromUtf8(isolate, "score"),
+              v8::Number::New(isolate, score));
+  args.GetReturnValue().Set(result);
+}
+
+/**
+ * Calculates the geometric center of the points of a file.
+ */
+void geometric(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Reader        file;
+  if (!openArg(args, file) || !hasPoints(args, file)) {
+    return;
+  }
+
+  // get args
+  const bool                           subsearch = args[1]->BooleanValue();
+  const double                         epsilon   = args[2]->NumberValue();
+  const double                         bounds    = args[3]->NumberValue();
+  const size_t                         maxIters  = args[4]->Uint32Value();
+  const double                         maxMicros = args[5]->NumberValue();
+  const Center::GeometricCenterOptions opts      = {epsilon, bounds, subsearch,
+                                               maxIters, maxMicros};
+
+  static Metrics::EntryPoint & metrics =
+      Metrics::entryPoint("pointFile.geometric");
+  Metrics::Call call(metrics, file.size());
+
+  call.enter(Metrics::compute);
+  double                       center[2] = {0, 0};
+  Center::GeometricCenterStats stats;
+  const double score = geometricCenter(file, opts, center, &stats);
+
+  call.enter(Metrics::unmarshal);
+  args.GetReturnValue().Set(Center::wrapSearch(isolate, center, score, stats));
+}
+
+/**
+ * Calculates the net earthly distance from the Latitude/Longitude points of a
+ * file to a center, by a DistanceMode (exact if not given).
+ */
+void distanceSum(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Reader        file;
+  if (!openArg(args, file)) {
+    return;
+  }
+
+  double center[2];
+  Spatial::unwrapPoint(args[1], center);
+  const char                    unit = (char)(args[2]->Uint32Value());
+  const Cartesian::DistanceMode mode =
+      (Cartesian::DistanceMode)(args[3]->Uint32Value());
+
+  static Metrics::EntryPoint & metrics =
+      Metrics::entryPoint("pointFile.distanceSum");
+  Metrics::Call call(metrics, file.size());
+
+  call.enter(Metrics::compute);
+  const double total = sumDistances(file, center, unit, mode);
+  args.GetReturnValue().Set(v8::Number::New(isolate, total));
+}
+
+/**
+ * Calculates the best-fit polynomial function of the points of a file.
+ */
+void bestFit(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Reader        file;
+  if (!openArg(args, file) || !hasPoints(args, file)) {
+    return;
+  }
+
+  // guessing a degree takes every point at once, so default instead
+  size_t degree = args[1]->Uint32Value();
+  if (!degree) {
+    degree = Polynomial::DEFAULT_DEGREE;
+  }
+
+  static Metrics::EntryPoint & metrics =
+      Metrics::entryPoint("pointFile.bestFit");
+  Metrics::Call call(metrics, file.size());
+
+  call.enter(Metrics::compute);
+  Arena::Scope scratch;
+  double *     coeffs = scratch.alloc<double>(degree + 1);
+  fillBestFit(file, degree, coeffs);
+
+  call.enter(Metrics::unmarshal);
+  v8::Local<v8::Array> _coeffs = v8::Array::New(isolate);
+  for (size_t i = 0; i < degree + 1; ++i) {
+    _coeffs->Set(i, v8::Number::New(isolate, coeffs[i]));
+  }
+  args.GetReturnValue().Set(_coeffs);
+}
+
+void init(v8::Local<v8::Object> exports)
+{
+  NODE_SET_METHOD(exports, "info", info);
+  NODE_SET_METHOD(exports, "cost", wrapCost);
+  NODE_SET_METHOD(exports, "mass", mass);
+  NODE_SET_METHOD(exports, "geometric", geometric);
+  NODE_SET_METHOD(exports, "distanceSum", distanceSum);
+  NODE_SET_METHOD(exports, "bestFit", bestFit);
+}
+
+}  // namespace PointFile
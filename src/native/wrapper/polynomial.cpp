@@ -1,6 +1,8 @@
+#include "../arena.h"
+#include "../metrics.h"
 #include "../polynomial.h"
 #include "../util.h"
-#include <node.h>
+#include "wrapper.h"
 
 namespace Polynomial
 {
@@ -13,8 +15,14 @@ void wrapBestFit(const v8::FunctionCallbackInfo<v8::Value> & args)
 
   v8::Local<v8::Array> _points   = v8::Local<v8::Array>::Cast(args[0]);
   const size_t         numPoints = _points->Length();
-  double               xPos[numPoints];
-  double               yPos[numPoints];
+
+  static Metrics::EntryPoint & metrics =
+      Metrics::entryPoint("polynomial.bestFit");
+  Metrics::Call call(metrics, numPoints);
+
+  Arena::Scope         scratch;
+  double *             xPos = scratch.alloc<double>(numPoints);
+  double *             yPos = scratch.alloc<double>(numPoints);
   v8::Local<v8::Array> orig;
 
   for (size_t i = 0; i < numPoints; ++i) {
@@ -23,16 +31,18 @@ void wrapBestFit(const v8::FunctionCallbackInfo<v8::Value> & args)
     yPos[i] = orig->Get(1)->NumberValue();
   }
 
+  call.enter(Metrics::compute);
   size_t degree = args[1]->Uint32Value();
   if (!degree) {
     degree = guessPolynomialDegree(xPos, yPos, numPoints);
   }
 
   // calculate polynomial
-  double coeffs[degree + 1];
+  double * coeffs = scratch.alloc<double>(degree + 1);
   fillBestFit(xPos, yPos, numPoints, degree, coeffs);
 
   // pass coeffs back to JS Array
+  call.enter(Metrics::unmarshal);
   v8::Local<v8::Array> _coeffs = v8::Array::New(isolate);
   for (unsigned char i = 0; i < degree + 1; ++i) {
     _coeffs->Set(i, v8::Number::New(isolate, coeffs[i]));
@@ -46,6 +56,4 @@ void init(v8::Local<v8::Object> exports)
   NODE_SET_METHOD(exports, "bestFit", wrapBestFit);
 }
 
-NODE_MODULE(addon, init);
-
 }  // namespace Polynomial
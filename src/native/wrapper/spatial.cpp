@@ -0,0 +1,280 @@
+#include "../arena.h"
+#include "../metrics.h"
+#include "../spatial.h"
+#include "wrapper.h"
+#include <node_object_wrap.h>
+
+namespace Spatial
+{
+/**
+ * Reads a point from a JS Array.
+ */
+void unwrapPoint(v8::Local<v8::Value> value, double fill[2])
+{
+  v8::Local<v8::Array> _point = v8::Local<v8::Array>::Cast(value);
+  fill[0]                     = _point->Get(0)->NumberValue();
+  fill[1]                     = _point->Get(1)->NumberValue();
+}
+
+/**
+ * Converts the ids of a set of points to a JS Array.
+ */
+v8::Local<v8::Array> wrapIds(v8::Isolate *                 isolate,
+                             const std::vector<Neighbor> & found)
+{
+  v8::Local<v8::Array> ids = v8::Array::New(isolate);
+  for (size_t i = 0; i < found.size(); ++i) {
+    ids->Set(i, v8::Number::New(isolate, found[i].id));
+  }
+  return ids;
+}
+
+/**
+ * A JS handle on a spatial index over planar (k-d tree) or
+ * Latitude/Longitude (GeoIndex) points.
+ */
+class Index : public node::ObjectWrap
+{
+ public:
+  static void init(v8::Local<v8::Object> exports);
+
+ private:
+  explicit Index(bool geo) : geo(geo), planar(2) {}
+
+  static void wrapNew(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapBuild(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapInsert(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapRemove(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapRelabel(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapNearest(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapWithin(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapBox(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapSize(const v8::FunctionCallbackInfo<v8::Value> & args);
+
+  const bool geo;
+  KDTree     planar;
+  GeoIndex   geoIndex;
+};
+
+/**
+ * Creates an index, over Latitude/Longitude points if the first argument is
+ * true.
+ */
+void Index::wrapNew(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  Index * index = new Index(args[0]->BooleanValue());
+  index->Wrap(args.This());
+  args.GetReturnValue().Set(args.This());
+}
+
+/**
+ * Replaces the contents of the index with a set of points, with ids matching
+ * their positions.
+ */
+void Index::wrapBuild(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  Index * index = ObjectWrap::Unwrap<Index>(args.Holder());
+
+  // get args
+  v8::Local<v8::Array> _points   = v8::Local<v8::Array>::Cast(args[0]);
+  const size_t         numPoints = _points->Length();
+
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("spatial.build");
+  Metrics::Call                call(metrics, numPoints);
+
+  // pass locations to native array
+  Arena::Scope scratch;
+  double(*points)[2] = scratch.alloc<double[2]>(numPoints);
+  for (size_t i = 0; i < numPoints; ++i) {
+    unwrapPoint(_points->Get(i), points[i]);
+  }
+
+  // build index
+  call.enter(Metrics::compute);
+  if (index->geo) {
+    index->geoIndex.build(points, numPoints);
+  } else {
+    index->planar.build(points[0], numPoints);
+  }
+}
+
+/**
+ * Inserts a point under an id, replacing any point with the same id.
+ */
+void Index::wrapInsert(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  Index *      index = ObjectWrap::Unwrap<Index>(args.Holder());
+  const size_t id    = args[0]->Uint32Value();
+  double       point[2];
+  unwrapPoint(args[1], point);
+
+  if (index->geo) {
+    index->geoIndex.insert(id, point);
+  } else {
+    index->planar.insert(id, point);
+  }
+}
+
+/**
+ * Removes the point with an id, returning whether there was one.
+ */
+void Index::wrapRemove(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  Index *      index = ObjectWrap::Unwrap<Index>(args.Holder());
+  const size_t id    = args[0]->Uint32Value();
+
+  const bool removed =
+      index->geo ? index->geoIndex.remove(id) : index->planar.remove(id);
+  args.GetReturnValue().Set(removed);
+}
+
+/**
+ * Moves the point with an id to another id, returning whether there was one.
+ */
+void Index::wrapRelabel(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  Index *      index = ObjectWrap::Unwrap<Index>(args.Holder());
+  const size_t from  = args[0]->Uint32Value();
+  const size_t to    = args[1]->Uint32Value();
+
+  const bool relabeled = index->geo ? index->geoIndex.relabel(from, to)
+                                    : index->planar.relabel(from, to);
+  args.GetReturnValue().Set(relabeled);
+}
+
+/**
+ * Finds the ids of the k points nearest a point, nearest first.
+ */
+void Index::wrapNearest(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Index *       index   = ObjectWrap::Unwrap<Index>(args.Holder());
+
+  static Metrics::EntryPoint & metrics =
+      Metrics::entryPoint("spatial.nearest");
+  Metrics::Call call(metrics, index->geo ? index->geoIndex.size()
+                                         : index->planar.size());
+
+  // get args
+  double point[2];
+  unwrapPoint(args[0], point);
+  const size_t k = args[1]->Uint32Value();
+
+  // query index
+  call.enter(Metrics::compute);
+  std::vector<Neighbor> found;
+  if (index->geo) {
+    index->geoIndex.nearest(point, k, found);
+  } else {
+    index->planar.nearest(point, k, found);
+  }
+
+  call.enter(Metrics::unmarshal);
+  args.GetReturnValue().Set(wrapIds(isolate, found));
+}
+
+/**
+ * Finds the ids of the points within a distance of a point, nearest first.
+ */
+void Index::wrapWithin(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Index *       index   = ObjectWrap::Unwrap<Index>(args.Holder());
+
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("spatial.within");
+  Metrics::Call call(metrics, index->geo ? index->geoIndex.size()
+                                         : index->planar.size());
+
+  // get args
+  double point[2];
+  unwrapPoint(args[0], point);
+  const double radius = args[1]->NumberValue();
+
+  // query index
+  call.enter(Metrics::compute);
+  std::vector<Neighbor> found;
+  if (index->geo) {
+    index->geoIndex.within(point, radius, found);
+  } else {
+    index->planar.within(point, radius, found);
+  }
+
+  call.enter(Metrics::unmarshal);
+  args.GetReturnValue().Set(wrapIds(isolate, found));
+}
+
+/**
+ * Finds the ids of the points inside a box, given by its lowest and highest
+ * corners.
+ */
+void Index::wrapBox(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Index *       index   = ObjectWrap::Unwrap<Index>(args.Holder());
+
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("spatial.box");
+  Metrics::Call call(metrics, index->geo ? index->geoIndex.size()
+                                         : index->planar.size());
+
+  // get args
+  double lo[2], hi[2];
+  unwrapPoint(args[0], lo);
+  unwrapPoint(args[1], hi);
+
+  // query index
+  call.enter(Metrics::compute);
+  std::vector<size_t> found;
+  if (index->geo) {
+    index->geoIndex.inBox(lo, hi, found);
+  } else {
+    index->planar.inBox(lo, hi, found);
+  }
+
+  call.enter(Metrics::unmarshal);
+  v8::Local<v8::Array> ids = v8::Array::New(isolate);
+  for (size_t i = 0; i < found.size(); ++i) {
+    ids->Set(i, v8::Number::New(isolate, found[i]));
+  }
+  args.GetReturnValue().Set(ids);
+}
+
+/**
+ * Returns the number of points in the index.
+ */
+void Index::wrapSize(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Index *       index   = ObjectWrap::Unwrap<Index>(args.Holder());
+
+  const size_t size =
+      index->geo ? index->geoIndex.size() : index->planar.size();
+  args.GetReturnValue().Set(v8::Number::New(isolate, size));
+}
+
+void Index::init(v8::Local<v8::Object> exports)
+{
+  v8::Isolate * isolate = exports->GetIsolate();
+
+  v8::Local<v8::FunctionTemplate> tpl =
+      v8::FunctionTemplate::New(isolate, wrapNew);
+  tpl->SetClassName(v8::String::NewFromUtf8(isolate, "Index"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+  NODE_SET_PROTOTYPE_METHOD(tpl, "build", wrapBuild);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "insert", wrapInsert);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "remove", wrapRemove);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "relabel", wrapRelabel);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "nearest", wrapNearest);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "within", wrapWithin);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "box", wrapBox);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "size", wrapSize);
+
+  exports->Set(v8::String::NewFromUtf8(isolate, "Index"), tpl->GetFunction());
+}
+
+void init(v8::Local<v8::Object> exports)
+{
+  Index::init(exports);
+}
+
+}  // namespace Spatial
@@ -0,0 +1,139 @@
+#include "../center.h"
+#include "../metrics.h"
+#include "../stream.h"
+#include "wrapper.h"
+#include <node_object_wrap.h>
+
+namespace Stream
+{
+/**
+ * A JS handle on a sliding window of timestamped points, with its geometric
+ * center solved lazily as the window moves.
+ */
+class Window : public node::ObjectWrap
+{
+ public:
+  static void init(v8::Local<v8::Object> exports);
+
+ private:
+  explicit Window(const Center::GeometricCenterOptions & options,
+                  double                                 tolerance);
+
+  static void wrapNew(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapPush(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapExpire(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapSize(const v8::FunctionCallbackInfo<v8::Value> & args);
+  static void wrapCenter(const v8::FunctionCallbackInfo<v8::Value> & args);
+
+  SlidingCenter window;
+};
+
+Window::Window(const Center::GeometricCenterOptions & options,
+               double                                 tolerance)
+    : window(options, tolerance)
+{
+}
+
+/**
+ * Creates an empty window with the options of its geometric center search,
+ * and the drift of the center of mass that calls for a new search.
+ */
+void Window::wrapNew(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  // get args
+  const bool                           subsearch = args[0]->BooleanValue();
+  const double                         epsilon   = args[1]->NumberValue();
+  const double                         bounds    = args[2]->NumberValue();
+  const size_t                         maxIters  = args[3]->Uint32Value();
+  const double                         maxMicros = args[4]->NumberValue();
+  const double                         tolerance = args[5]->NumberValue();
+  const Center::GeometricCenterOptions opts      = {epsilon, bounds, subsearch,
+                                               maxIters, maxMicros};
+
+  Window * window = new Window(opts, tolerance);
+  window->Wrap(args.This());
+  args.GetReturnValue().Set(args.This());
+}
+
+/**
+ * Adds a point to the end of the window, at a time.
+ */
+void Window::wrapPush(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  Window * window = ObjectWrap::Unwrap<Window>(args.Holder());
+
+  double point[2];
+  Spatial::unwrapPoint(args[0], point);
+  window->window.push(point, args[1]->NumberValue());
+}
+
+/**
+ * Drops the points older than a time from the window, returning how many.
+ */
+void Window::wrapExpire(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Window *      window  = ObjectWrap::Unwrap<Window>(args.Holder());
+
+  const size_t expired = window->window.expire(args[0]->NumberValue());
+  args.GetReturnValue().Set(v8::Number::New(isolate, expired));
+}
+
+/**
+ * Counts the points in the window.
+ */
+void Window::wrapSize(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Window *      window  = ObjectWrap::Unwrap<Window>(args.Holder());
+  args.GetReturnValue().Set(v8::Number::New(isolate, window->window.size()));
+}
+
+/**
+ * Finds the geometric center of the window, flagging whether it was searched
+ * for again or carried over from the last search.
+ */
+void Window::wrapCenter(const v8::FunctionCallbackInfo<v8::Value> & args)
+{
+  v8::Isolate * isolate = args.GetIsolate();
+  Window *      window  = ObjectWrap::Unwrap<Window>(args.Holder());
+
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("stream.center");
+  Metrics::Call                call(metrics, window->window.size());
+
+  call.enter(Metrics::compute);
+  double                       center[2];
+  Center::GeometricCenterStats stats;
+  const bool resolved = window->window.center(center, &stats);
+
+  call.enter(Metrics::unmarshal);
+  v8::Local<v8::Object> result =
+      Center::wrapSearch(isolate, center, window->window.score(), stats);
+  result->Set(v8::String::NewFromUtf8(isolate, "resolved"),
+              v8::Boolean::New(isolate, resolved));
+  args.GetReturnValue().Set(result);
+}
+
+void Window::init(v8::Local<v8::Object> exports)
+{
+  v8::Isolate * isolate = exports->GetIsolate();
+
+  v8::Local<v8::FunctionTemplate> tpl =
+      v8::FunctionTemplate::New(isolate, wrapNew);
+  tpl->SetClassName(v8::String::NewFromUtf8(isolate, "SlidingCenter"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+  NODE_SET_PROTOTYPE_METHOD(tpl, "push", wrapPush);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "expire", wrapExpire);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "size", wrapSize);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "center", wrapCenter);
+
+  exports->Set(v8::String::NewFromUtf8(isolate, "SlidingCenter"),
+               tpl->GetFunction());
+}
+
+void init(v8::Local<v8::Object> exports)
+{
+  Window::init(exports);
+}
+}  // namespace Stream
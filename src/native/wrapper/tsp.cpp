@@ -1,12 +1,13 @@
-#include "../center.h"
+#include "../arena.h"
+#include "../metrics.h"
 #include "../tsp.h"
-#include "../util.h"
-#include <node.h>
+#include "wrapper.h"
 
 namespace TSP
 {
 /**
- * Determines the shortest-travel path between planar points.
+ * Determines the shortest-travel path between planar points, in single
+ * precision if asked.
  */
 void wrapTSP(const v8::FunctionCallbackInfo<v8::Value> & args)
 {
@@ -16,69 +17,42 @@ void wrapTSP(const v8::FunctionCallbackInfo<v8::Value> & args)
   v8::Local<v8::Array> _points   = v8::Local<v8::Array>::Cast(args[0]);
   const size_t         numPoints = _points->Length();
   const size_t         startCity = args[1]->Uint32Value();
-  const char           method    = (char)(args[2]->Uint32Value());
-
-  // setup visited-cities
-  bool visited[numPoints];
-  for (size_t i = 0; i < numPoints; ++i) {
-    visited[i] = false;
-  }
-
-  // setup cost matrix
-  Util::DoubleArr2D costMatrix = new Util::DoubleArr[numPoints];
-  for (size_t i = 0; i < numPoints; ++i) {
-    costMatrix[i] = new double[numPoints];
-  }
-
-  const size_t matrixLen = 1;
-
-  // fill cost matrix
-  for (size_t i = 0; i < numPoints; ++i) {
-    for (size_t j = 0; j < numPoints; ++j) {
-      double to[matrixLen][2];
-      double from[2];
-      for (size_t k = 0; k < 2; ++k) {
-        to[0][k] =
-            v8::Local<v8::Array>::Cast(_points->Get(j))->Get(k)->NumberValue();
-        from[k] =
-            v8::Local<v8::Array>::Cast(_points->Get(i))->Get(k)->NumberValue();
-      }
-
-      switch (method) {
-        case VisitMethod::tsp:
-          costMatrix[i][j] = Center::cost(from[0], from[1], to, matrixLen);
-        case VisitMethod::naiveVrp:
-          costMatrix[i][j] =
-              Center::manhattanCost(from[0], from[1], to, matrixLen);
-      }
-    }
+  const VisitMethod    method    = (VisitMethod)(args[2]->Uint32Value());
+  const bool           single    = args[3]->BooleanValue();
+
+  static Metrics::EntryPoint & metrics = Metrics::entryPoint("tsp.tsp");
+  Metrics::Call                call(metrics, numPoints);
+
+  // pass locations to native array, and calculate route over a cost matrix
+  // of the same precision
+  Arena::Scope scratch;
+  size_t *     route = scratch.alloc<size_t>(numPoints);
+  size_t       length;
+  if (single) {
+    float(*points)[2] = scratch.alloc<float[2]>(numPoints);
+    Spatial::unwrapPoints(_points, points);
+    call.enter(Metrics::compute);
+    length = fillRoute(points, numPoints, startCity, method, route);
+  } else {
+    double(*points)[2] = scratch.alloc<double[2]>(numPoints);
+    Spatial::unwrapPoints(_points, points);
+    call.enter(Metrics::compute);
+    length = fillRoute(points, numPoints, startCity, method, route);
   }
 
-  // setup order matrix
-  size_t               city  = startCity;
+  // convert order back to JS Array
+  call.enter(Metrics::unmarshal);
   v8::Local<v8::Array> order = v8::Array::New(isolate);
-  order->Set(0, v8::Number::New(isolate, city));
-
-  // calculate nearest node (city) and add it to order matrix until every node
-  // has been visited
-  while (Util::arr_contains(visited, numPoints, false)) {
-    visited[city]     = true;
-    const int nearest = nearestCity(costMatrix, numPoints, city, visited);
-    if (nearest == -1) {
-      break;
-    }
-    order->Set(order->Length(), v8::Number::New(isolate, nearest));
-    city = nearest;
+  for (size_t i = 0; i < length; ++i) {
+    order->Set(i, v8::Number::New(isolate, route[i]));
   }
 
   args.GetReturnValue().Set(order);
-}  // namespace TSP
+}
 
 void init(v8::Local<v8::Object> exports)
 {
   NODE_SET_METHOD(exports, "tsp", wrapTSP);
 }
 
-NODE_MODULE(addon, init);
-
-}  // namespace Center
+}  // namespace TSP
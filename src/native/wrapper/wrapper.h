@@ -0,0 +1,78 @@
+#ifndef WRAPPER_H
+#define WRAPPER_H
+
+#include "../center.h"
+#include <node.h>
+
+/**
+ * Each module registers its bindings on an exports object of its own, which
+ * the addon then mounts under the module's name. Conversions that more than
+ * one module needs are declared alongside.
+ */
+namespace Cartesian
+{
+void init(v8::Local<v8::Object> exports);
+}  // namespace Cartesian
+
+namespace Center
+{
+void init(v8::Local<v8::Object> exports);
+
+v8::Local<v8::Object> wrapSearch(v8::Isolate *                isolate,
+                                 const double                 center[2],
+                                 double                       score,
+                                 const GeometricCenterStats & stats);
+}  // namespace Center
+
+namespace Geo
+{
+void init(v8::Local<v8::Object> exports);
+}  // namespace Geo
+
+namespace Metrics
+{
+void init(v8::Local<v8::Object> exports);
+}  // namespace Metrics
+
+namespace PointFile
+{
+void init(v8::Local<v8::Object> exports);
+}  // namespace PointFile
+
+namespace Polynomial
+{
+void init(v8::Local<v8::Object> exports);
+}  // namespace Polynomial
+
+namespace Spatial
+{
+void init(v8::Local<v8::Object> exports);
+
+void unwrapPoint(v8::Local<v8::Value> value, double fill[2]);
+
+/**
+ * Copies a JS Array of points into a native array of either precision.
+ */
+template <typename Coord>
+void unwrapPoints(v8::Local<v8::Array> points, Coord fill[][2])
+{
+  const uint32_t numPoints = points->Length();
+  for (uint32_t i = 0; i < numPoints; ++i) {
+    v8::Local<v8::Array> _point = v8::Local<v8::Array>::Cast(points->Get(i));
+    fill[i][0]                  = _point->Get(0)->NumberValue();
+    fill[i][1]                  = _point->Get(1)->NumberValue();
+  }
+}
+}  // namespace Spatial
+
+namespace Stream
+{
+void init(v8::Local<v8::Object> exports);
+}  // namespace Stream
+
+namespace TSP
+{
+void init(v8::Local<v8::Object> exports);
+}  // namespace TSP
+
+#endif
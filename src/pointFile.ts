@@ -0,0 +1,287 @@
+import * as fs from 'fs';
+import {
+  CenterOptions,
+  CenterResult,
+  CenterStats,
+  PointFileInfo,
+  PointFileOptions
+} from './interfaces/index';
+import { NATIVE } from './bindings';
+import { Position } from './position';
+import { asciiDistanceModes, asciiDistanceUnits } from './util/distance';
+const POINT_FILE = NATIVE.pointFile;
+const HEADER_SIZE = 24;
+const CHUNK_SIZE = 65536;
+const Flag = {
+  single: 1,
+  columnar: 2,
+  weighted: 4
+};
+
+/**
+ * A set of points held in a binary point file rather than in memory, for
+ * offline jobs over more points than fit comfortably in JS Arrays. The file
+ * is memory-mapped and streamed through the native engines in chunks each
+ * time a result is asked for, so no point ever becomes a JS object.
+ *
+ * A point file is a 24-byte little-endian header (`"MHPT"`, version, layout
+ * flags, point count) followed by the coordinates, either interleaved or
+ * columnar, as float64 or float32, and optionally one weight per point.
+ *
+ * ```
+ * import { PointFile } from 'meethere';
+ *
+ * PointFile.write('fixes.mhpt', fixes, { precision: 'f32' });
+ * let file = new PointFile('fixes.mhpt');
+ * file.center; // => [33.05, -96.81]
+ * file.distanceSum(file.center, 'km'); // => 5012.3
+ * ```
+ *
+ * @class
+ */
+class PointFile {
+  path: string;
+  options: CenterOptions;
+  private result: CenterResult = null;
+  private version: string = null;
+
+  /**
+   * Opens a point file.
+   *
+   * @constructs
+   * @param {string} path Path of the point file
+   * @param {CenterOptions} [options=Position.defaultCenterOptions] General
+   * search options
+   */
+  constructor(path: string, options: CenterOptions = {}) {
+    this.path = path;
+    this.options = { ...Position.defaultCenterOptions, ...options };
+  }
+
+  /**
+   * Writes points to a point file, a chunk at a time.
+   *
+   * @function
+   * @static
+   * @param {string} path Path of the point file to write
+   * @param {Array} points 2D Array of points
+   * @param {PointFileOptions} [options={}] Precision of values (`'f64'` or
+   * `'f32'`), layout of coordinates (`'interleaved'` or `'columnar'`), and
+   * optional weights of the points
+   */
+  static write(
+    path: string,
+    points: Array<Array<number>>,
+    options: PointFileOptions = {}
+  ): void {
+    const single = options.precision === 'f32';
+    const columnar = options.layout === 'columnar';
+    const weights = options.weights;
+    const flags =
+      (single ? Flag.single : 0) |
+      (columnar ? Flag.columnar : 0) |
+      (weights ? Flag.weighted : 0);
+
+    const header = Buffer.alloc(HEADER_SIZE);
+    header.write('MHPT', 0, 4, 'ascii');
+    header.writeUInt16LE(1, 4);
+    header.writeUInt16LE(flags, 6);
+    header.writeUInt32LE(points.length % 0x100000000, 8);
+    header.writeUInt32LE(Math.floor(points.length / 0x100000000), 12);
+
+    const fd = fs.openSync(path, 'w');
+    try {
+      fs.writeSync(fd, header, 0, HEADER_SIZE);
+      const writeColumn = (value: (i: number) => number, width: number) => {
+        for (let start = 0; start < points.length; start += CHUNK_SIZE) {
+          const count = Math.min(CHUNK_SIZE, points.length - start);
+          const chunk = single
+            ? new Float32Array(count * width)
+            : new Float64Array(count * width);
+          for (let i = 0; i < count * width; ++i) {
+            chunk[i] = value(start * width + i);
+          }
+          fs.writeSync(fd, Buffer.from(chunk.buffer), 0, chunk.byteLength);
+        }
+      };
+
+      if (columnar) {
+        writeColumn(i => points[i][0], 1);
+        writeColumn(i => points[i][1], 1);
+      } else {
+        writeColumn(i => points[i >> 1][i & 1], 2);
+      }
+      if (weights) {
+        writeColumn(i => weights[i], 1);
+      }
+    } finally {
+      fs.closeSync(fd);
+    }
+  }
+
+  /**
+   * Describes the layout of the point file.
+   *
+   * @name PointFile#info
+   * @function
+   * @return {PointFileInfo} Number of points, and layout flags
+   */
+  get info(): PointFileInfo {
+    return POINT_FILE.info(this.path);
+  }
+
+  /**
+   * Searches for the geometric center of the points of the file, within the
+   * iteration and time budgets of its options. Every step of the search
+   * streams the file once.
+   *
+   * @function
+   * @protected
+   * @return {CenterResult} Geometric center, its cost, and search telemetry
+   */
+  protected geometricCenter(): CenterResult {
+    return POINT_FILE.geometric(
+      this.path,
+      this.options.subsearch,
+      this.options.epsilon,
+      this.options.bounds,
+      this.options.maxIterations,
+      this.options.maxMicros
+    );
+  }
+
+  /**
+   * Searches for the geometric center of the points of the file, or returns
+   * the result of the last search if neither the file (by modification time
+   * and size) nor an option changed since. PointFile#center,
+   * PointFile#centerStats and PointFile#centerCost all report on this one
+   * search, so a file is streamed through one search however many of them
+   * are read.
+   *
+   * @name PointFile#solve
+   * @function
+   * @throws {Error} If the file cannot be read, or holds no points
+   * @return {CenterResult} Geometric center, its cost, and search telemetry,
+   * shared by every caller until the next search; copy it before changing it
+   */
+  solve(): CenterResult {
+    const { mtime, size } = fs.statSync(this.path);
+    const options = JSON.stringify(this.options);
+    const version = `${mtime.getTime()}:${size}:${options}`;
+    if (!this.result || this.version !== version) {
+      this.result = this.geometricCenter();
+      this.version = version;
+    }
+    return this.result;
+  }
+
+  /**
+   * Calculates the geometric center of the points of the file, as
+   * Position#center, counting each point weight times.
+   *
+   * @name PointFile#center
+   * @function
+   * @return {Array} Geometric center of the points
+   */
+  get center(): Array<number> {
+    return this.solve().center.slice();
+  }
+
+  /**
+   * Reports how hard the search for PointFile#center worked, as of
+   * PointFile#solve.
+   *
+   * @name PointFile#centerStats
+   * @function
+   * @return {CenterStats} Telemetry of the geometric center search
+   */
+  get centerStats(): CenterStats {
+    return { ...this.solve().stats };
+  }
+
+  /**
+   * Calculates the net cost of travelling from the points to their geometric
+   * center.
+   *
+   * @name PointFile#centerCost
+   * @function
+   * @return {number} Cost of travelling
+   */
+  get centerCost(): number {
+    return this.solve().score;
+  }
+
+  /**
+   * Calculates the median (center of mass) of the points of the file.
+   *
+   * @name PointFile#median
+   * @function
+   * @return {Array} Center of mass of the points
+   */
+  get median(): Array<number> {
+    return POINT_FILE.mass(this.path).center;
+  }
+
+  /**
+   * Calculates the net cost of travelling from the points to their median.
+   *
+   * @name PointFile#medianCost
+   * @function
+   * @return {number} Cost of travelling
+   */
+  get medianCost(): number {
+    return POINT_FILE.mass(this.path).score;
+  }
+
+  /**
+   * Calculates the net cost of travelling from the points to any center.
+   *
+   * @name PointFile#cost
+   * @function
+   * @param {Array} point Center to travel to
+   * @return {number} Cost of travelling
+   */
+  cost(point: Array<number>): number {
+    return POINT_FILE.cost(this.path, point[0], point[1]);
+  }
+
+  /**
+   * Calculates the net earthly distance from the points of the file, taken as
+   * Latitude/Longitude, to a center.
+   *
+   * @name PointFile#distanceSum
+   * @function
+   * @param {Array} point Latitude/Longitude center
+   * @param {string} [units='km'] Units of distance to use, can be 'km' or 'mi'
+   * @param {string} [mode='exact'] Formula to measure distance with, as for
+   * MeetHere#distanceMatrix
+   * @return {number} Net distance to the center
+   */
+  distanceSum(
+    point: Array<number>,
+    units: string = 'km',
+    mode: string = 'exact'
+  ): number {
+    return POINT_FILE.distanceSum(
+      this.path,
+      point,
+      asciiDistanceUnits[units],
+      asciiDistanceModes[mode]
+    );
+  }
+
+  /**
+   * Calculates the best-fit polynomial of the points of the file. The degree
+   * cannot be guessed without holding every point, so it defaults to 2.
+   *
+   * @name PointFile#polynomial
+   * @function
+   * @param {number} [degree=options.degree] Degree of the polynomial
+   * @return {Array} Coefficients of the polynomial, lowest degree first
+   */
+  polynomial(degree: number = this.options.degree): Array<number> {
+    return POINT_FILE.bestFit(this.path, degree);
+  }
+}
+
+export { PointFile };
@@ -1,16 +1,20 @@
-import { CenterOptions } from './interfaces/index';
-import { arrayUtil } from './util/array';
-import * as Bindings from 'bindings';
-const CENTER = Bindings('center');
-const POLYNOMIAL = Bindings('polynomial');
-const TSP = Bindings('tsp');
+import {
+  CenterOptions,
+  CenterResult,
+  CenterStats
+} from './interfaces/index';
+import { LocationIndex } from './util/locationIndex';
+import { NATIVE } from './bindings';
+const CENTER = NATIVE.center;
+const POLYNOMIAL = NATIVE.polynomial;
+const SPATIAL = NATIVE.spatial;
+const TSP = NATIVE.tsp;
 const Method = {
   tsp: 116,
-  naiveVrp: 110
+  naiveVrp: 110,
+  hilbert: 104
 };
 
-arrayUtil();
-
 /**
  * A prototype describing a set of points on a plane.
  *
@@ -32,11 +36,20 @@ arrayUtil();
  * Plane.score // => 0.010113270070291593
  * ```
  *
+ * Locations are indexed by value for O(1) Position#remove and Position#move,
+ * so `locations` (and the Array passed to the constructor, which it is) must
+ * only be changed through Position#add, Position#remove and Position#move.
+ * A location pushed or replaced directly is not found by them.
+ *
  * @class
  */
 class Position {
   locations: Array<Array<number>>;
   options: CenterOptions;
+  private index: LocationIndex;
+  private spatial: any = null;
+  private result: CenterResult = null;
+  private solvedWith: string = null;
 
   /**
    * Default geometric center options
@@ -50,7 +63,12 @@ class Position {
     epsilon: 1e-3,
     bounds: 10,
     startIndex: 0,
-    degree: null
+    degree: null,
+    maxIterations: 0,
+    maxMicros: 0,
+    cellSize: 0,
+    precision: 'f64',
+    path: 'best'
   };
 
   /**
@@ -64,6 +82,111 @@ class Position {
   constructor(locations: Array<Array<number>>, options: CenterOptions = {}) {
     this.locations = locations;
     this.options = { ...Position.defaultCenterOptions, ...options };
+    this.index = new LocationIndex(locations);
+  }
+
+  /**
+   * Whether locations are Latitude/Longitude points, in which case spatial
+   * queries measure kilometers along the earth's surface.
+   *
+   * @function
+   * @protected
+   * @return {boolean} Whether locations are geographic
+   */
+  protected get geographic(): boolean {
+    return false;
+  }
+
+  /**
+   * Whether the native engines should hold the locations in single
+   * precision, as asked by the `precision` option (`'f32'`).
+   *
+   * @function
+   * @protected
+   * @return {boolean} Whether to compute in single precision
+   */
+  protected get single(): boolean {
+    return this.options.precision === 'f32';
+  }
+
+  /**
+   * Returns the native spatial index over the locations, building it on
+   * first use. It is kept in sync by the edit hooks from then on.
+   *
+   * @function
+   * @private
+   * @return {Object} Spatial index whose ids are slots of the locations
+   */
+  private spatialIndex(): any {
+    if (!this.spatial) {
+      this.spatial = new SPATIAL.Index(this.geographic);
+      this.spatial.build(this.locations);
+    }
+    return this.spatial;
+  }
+
+  /**
+   * Called after a location is added at a slot. Subclasses override this to
+   * keep derived state in sync with the locations, and should call `super`.
+   *
+   * @function
+   * @protected
+   * @param {number} slot Slot of the new location
+   */
+  protected onAdd(slot: number): void {
+    this.result = null;
+    if (this.spatial) {
+      this.spatial.insert(slot, this.locations[slot]);
+    }
+  }
+
+  /**
+   * Called after the location at a slot is removed. The location previously
+   * at the last slot now sits at the removed one, unless the removed location
+   * was itself the last.
+   *
+   * @function
+   * @protected
+   * @param {number} slot Slot of the removed location
+   * @param {number} last Former last slot, whose location moved to `slot`
+   */
+  protected onRemove(slot: number, last: number): void {
+    this.result = null;
+    if (this.spatial) {
+      this.spatial.remove(slot);
+      this.spatial.relabel(last, slot);
+    }
+  }
+
+  /**
+   * Called after the location at a slot is replaced.
+   *
+   * @function
+   * @protected
+   * @param {number} slot Slot of the replaced location
+   * @param {Array} previous Location previously at the slot
+   */
+  protected onMove(slot: number, previous: Array<number>): void {
+    this.result = null;
+    if (this.spatial) {
+      this.spatial.insert(slot, this.locations[slot]);
+    }
+  }
+
+  /**
+   * Checks that a slot of the locations holds the location indexed there,
+   * before an edit relies on it.
+   *
+   * @function
+   * @private
+   * @throws {Error} If `locations` was changed directly at the slot
+   * @param {number} slot Slot to check
+   */
+  private checkSlot(slot: number): void {
+    const location = this.locations[slot];
+    if (!location || !this.index.holds(location, slot)) {
+      throw new Error(`Position: [${location}] is not indexed at slot ${slot}`);
+    }
   }
 
   /**
@@ -79,35 +202,56 @@ class Position {
    * ```
    */
   add(location: Array<number>): void {
-    this.locations.push(location);
+    const slot = this.locations.push(location) - 1;
+    this.index.add(location, slot);
+    this.onAdd(slot);
   }
 
   /**
-   * Removes a location to the set of points.
+   * Removes a location from the set of points in O(1) time. The last location
+   * takes the place of the removed one, so the order of the remaining
+   * locations is not preserved.
    *
    * @name Position#remove
    * @function
+   * @throws {Error} If the removed or last location is not where the index
+   * holds it, as when `locations` was changed directly; the Position is then
+   * left as it was
    * @param {Array} location Point to remove
    * @return {Array|number} The removed location, or `-1` if no match is found
    *
    * ```
-   * let plane = new Position([[2, 3], [5, 6]]);
-   * plane.remove([2, 3]); // => [[5, 6]]
+   * let plane = new Position([[2, 3], [5, 6], [7, 8]]);
+   * plane.remove([2, 3]); // => [[7, 8], [5, 6]]
    * ```
    */
   remove(location: Array<number>): Array<number> | number {
-    const idx = this.locations.deepIndexOf(location);
-    if (idx > -1) {
-      return this.locations.splice(idx, 1)[0];
+    const idx = this.index.indexOf(location);
+    if (idx < 0) {
+      return idx;
+    }
+
+    const removed = this.locations[idx];
+    const last = this.locations.length - 1;
+    this.checkSlot(idx);
+    this.checkSlot(last);
+    this.index.remove(removed, idx);
+    if (idx !== last) {
+      this.locations[idx] = this.locations[last];
+      this.index.relabel(this.locations[idx], last, idx);
     }
-    return idx;
+    this.locations.pop();
+    this.onRemove(idx, last);
+    return removed;
   }
 
   /**
-   * Moves (replaces) an existing location.
+   * Moves (replaces) an existing location in O(1) time.
    *
    * @name Position#move
    * @function
+   * @throws {Error} If the location is not where the index holds it, as when
+   * `locations` was changed directly; the Position is then left as it was
    * @param {Array} location Point to move
    * @param {Array} to Value to move to
    * @return {Array|number} The previous location, or `-1` if no match is found
@@ -118,11 +262,72 @@ class Position {
    * ```
    */
   move(location: Array<number>, to: Array<number>): Array<number> | number {
-    const idx = this.locations.deepIndexOf(location);
-    if (idx > -1) {
-      return this.locations.splice(idx, 1, to)[0];
+    const idx = this.index.indexOf(location);
+    if (idx < 0) {
+      return idx;
+    }
+
+    this.checkSlot(idx);
+    const previous = this.locations[idx];
+    this.locations[idx] = to;
+    this.index.remove(previous, idx);
+    this.index.add(to, idx);
+    this.onMove(idx, previous);
+    return previous;
+  }
+
+  /**
+   * Searches for the geometric center of the Position, within the iteration
+   * and time budgets of its options. With a `cellSize`, locations sharing a
+   * grid cell of that side are merged into one weighted location first; the
+   * center found then costs at most `2 * sqrt(2) * cellSize` per location more
+   * than the exact one. With a `precision` of `'f32'`, locations are held in
+   * single precision and costs summed in double precision, for about twice
+   * the throughput and a center within about 1e-7 of the extent of the
+   * locations.
+   *
+   * @function
+   * @protected
+   * @return {CenterResult} Geometric center, its cost, and search telemetry
+   */
+  protected geometricCenter(): CenterResult {
+    return CENTER.geometric(
+      this.locations,
+      this.options.subsearch,
+      this.options.epsilon,
+      this.options.bounds,
+      this.options.maxIterations,
+      this.options.maxMicros,
+      this.options.cellSize,
+      this.single
+    );
+  }
+
+  /**
+   * Searches for the geometric center of the Position, or returns the result
+   * of the last search if no location was added, removed or moved and no
+   * option changed since. Position#center, Position#centerStats and
+   * Position#centerCost all report on this one search, so that the telemetry
+   * describes the center returned even when a `maxMicros` budget makes
+   * searches differ from run to run.
+   *
+   * @name Position#solve
+   * @function
+   * @return {CenterResult} Geometric center, its cost, and search telemetry,
+   * shared by every caller until the next search; copy it before changing it
+   *
+   * ```
+   * let plane = new Position([[0, 0], [0, 1], [1, 0]]);
+   * plane.solve(); // => { center: [0.21198, 0.21198], score: 1.93184, ... }
+   * ```
+   */
+  solve(): CenterResult {
+    const options = JSON.stringify(this.options);
+    if (!this.result || this.solvedWith !== options) {
+      this.result = this.geometricCenter();
+      this.solvedWith = options;
     }
-    return idx;
+    return this.result;
   }
 
   /**
@@ -140,12 +345,26 @@ class Position {
    * ```
    */
   get center(): Array<number> {
-    return CENTER.geometric(
-      this.locations,
-      this.options.subsearch,
-      this.options.epsilon,
-      this.options.bounds
-    ).center;
+    return this.solve().center.slice();
+  }
+
+  /**
+   * Reports how hard the search for Position#center worked, as of
+   * Position#solve: the number of iterations, cost evaluations and step
+   * halvings, the final step, and whether the search converged to epsilon
+   * before a budget (`maxIterations`, `maxMicros`) ran out.
+   *
+   * @name Position#centerStats
+   * @function
+   * @return {CenterStats} Telemetry of the geometric center search
+   *
+   * ```
+   * let plane = new Position([[0, 0], [0, 1], [1, 0]], { maxIterations: 5 });
+   * plane.centerStats; // => { iterations: 5, ..., converged: false }
+   * ```
+   */
+  get centerStats(): CenterStats {
+    return { ...this.solve().stats };
   }
 
   /**
@@ -165,9 +384,93 @@ class Position {
     return CENTER.mass(this.locations).center;
   }
 
+  /**
+   * Returns the locations nearest to a point, nearest first.
+   *
+   * @name Position#nearest
+   * @function
+   * @param {number} k Most locations to return
+   * @param {Array} [point=Position#center] Point to measure distance from
+   * @return {Array} Up to `k` locations nearest to the point
+   *
+   * ```
+   * let plane = new Position([[0, 0], [5, 10], [3, 4]]);
+   * plane.nearest(2, [4, 4]); // => [[3, 4], [0, 0]]
+   * ```
+   */
+  nearest(k: number, point: Array<number> = this.center): Array<Array<number>> {
+    return this.spatialIndex()
+      .nearest(point, k)
+      .map(slot => this.locations[slot]);
+  }
+
+  /**
+   * Returns the locations within a distance of a point, nearest first.
+   *
+   * @name Position#within
+   * @function
+   * @param {number} radius Greatest distance from the point
+   * @param {Array} [point=Position#center] Point to measure distance from
+   * @return {Array} Locations within the radius of the point
+   *
+   * ```
+   * let plane = new Position([[0, 0], [5, 10], [3, 4]]);
+   * plane.within(5, [0, 0]); // => [[0, 0], [3, 4]]
+   * ```
+   */
+  within(
+    radius: number,
+    point: Array<number> = this.center
+  ): Array<Array<number>> {
+    return this.spatialIndex()
+      .within(point, radius)
+      .map(slot => this.locations[slot]);
+  }
+
+  /**
+   * Returns the locations inside a box, bounds included.
+   *
+   * @name Position#inBox
+   * @function
+   * @param {Array} lo Lowest corner of the box
+   * @param {Array} hi Highest corner of the box
+   * @return {Array} Locations inside the box, in no particular order
+   *
+   * ```
+   * let plane = new Position([[0, 0], [5, 10], [3, 4]]);
+   * plane.inBox([1, 1], [5, 5]); // => [[3, 4]]
+   * ```
+   */
+  inBox(lo: Array<number>, hi: Array<number>): Array<Array<number>> {
+    return this.spatialIndex()
+      .box(lo, hi)
+      .map(slot => this.locations[slot]);
+  }
+
+  /**
+   * Searches for a short path between all locations, by Pythagorean travel.
+   * With a `path` of `'hilbert'`, the locations are visited in the order of a
+   * Hilbert curve over them instead, in O(n) time, for a path somewhat longer
+   * than the greedy one.
+   *
+   * @function
+   * @protected
+   * @return {Array} Order of indeces of the locations
+   */
+  protected shortestPath(): Array<number> {
+    return TSP.tsp(
+      this.locations,
+      this.options.startIndex,
+      Method[this.options.path === 'hilbert' ? 'hilbert' : 'tsp'],
+      this.single
+    );
+  }
+
   /**
    * Returns the index order of the least-costly path between all locations on
-   * the plane through a solution of the TSP (~80 point efficiency).
+   * the plane through a solution of the TSP, exact for up to 16 locations and
+   * greedy (~80 point efficiency) beyond, or along a Hilbert curve with a
+   * `path` of `'hilbert'` (for millions of locations).
    *
    * @name Position#bestPath
    * @TODO More involved TSP solution (figure out or-tools bindings)
@@ -181,13 +484,13 @@ class Position {
    * ```
    */
   get bestPath(): Array<number> {
-    return TSP.tsp(this.locations, this.options.startIndex, Method['tsp']);
+    return this.shortestPath();
   }
 
   /**
    * Returns the index order of the least-costly manhattan-style drive between
-   * all locations on the plane through a solution of the VRP (~80 point
-   * efficiency).
+   * all locations on the plane through a solution of the VRP, exact for up to
+   * 16 locations and greedy (~80 point efficiency) beyond.
    *
    * @name Position#quickPath
    * @TODO More involved VRP solution (figure out or-tools bindings)
@@ -200,7 +503,12 @@ class Position {
    * plane.quickPath; // => [0, 2, 1]
    */
   get quickPath() {
-    return TSP.tsp(this.locations, this.options.startIndex, Method['naiveVrp']);
+    return TSP.tsp(
+      this.locations,
+      this.options.startIndex,
+      Method['naiveVrp'],
+      this.single
+    );
   }
 
   /**
@@ -252,12 +560,7 @@ class Position {
    * ```
    */
   get centerCost(): number {
-    return CENTER.geometric(
-      this.locations,
-      this.options.subsearch,
-      this.options.epsilon,
-      this.options.bounds
-    ).score;
+    return this.solve().score;
   }
 
   /**
@@ -279,4 +582,4 @@ class Position {
   }
 }
 
-export { Bindings, Position };
+export { Position };
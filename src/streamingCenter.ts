@@ -0,0 +1,140 @@
+import {
+  CenterResult,
+  CenterStats,
+  StreamingCenterOptions
+} from './interfaces/index';
+import { NATIVE } from './bindings';
+import { Position } from './position';
+const STREAM = NATIVE.stream;
+
+/**
+ * The geometric center of a live stream of locations, over a sliding window
+ * of time. Pings are pushed as they arrive and drop out of the window once
+ * they are older than it. The center is only searched for again once the
+ * center of mass of the window has drifted further than the tolerance since
+ * the last search, and then starting from the last center, so that reading
+ * the center after every ping stays cheap. The tolerance bounds the drift
+ * of the center of mass, not the error of the center returned in between.
+ *
+ * ```
+ * import { StreamingCenter } from 'meethere';
+ *
+ * let stream = new StreamingCenter(60);
+ * stream.push([33.0952311, -96.8640427]);
+ * stream.push([33.0437115, -96.8157956]);
+ * stream.center; // => [33.07, -96.84]
+ * ```
+ *
+ * @class
+ */
+class StreamingCenter {
+  window: number;
+  options: StreamingCenterOptions;
+  private stream: any;
+
+  /**
+   * Creates an empty StreamingCenter.
+   *
+   * @constructs
+   * @param {number} window Length of the window, in the units of the times
+   * pushed (seconds by default)
+   * @param {StreamingCenterOptions} [options=Position.defaultCenterOptions]
+   * General search options, and the drift of the center of mass that calls
+   * for a new search (epsilon by default)
+   */
+  constructor(window: number, options: StreamingCenterOptions = {}) {
+    this.window = window;
+    this.options = { ...Position.defaultCenterOptions, ...options };
+    if (this.options.tolerance === undefined) {
+      this.options.tolerance = this.options.epsilon;
+    }
+    this.stream = new STREAM.SlidingCenter(
+      this.options.subsearch,
+      this.options.epsilon,
+      this.options.bounds,
+      this.options.maxIterations,
+      this.options.maxMicros,
+      this.options.tolerance
+    );
+  }
+
+  /**
+   * Adds a ping to the window, and drops the pings that have fallen out of
+   * it. Pings should be pushed in time order.
+   *
+   * @name StreamingCenter#push
+   * @function
+   * @param {Array} point Location of the ping
+   * @param {number} [time=Date.now() / 1000] Time of the ping
+   * @return {number} Number of pings dropped from the window
+   */
+  push(point: Array<number>, time: number = Date.now() / 1000): number {
+    this.stream.push(point, time);
+    return this.stream.expire(time - this.window);
+  }
+
+  /**
+   * Counts the pings in the window.
+   *
+   * @name StreamingCenter#size
+   * @function
+   * @return {number} Number of pings in the window
+   */
+  get size(): number {
+    return this.stream.size();
+  }
+
+  /**
+   * Finds the geometric center of the window, searching again only if it
+   * has drifted.
+   *
+   * @name StreamingCenter#solve
+   * @function
+   * @return {Object} Geometric center, its cost, and telemetry of the last
+   * search, flagged with whether this call searched again
+   */
+  solve(): CenterResult & { resolved: boolean } {
+    return this.stream.center();
+  }
+
+  /**
+   * Calculates the geometric center of the pings in the window, as
+   * Position#center. The center of the last search is carried over until the
+   * center of mass drifts past the tolerance or the window turns over, with
+   * no bound in between on how far it is from the window's true center: a
+   * ping can move the median across the window while barely moving the mean.
+   *
+   * @name StreamingCenter#center
+   * @function
+   * @return {Array} Geometric center of the window
+   */
+  get center(): Array<number> {
+    return this.solve().center;
+  }
+
+  /**
+   * Reports how hard the last search for StreamingCenter#center worked, as
+   * Position#centerStats.
+   *
+   * @name StreamingCenter#centerStats
+   * @function
+   * @return {CenterStats} Telemetry of the last geometric center search
+   */
+  get centerStats(): CenterStats {
+    return this.solve().stats;
+  }
+
+  /**
+   * Calculates the net cost of travelling from the pings to their geometric
+   * center, as of the last search.
+   *
+   * @name StreamingCenter#centerCost
+   * @function
+   * @return {number} Cost of travelling
+   */
+  get centerCost(): number {
+    return this.solve().score;
+  }
+}
+
+export { StreamingCenter };
@@ -0,0 +1,24 @@
+/**
+ * Character codes the native distance kernels take for units of distance.
+ *
+ * @constant
+ * @private
+ */
+export const asciiDistanceUnits = {
+  km: 107,
+  mi: 109
+};
+
+/**
+ * Character codes the native distance kernels take for the formula to
+ * measure distance with.
+ *
+ * @constant
+ * @private
+ */
+export const asciiDistanceModes = {
+  exact: 101,
+  equirectangular: 114,
+  chord: 99,
+  polynomial: 112
+};
@@ -0,0 +1,120 @@
+/**
+ * A hash index from exact coordinates to the slots of an Array of locations,
+ * giving O(1) lookup of a location's slot. Duplicate locations are tracked as
+ * separate slots under the same key.
+ *
+ * @class
+ * @private
+ */
+export class LocationIndex {
+  private slots: Map<string, Array<number>>;
+
+  /**
+   * Indexes every slot of an Array of locations.
+   *
+   * @constructs
+   * @param {Array} locations 2D Array of locations to index
+   */
+  constructor(locations: Array<Array<number>>) {
+    this.slots = new Map();
+    locations.forEach((location, slot) => this.add(location, slot));
+  }
+
+  /**
+   * Returns the key a location is indexed under. Coordinates compare as with
+   * `===`, except that `NaN` matches itself.
+   *
+   * @function
+   * @param {Array} location Location to key
+   * @return {string} Key of the location
+   */
+  static key(location: Array<number>): string {
+    return location.join(',');
+  }
+
+  /**
+   * Returns a slot holding a location.
+   *
+   * @function
+   * @param {Array} location Location to look up
+   * @return {number} Slot of the location, or `-1` if it is not indexed
+   */
+  indexOf(location: Array<number>): number {
+    const slots = this.slots.get(LocationIndex.key(location));
+    return slots ? slots[0] : -1;
+  }
+
+  /**
+   * Tells whether a location is indexed at a slot.
+   *
+   * @function
+   * @param {Array} location Location to look up
+   * @param {number} slot Slot that should hold the location
+   * @return {boolean} Whether the location is indexed at the slot
+   */
+  holds(location: Array<number>, slot: number): boolean {
+    const slots = this.slots.get(LocationIndex.key(location));
+    return !!slots && slots.indexOf(slot) > -1;
+  }
+
+  /**
+   * Indexes a location at a slot.
+   *
+   * @function
+   * @param {Array} location Location to index
+   * @param {number} slot Slot holding the location
+   */
+  add(location: Array<number>, slot: number): void {
+    const key = LocationIndex.key(location);
+    const slots = this.slots.get(key);
+    if (slots) {
+      slots.push(slot);
+    } else {
+      this.slots.set(key, [slot]);
+    }
+  }
+
+  /**
+   * Forgets a location at a slot.
+   *
+   * @function
+   * @param {Array} location Location to forget
+   * @param {number} slot Slot that held the location
+   */
+  remove(location: Array<number>, slot: number): void {
+    const key = LocationIndex.key(location);
+    const slots = this.slots.get(key);
+    if (!slots) {
+      return;
+    }
+    const i = slots.indexOf(slot);
+    if (i > -1) {
+      slots[i] = slots[slots.length - 1];
+      slots.pop();
+    }
+    if (!slots.length) {
+      this.slots.delete(key);
+    }
+  }
+
+  /**
+   * Records that a location moved from one slot to another.
+   *
+   * @function
+   * @throws {Error} If the location is not indexed at the slot it moved from,
+   * as when the locations were changed behind the index's back
+   * @param {Array} location Location that moved
+   * @param {number} from Slot that held the location
+   * @param {number} to Slot now holding the location
+   */
+  relabel(location: Array<number>, from: number, to: number): void {
+    const slots = this.slots.get(LocationIndex.key(location));
+    const i = slots ? slots.indexOf(from) : -1;
+    if (i < 0) {
+      throw new Error(
+        `LocationIndex: [${location}] is not indexed at slot ${from}`
+      );
+    }
+    slots[i] = to;
+  }
+}
@@ -0,0 +1,228 @@
+import { PlannerOptions, TileReport } from '../interfaces/index';
+
+/**
+ * Statuses of a Distance Matrix response that are worth asking again for.
+ *
+ * @constant
+ * @private
+ */
+const TRANSIENT = ['OVER_QUERY_LIMIT', 'UNKNOWN_ERROR'];
+
+/**
+ * A block of a distance matrix small enough to request at once, as half-open
+ * ranges of origins and destinations.
+ *
+ * @private
+ */
+interface Tile {
+  origins: Array<number>;
+  destinations: Array<number>;
+}
+
+/**
+ * Splits distance matrix requests that are too big for the Distance Matrix
+ * service into tiles within its limits on origins, destinations and elements
+ * (origins times destinations) per request, sends the tiles a few at a time,
+ * retries the ones that fail for want of quota or a server error, and merges
+ * their responses into one.
+ *
+ * The merged response has the shape of a single Distance Matrix response,
+ * with a `tiles` field reporting the ranges, attempts and latency (in
+ * milliseconds, including backoff) of each tile.
+ *
+ * ```
+ * const planner = new MatrixPlanner({ concurrency: 2 });
+ * planner.request(origins, destinations, (origins, destinations) =>
+ *   client.distanceMatrix({ origins, destinations }).asPromise()
+ * );
+ * ```
+ *
+ * @class
+ */
+export class MatrixPlanner {
+  options: PlannerOptions;
+
+  /**
+   * Default planner options: the limits of the Distance Matrix service, four
+   * tiles in flight, and three retries after 200, 400 and 800 milliseconds.
+   *
+   * @constant
+   * @see https://developers.google.com/maps/documentation/distance-matrix/usage-and-billing
+   * @type {PlannerOptions}
+   * @default
+   */
+  static defaultPlannerOptions: PlannerOptions = {
+    maxOrigins: 25,
+    maxDestinations: 25,
+    maxElements: 100,
+    concurrency: 4,
+    retries: 3,
+    backoff: 200,
+    now: Date.now,
+    sleep: (ms: number) => new Promise<void>(resolve => setTimeout(resolve, ms))
+  };
+
+  /**
+   * Creates a planner.
+   *
+   * @constructs
+   * @param {PlannerOptions} [options=MatrixPlanner.defaultPlannerOptions]
+   * Limits of a request, tiles in flight at once, and how to retry them
+   */
+  constructor(options: PlannerOptions = {}) {
+    this.options = { ...MatrixPlanner.defaultPlannerOptions, ...options };
+  }
+
+  /**
+   * Splits a matrix into tiles within the limits, as few as the limits allow
+   * for its destinations, row-major.
+   *
+   * @function
+   * @param {number} numOrigins Number of origins of the matrix
+   * @param {number} numDestinations Number of destinations of the matrix
+   * @return {Array} Half-open ranges of origins and destinations of the tiles
+   */
+  tiles(numOrigins: number, numDestinations: number): Array<Tile> {
+    const { maxOrigins, maxDestinations, maxElements } = this.options;
+    const width = Math.max(
+      1,
+      Math.min(maxDestinations, maxElements, numDestinations)
+    );
+    const height = Math.max(
+      1,
+      Math.min(maxOrigins, Math.floor(maxElements / width))
+    );
+
+    const tiles = [];
+    for (let o = 0; o < numOrigins; o += height) {
+      for (let d = 0; d < numDestinations; d += width) {
+        tiles.push({
+          origins: [o, Math.min(o + height, numOrigins)],
+          destinations: [d, Math.min(d + width, numDestinations)]
+        });
+      }
+    }
+    return tiles;
+  }
+
+  /**
+   * Requests a distance matrix tile by tile and merges the responses. Fails
+   * as the first tile that fails for good, without sending the tiles not yet
+   * sent.
+   *
+   * @function
+   * @async
+   * @param {Array} origins Origins of the matrix
+   * @param {Array} destinations Destinations of the matrix
+   * @param {Function} send Requests a tile from its origins and destinations,
+   * returning a Promise of a Distance Matrix response
+   * @return {Promise} A Promise that will yield the merged response JSON
+   */
+  async request(
+    origins: Array<any>,
+    destinations: Array<any>,
+    send: (origins: Array<any>, destinations: Array<any>) => Promise<any>
+  ): Promise<object> {
+    const tiles = this.tiles(origins.length, destinations.length);
+    const merged = {
+      status: 'OK',
+      origin_addresses: new Array(origins.length),
+      destination_addresses: new Array(destinations.length),
+      rows: origins.map(() => ({
+        elements: new Array(destinations.length)
+      })),
+      tiles: new Array<TileReport>(tiles.length)
+    };
+
+    let next = 0;
+    let failed = false;
+    const worker = async () => {
+      while (!failed && next < tiles.length) {
+        const index = next++;
+        const tile = tiles[index];
+        try {
+          const { json, report } = await this.attempt(tile, () =>
+            send(
+              origins.slice(tile.origins[0], tile.origins[1]),
+              destinations.slice(tile.destinations[0], tile.destinations[1])
+            )
+          );
+          this.merge(merged, tile, json);
+          merged.tiles[index] = report;
+        } catch (error) {
+          failed = true;
+          throw error;
+        }
+      }
+    };
+
+    const workers = [];
+    for (let i = 0; i < Math.min(this.options.concurrency, tiles.length); ++i) {
+      workers.push(worker());
+    }
+    await Promise.all(workers);
+    return merged;
+  }
+
+  /**
+   * Sends a tile, retrying with exponential backoff while it fails for want
+   * of quota, a server error, or without a response at all.
+   *
+   * @function
+   * @private
+   * @async
+   * @param {Tile} tile Tile to send
+   * @param {Function} send Sends the tile
+   * @return {Promise} A Promise that will yield the response JSON of the tile
+   * and its report
+   */
+  private async attempt(
+    tile: Tile,
+    send: () => Promise<any>
+  ): Promise<{ json: any; report: TileReport }> {
+    const { now, sleep, retries, backoff } = this.options;
+    const start = now();
+    for (let attempts = 1; ; ++attempts) {
+      try {
+        const response = await send();
+        const report = {
+          ...tile,
+          attempts,
+          latency: now() - start
+        };
+        return { json: response.json, report };
+      } catch (error) {
+        const transient =
+          !error || !error.json || TRANSIENT.indexOf(error.json.status) >= 0;
+        if (!transient || attempts > retries) {
+          throw error;
+        }
+        await sleep(backoff * Math.pow(2, attempts - 1));
+      }
+    }
+  }
+
+  /**
+   * Copies the rows and addresses of a tile into the merged response.
+   *
+   * @function
+   * @private
+   * @param {Object} merged Merged response
+   * @param {Tile} tile Tile the response is of
+   * @param {Object} json Response JSON of the tile
+   */
+  private merge(merged: any, tile: Tile, json: any): void {
+    const [o0, o1] = tile.origins;
+    const [d0, d1] = tile.destinations;
+    for (let o = o0; o < o1; ++o) {
+      merged.origin_addresses[o] = json.origin_addresses[o - o0];
+      const elements = json.rows[o - o0].elements;
+      for (let d = d0; d < d1; ++d) {
+        merged.rows[o].elements[d] = elements[d - d0];
+      }
+    }
+    for (let d = d0; d < d1; ++d) {
+      merged.destination_addresses[d] = json.destination_addresses[d - d0];
+    }
+  }
+}
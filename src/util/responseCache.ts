@@ -0,0 +1,181 @@
+import { CacheOptions } from '../interfaces/index';
+
+/**
+ * An outcome of a request, kept until it expires.
+ *
+ * @private
+ */
+interface Entry {
+  ok: boolean;
+  value: any;
+  expires: number;
+}
+
+/**
+ * A cache of responses of a remote service, so that asking the same question
+ * again (or one about nearly the same place) does not go to the network.
+ *
+ * Responses are kept for `ttl` milliseconds, and failures for `errorTtl`, so
+ * that a bad request is not retried in a tight loop either. At most
+ * `maxEntries` outcomes are kept, evicting the least recently used. While a
+ * request is in flight, identical requests wait on it instead of going out
+ * themselves.
+ *
+ * Cached responses are shared by every caller that asks for them, and should
+ * not be modified.
+ *
+ * ```
+ * const cache = new ResponseCache({ ttl: 60000 });
+ * const key = ResponseCache.key('timezone', [center], {});
+ * cache.fetch(key, () => client.timezone(query).asPromise());
+ * ```
+ *
+ * @class
+ */
+export class ResponseCache {
+  options: CacheOptions;
+  private entries: Map<string, Entry>;
+  private pending: Map<string, Promise<any>>;
+
+  /**
+   * Default cache options: five-minute responses, half-minute failures, and
+   * points quantized to 4 decimal places (about 11 meters of latitude).
+   *
+   * @constant
+   * @type {CacheOptions}
+   * @default
+   */
+  static defaultCacheOptions: CacheOptions = {
+    maxEntries: 256,
+    ttl: 5 * 60 * 1000,
+    errorTtl: 30 * 1000,
+    precision: 4,
+    now: Date.now
+  };
+
+  /**
+   * Creates an empty cache.
+   *
+   * @constructs
+   * @param {CacheOptions} [options=ResponseCache.defaultCacheOptions] Bounds
+   * of the cache, lifetimes of its entries, and the clock they are read from
+   */
+  constructor(options: CacheOptions = {}) {
+    this.options = { ...ResponseCache.defaultCacheOptions, ...options };
+    this.entries = new Map();
+    this.pending = new Map();
+  }
+
+  /**
+   * Returns the key of a request, from its kind, the points it is about,
+   * quantized to a number of decimal places, and its other options in a
+   * canonical order.
+   *
+   * @function
+   * @static
+   * @param {string} method Kind of request
+   * @param {Array} points Points the request is about
+   * @param {Object} options Other options of the request
+   * @param {number} [precision=4] Decimal places to quantize the points to
+   * @return {string} Key of the request
+   */
+  static key(
+    method: string,
+    points: Array<Array<number>>,
+    options: object,
+    precision: number = ResponseCache.defaultCacheOptions.precision
+  ): string {
+    const quantized = points.map(point =>
+      point.map(v => v.toFixed(precision)).join(',')
+    );
+    const normalized = Object.keys(options)
+      .filter(name => options[name] !== undefined)
+      .sort()
+      .map(name => `${name}=${JSON.stringify(options[name])}`);
+    return `${method}|${quantized.join(';')}|${normalized.join('&')}`;
+  }
+
+  /**
+   * Counts the outcomes held, including expired ones not yet evicted.
+   *
+   * @name ResponseCache#size
+   * @function
+   * @return {number} Number of outcomes held
+   */
+  get size(): number {
+    return this.entries.size;
+  }
+
+  /**
+   * Returns the outcome of a request, from the cache if it holds a fresh one,
+   * else by waiting on an identical request in flight, else by making it.
+   *
+   * @function
+   * @param {string} key Key of the request, as from ResponseCache.key
+   * @param {Function} request Makes the request, returning a Promise
+   * @return {Promise} A Promise that settles as the request did
+   */
+  fetch(key: string, request: () => Promise<any>): Promise<any> {
+    const entry = this.entries.get(key);
+    if (entry && entry.expires > this.options.now()) {
+      // refresh the entry's recency
+      this.entries.delete(key);
+      this.entries.set(key, entry);
+      return entry.ok
+        ? Promise.resolve(entry.value)
+        : Promise.reject(entry.value);
+    }
+
+    const pending = this.pending.get(key);
+    if (pending) {
+      return pending;
+    }
+
+    const settle = (ok: boolean, value: any) => {
+      this.pending.delete(key);
+      this.store(key, {
+        ok,
+        value,
+        expires:
+          this.options.now() + (ok ? this.options.ttl : this.options.errorTtl)
+      });
+    };
+    const promise = request().then(
+      value => {
+        settle(true, value);
+        return value;
+      },
+      error => {
+        settle(false, error);
+        throw error;
+      }
+    );
+    this.pending.set(key, promise);
+    return promise;
+  }
+
+  /**
+   * Drops every outcome held. Requests in flight still settle.
+   *
+   * @function
+   */
+  clear(): void {
+    this.entries.clear();
+  }
+
+  /**
+   * Holds an outcome, evicting the least recently used ones over the bound.
+   *
+   * @function
+   * @private
+   * @param {string} key Key of the request
+   * @param {Entry} entry Outcome of the request
+   */
+  private store(key: string, entry: Entry): void {
+    this.entries.delete(key);
+    this.entries.set(key, entry);
+    while (this.entries.size > this.options.maxEntries) {
+      this.entries.delete(this.entries.keys().next().value);
+    }
+  }
+}